@@ -115,6 +115,45 @@ const int ICON_WIDTH = 19;
 
 const int MAX_REDIRECTS_ALLOWED = 5;
 
+const std::chrono::seconds DNS_CACHE_TTL(60); // ref.: QHostInfoCache::max_age
+const std::chrono::seconds DNS_NEGATIVE_CACHE_TTL(30);
+const int DNS_MAX_PENDING_LOOKUPS = 8;
+const int DNS_MAX_FAILURES = 3;         ///< Then the host is no longer deferred
+const int DNS_PREFETCH_LOOKAHEAD = 16;  ///< Number of queued items to pre-resolve
+
+const int DEFAULT_CONNECTIONS_PER_HOST = 6; // ref.: QHttpNetworkConnectionPrivate::defaultHttpChannelCount
+const int MAX_CONNECTIONS_PER_HOST = 16;
+
+const int DEFAULT_RETRY_MAX_ATTEMPTS = 5;
+const int DEFAULT_RETRY_BASE_DELAY_MSECS = 1000;
+const int DEFAULT_RETRY_MAX_DELAY_SECS = 120;
+const int DEFAULT_CIRCUIT_BREAKER_THRESHOLD = 5;   ///< Consecutive failures per host
+const int DEFAULT_CIRCUIT_BREAKER_COOLDOWN_SECS = 60;
+
+const int DEFAULT_TORRENT_STATUS_INTERVAL_MSECS = 500;
+const int DEFAULT_TORRENT_STATS_INTERVAL_MSECS = 1000;
+const int DEFAULT_TORRENT_DHT_STATS_INTERVAL_MSECS = 5000;
+const int DEFAULT_TORRENT_RESUME_DATA_INTERVAL_MSECS = 300000; ///< 5 minutes
+
+const qint64 TORRENT_STREAMING_WINDOW_BYTES = 16 * 1024 * 1024; ///< Prioritized ahead of the read position
+const int TORRENT_STREAMING_DEADLINE_MSECS = 1000; ///< Deadline of the first piece of the window, then +1 s per piece
+const qint64 TORRENT_STREAMING_CHUNK_BYTES = 256 * 1024;
+const int TORRENT_STREAMING_MAX_HEADER_BYTES = 8192;
+
+const int TORRENT_SESSION_STATS_HISTORY = 3600; ///< Samples kept, i.e. 1 hour at the default interval
+
+const int DEFAULT_TORRENT_MAX_SIMULTANEOUS = 3; // ref.: settings_pack::active_downloads
+const int TORRENT_INACTIVE_DOWN_RATE = 2048; ///< bytes/s, ref.: settings_pack::inactive_down_rate
+const std::chrono::seconds TORRENT_INACTIVITY_TIMEOUT(60); // ref.: settings_pack::inactivity_timeout
+
+const int DEFAULT_TORRENT_CONCURRENT_RECHECKS = 2; // ref.: settings_pack::active_checking
+const int DEFAULT_TORRENT_RECHECK_BUDGET_MB = 32; ///< MiB read ahead by the rechecks, ref.: settings_pack::checking_mem_usage
+
+const qint64 DISK_BENCHMARK_FILE_BYTES = 64 * 1024 * 1024;
+const qint64 DISK_BENCHMARK_BLOCK_BYTES = 16 * 1024; ///< Size of a torrent block
+const int DISK_BENCHMARK_MAX_RANDOM_WRITES = 256;
+const int DISK_BENCHMARK_RANDOM_DURATION_MSECS = 2000;
+
 const int COLUMN_MINIMUM_WIDTH = 10;
 const int COLUMN_DEFAULT_WIDTH = 100;
 const int VERTICAL_HEADER_WIDTH = 22;
@@ -178,6 +217,9 @@ const QLatin1StringView REGISTRY_PROXY_USERNAME   ("ProxyUser");
 const QLatin1StringView REGISTRY_PROXY_PASSWORD   ("ProxyPwd");
 const QLatin1StringView REGISTRY_SOCKET_TYPE      ("SocketType");
 const QLatin1StringView REGISTRY_SOCKET_TIMEOUT   ("SocketTimeout");
+const QLatin1StringView REGISTRY_HOST_CONNECTIONS ("ConnectionsPerHost");
+const QLatin1StringView REGISTRY_HTTP2_ENABLED    ("Http2Enabled");
+const QLatin1StringView REGISTRY_TLS_RESUMPTION   ("TlsSessionResumptionEnabled");
 const QLatin1StringView REGISTRY_REMOTE_CREATION  ("RemoteCreationTime");
 const QLatin1StringView REGISTRY_REMOTE_LAST_MOD  ("RemoteLastModifiedTime");
 const QLatin1StringView REGISTRY_REMOTE_ACCESS    ("RemoteAccessTime");
@@ -198,6 +240,16 @@ const QLatin1StringView REGISTRY_CUSTOM_BATCH_BL  ("CustomBatchButtonLabel");
 const QLatin1StringView REGISTRY_CUSTOM_BATCH_RGE ("CustomBatchRange");
 const QLatin1StringView REGISTRY_STREAM_HOST      ("StreamHostEnabled");
 const QLatin1StringView REGISTRY_STREAM_HOST_LIST ("StreamHosts");
+const QLatin1StringView REGISTRY_RETRY_ENABLED    ("RetryEnabled");
+const QLatin1StringView REGISTRY_RETRY_MAX        ("RetryMaxAttempts");
+const QLatin1StringView REGISTRY_RETRY_DELAY      ("RetryBaseDelay");
+const QLatin1StringView REGISTRY_RETRY_MAX_DELAY  ("RetryMaxDelay");
+const QLatin1StringView REGISTRY_RETRY_TIMEOUT    ("RetryOnTimeout");
+const QLatin1StringView REGISTRY_RETRY_SERVER     ("RetryOnServerError");
+const QLatin1StringView REGISTRY_RETRY_THROTTLED  ("RetryOnTooManyRequests");
+const QLatin1StringView REGISTRY_RETRY_RESET      ("RetryOnConnectionReset");
+const QLatin1StringView REGISTRY_BREAKER_FAILURES ("CircuitBreakerThreshold");
+const QLatin1StringView REGISTRY_BREAKER_COOLDOWN ("CircuitBreakerCooldown");
 
 // Tab Privacy
 const QLatin1StringView REGISTRY_REMOVE_COMPLETED ("PrivacyRemoveCompleted");
@@ -219,6 +271,14 @@ const QLatin1StringView REGISTRY_TORRENT_SHARED   ("TorrentShareFolderEnabled");
 const QLatin1StringView REGISTRY_TORRENT_DIR      ("TorrentShareFolder");
 const QLatin1StringView REGISTRY_TORRENT_PEERS    ("TorrentPeerList");
 const QLatin1StringView REGISTRY_TORRENT_ADVANCED ("TorrentAdvanced");
+const QLatin1StringView REGISTRY_TORRENT_STATUS_TICK ("TorrentStatusInterval");
+const QLatin1StringView REGISTRY_TORRENT_STATS_TICK ("TorrentSessionStatsInterval");
+const QLatin1StringView REGISTRY_TORRENT_DHT_TICK ("TorrentDhtStatsInterval");
+const QLatin1StringView REGISTRY_TORRENT_RESUME_TICK ("TorrentResumeDataInterval");
+const QLatin1StringView REGISTRY_TORRENT_DISK_IO  ("TorrentDiskIo");
+const QLatin1StringView REGISTRY_TORRENT_MAX_SIMULTANEOUS ("TorrentMaxSimultaneous");
+const QLatin1StringView REGISTRY_TORRENT_RECHECKS ("TorrentConcurrentRechecks");
+const QLatin1StringView REGISTRY_TORRENT_RECHECK_BUDGET ("TorrentRecheckBudget");
 
 // Tab Advanced
 const QLatin1StringView REGISTRY_CHECK_UPDATE     ("CheckUpdate");
@@ -53,6 +53,9 @@ IDownloadItem::State AbstractDownloadItem::state() const
 void AbstractDownloadItem::setState(State state)
 {
     if (m_state != state) {
+        if (state == Idle) {
+            m_queueElapsedTimer.start();
+        }
         m_state = state;
         emit changed();
     }
@@ -224,7 +227,8 @@ bool AbstractDownloadItem::isPausable() const
 {
     return m_state == Idle
             || isDownloading()
-            || m_state == Seeding;
+            || m_state == Seeding
+            || (m_state == NetworkError && isRetryPending());
 }
 
 bool AbstractDownloadItem::isCancelable() const
@@ -233,7 +237,8 @@ bool AbstractDownloadItem::isCancelable() const
             || m_state == Paused
             || isDownloading()
             || m_state == Completed
-            || m_state == Seeding;
+            || m_state == Seeding
+            || (m_state == NetworkError && isRetryPending());
 }
 
 bool AbstractDownloadItem::isDownloading() const
@@ -245,6 +250,14 @@ bool AbstractDownloadItem::isDownloading() const
             || m_state == Endgame;
 }
 
+/*!
+ * \brief Returns true if the item failed, and waits to be retried automatically.
+ */
+bool AbstractDownloadItem::isRetryPending() const
+{
+    return false;
+}
+
 /******************************************************************************
  ******************************************************************************/
 QTime AbstractDownloadItem::remainingTime()
@@ -252,10 +265,20 @@ QTime AbstractDownloadItem::remainingTime()
     return m_remainingTime;
 }
 
+/*!
+ * \brief Returns the time (in msec) the item waited in the queue
+ * before its last resume, or -1 if unknown.
+ */
+qint64 AbstractDownloadItem::queueWaitTime() const
+{
+    return m_queueWaitTime;
+}
+
 /******************************************************************************
  ******************************************************************************/
 void AbstractDownloadItem::setReadyToResume()
 {
+    m_queueElapsedTimer.start();
     m_state = Idle;
     emit changed();
 }
@@ -287,6 +310,9 @@ void AbstractDownloadItem::stop()
  ******************************************************************************/
 void AbstractDownloadItem::beginResume()
 {
+    m_queueWaitTime = m_queueElapsedTimer.isValid() ? m_queueElapsedTimer.elapsed() : -1;
+    m_queueElapsedTimer.invalidate();
+
     m_state = Idle;
     emit changed();
 
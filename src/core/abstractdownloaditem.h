@@ -66,8 +66,10 @@ public:
     bool isPausable() const override;
     bool isCancelable() const override;
     bool isDownloading() const override;
+    virtual bool isRetryPending() const;
 
     QTime remainingTime();
+    qint64 queueWaitTime() const;
 
     void setReadyToResume() override;
 
@@ -109,6 +111,8 @@ private:
     QString m_log = {};
 
     QElapsedTimer m_downloadElapsedTimer = {};
+    QElapsedTimer m_queueElapsedTimer = {};
+    qint64 m_queueWaitTime = -1;
     QTime m_remainingTime = {};
     QTimer* m_updateInfoTimer = nullptr;
     QTimer* m_updateCountDownTimer = nullptr;
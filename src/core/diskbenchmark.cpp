@@ -0,0 +1,193 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "diskbenchmark.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QRandomGenerator>
+#include <QtCore/QTemporaryFile>
+#include <QtCore/QThreadPool>
+
+#ifdef Q_OS_WIN
+#  include <windows.h>
+#  include <io.h>     // _get_osfhandle
+#else /* POSIX */
+#  include <unistd.h> // fsync
+#endif
+
+/* Thresholds of the recommendation */
+static const qint64 NVME_MIN_SEQUENTIAL_RATE = 800 * 1000 * 1000;   // 800 MB/s
+static const qreal NVME_MIN_RANDOM_IOPS = 1000;
+static const qreal HDD_MAX_RANDOM_IOPS = 150;                       // seek-bound
+
+static const qint64 SEQUENTIAL_CHUNK_BYTES = 1024 * 1024;
+
+/*!
+ * \class DiskBenchmark
+ *
+ * The class DiskBenchmark measures the throughput of the disk
+ * that contains the given directory, and recommends a torrent preset.
+ *
+ * Two measures are taken on a temporary file:
+ * - the sequential write rate, flushed to the device,
+ * - the synchronous writes of a torrent block at random offsets,
+ *   that reveal the seek latency of rotating disks.
+ *
+ * The reads are not measured: the file written just before
+ * is in the OS cache, and would give the speed of the memory.
+ *
+ * \remark The memory of the machine is not measured:
+ * the Low RAM preset is chosen by the user.
+ */
+
+DiskBenchmark::DiskBenchmark(QObject *parent) : QObject(parent)
+  , m_pool(new QThreadPool(this))
+{
+    m_pool->setMaxThreadCount(1);
+}
+
+DiskBenchmark::~DiskBenchmark()
+{
+    m_pool->waitForDone();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+bool DiskBenchmark::isRunning() const
+{
+    return m_running;
+}
+
+DiskBenchmark::Result DiskBenchmark::result() const
+{
+    return m_result;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \brief Measures the disk of the given \a path in a background thread.
+ * The signal finished() is emitted when the result() is available.
+ */
+void DiskBenchmark::start(const QString &path)
+{
+    if (m_running) {
+        return;
+    }
+    m_running = true;
+    m_pool->start([this, path]() {
+        auto result = measure(path);
+        QMetaObject::invokeMethod(this, [this, result]() {
+            m_result = result;
+            m_running = false;
+            emit finished();
+        }, Qt::QueuedConnection);
+    });
+}
+
+/******************************************************************************
+ ******************************************************************************/
+static bool syncToDevice(QFile &file)
+{
+    if (!file.flush()) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    auto handle = reinterpret_cast<HANDLE>(_get_osfhandle(file.handle()));
+    return FlushFileBuffers(handle) != 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+/*!
+ * \brief Measures the disk of the given \a path, in the calling thread.
+ */
+DiskBenchmark::Result DiskBenchmark::measure(const QString &path,
+                                             qint64 fileBytes,
+                                             int maxRandomWrites)
+{
+    Result result;
+
+    QTemporaryFile file(QDir(path).filePath(QLatin1String("arrowdl-benchmark-XXXXXX.tmp")));
+    if (!file.open()) {
+        result.errorString = file.errorString();
+        return result;
+    }
+
+    /* Random content, in case of a compressing file system */
+    QByteArray chunk(static_cast<int>(SEQUENTIAL_CHUNK_BYTES), Qt::Uninitialized);
+    QRandomGenerator::global()->fillRange(
+                reinterpret_cast<quint32*>(chunk.data()),
+                chunk.size() / static_cast<int>(sizeof(quint32)));
+
+    /* Sequential writes */
+    QElapsedTimer timer;
+    timer.start();
+    for (qint64 written = 0; written < fileBytes; written += chunk.size()) {
+        auto size = qMin<qint64>(chunk.size(), fileBytes - written);
+        if (file.write(chunk.constData(), size) != size) {
+            result.errorString = file.errorString();
+            return result;
+        }
+    }
+    if (!syncToDevice(file)) {
+        result.errorString = QObject::tr("Can't flush the file to the disk.");
+        return result;
+    }
+    auto elapsed = qMax<qint64>(1, timer.nsecsElapsed());
+    result.sequentialWriteRate = static_cast<qint64>(fileBytes * 1e9 / elapsed);
+
+    /* Random synchronous writes of a block */
+    auto blockCount = qMax<qint64>(1, fileBytes / DISK_BENCHMARK_BLOCK_BYTES);
+    auto block = chunk.left(static_cast<int>(DISK_BENCHMARK_BLOCK_BYTES));
+    auto operations = 0;
+    timer.restart();
+    while (operations < maxRandomWrites
+           && timer.elapsed() < DISK_BENCHMARK_RANDOM_DURATION_MSECS) {
+        auto offset = QRandomGenerator::global()->bounded(blockCount) * DISK_BENCHMARK_BLOCK_BYTES;
+        if (!file.seek(offset)
+                || file.write(block) != block.size()
+                || !syncToDevice(file)) {
+            result.errorString = file.errorString();
+            return result;
+        }
+        operations++;
+    }
+    elapsed = qMax<qint64>(1, timer.nsecsElapsed());
+    result.randomWriteIops = operations * 1e9 / elapsed;
+
+    return result;
+}
+
+/*!
+ * \brief Returns the preset that suits the measured disk.
+ */
+DiskBenchmark::Recommendation DiskBenchmark::recommend(const Result &result)
+{
+    if (!result.isValid()) {
+        return Recommendation::Default;
+    }
+    if (result.randomWriteIops < HDD_MAX_RANDOM_IOPS) {
+        return Recommendation::HddArray;
+    }
+    if (result.sequentialWriteRate >= NVME_MIN_SEQUENTIAL_RATE
+            && result.randomWriteIops >= NVME_MIN_RANDOM_IOPS) {
+        return Recommendation::Nvme;
+    }
+    return Recommendation::Default;
+}
@@ -0,0 +1,69 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CORE_DISK_BENCHMARK_H
+#define CORE_DISK_BENCHMARK_H
+
+#include <Constants>
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+
+class QThreadPool;
+
+class DiskBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Recommendation {
+        Default = 0,
+        Nvme,
+        HddArray
+    };
+
+    struct Result
+    {
+        qint64 sequentialWriteRate = 0; ///< in bytes per second
+        qreal randomWriteIops = 0;      ///< synchronous writes of one block, per second
+        QString errorString = {};
+
+        bool isValid() const { return errorString.isEmpty() && sequentialWriteRate > 0; }
+    };
+
+    explicit DiskBenchmark(QObject *parent = nullptr);
+    ~DiskBenchmark() override;
+
+    bool isRunning() const;
+    Result result() const;
+
+    void start(const QString &path);
+
+    static Result measure(const QString &path,
+                          qint64 fileBytes = DISK_BENCHMARK_FILE_BYTES,
+                          int maxRandomWrites = DISK_BENCHMARK_MAX_RANDOM_WRITES);
+    static Recommendation recommend(const Result &result);
+
+signals:
+    void finished();
+
+private:
+    QThreadPool *m_pool = nullptr;
+    Result m_result = {};
+    bool m_running = false;
+};
+
+#endif // CORE_DISK_BENCHMARK_H
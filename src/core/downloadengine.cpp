@@ -47,28 +47,128 @@ DownloadEngine::~DownloadEngine()
 
 /******************************************************************************
  ******************************************************************************/
-qsizetype DownloadEngine::downloadingCount() const
+/*!
+ * \brief Returns the number of downloads that occupy a slot,
+ * among the torrents if \a torrent is true, or among the other downloads.
+ *
+ * A stalled torrent keeps downloading, but doesn't occupy a slot.
+ */
+qsizetype DownloadEngine::downloadingCount(bool torrent) const
 {
     auto count = 0;
     for (auto item : m_items) {
-        if (item->isDownloading()) {
+        if (item->isDownloading()
+                && isTorrent(item) == torrent
+                && !(torrent && isStalled(item))) {
             count++;
         }
     }
     return count;
 }
 
+/*!
+ * \brief Starts the queued items, in the queue order, while there are slots.
+ *
+ * The torrents and the other downloads have separate slots:
+ * a torrent waiting for peers doesn't delay a HTTP download, and vice versa.
+ */
 void DownloadEngine::startNext(IDownloadItem * /*item*/)
 {
-    if (downloadingCount() < m_maxSimultaneousDownloads) {
-        for (auto item : m_items) {
-            if (item->state() == IDownloadItem::Idle) {
-                item->resume();
-                startNext(nullptr);
-                break;
+    auto downloadCount = downloadingCount(false);
+    auto torrentCount = downloadingCount(true);
+    for (auto item : m_items) {
+        if (downloadCount >= m_maxSimultaneousDownloads
+                && torrentCount >= m_maxSimultaneousTorrents) {
+            break;
+        }
+        if (item->state() != IDownloadItem::Idle || isDeferred(item)) {
+            continue;
+        }
+        auto torrent = isTorrent(item);
+        auto &count = torrent ? torrentCount : downloadCount;
+        auto max = torrent ? m_maxSimultaneousTorrents : m_maxSimultaneousDownloads;
+        if (count < max) {
+            item->resume();
+            if (item->isDownloading()) {
+                count++;
             }
         }
     }
+    /* Prepare the next turns (DNS...) */
+    prefetch(nextJobs(DNS_PREFETCH_LOOKAHEAD));
+}
+
+/*!
+ * \brief Calls startNext() once, at the next event loop iteration,
+ * however many times it's called meanwhile.
+ */
+void DownloadEngine::scheduleStartNext()
+{
+    if (m_isStartNextPending) {
+        return;
+    }
+    m_isStartNextPending = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_isStartNextPending = false;
+        startNext(nullptr);
+    });
+}
+
+/*!
+ * \brief Returns the first \a count items waiting for their turn.
+ */
+QList<IDownloadItem *> DownloadEngine::nextJobs(qsizetype count) const
+{
+    QList<IDownloadItem *> list;
+    for (auto item : m_items) {
+        if (list.size() >= count) {
+            break;
+        }
+        if (item->state() == IDownloadItem::Idle) {
+            list.append(item);
+        }
+    }
+    return list;
+}
+
+/*!
+ * \brief Reimplement this method to keep the given item in the queue,
+ * without occupying a slot, e.g. when its host can't be resolved.
+ * The deferred item is skipped, and the next one is started instead.
+ * \remark Optional
+ */
+bool DownloadEngine::isDeferred(IDownloadItem * /*item*/) const
+{
+    return false;
+}
+
+/*!
+ * \brief Reimplement this method to count the given item
+ * among the torrents, that have their own slots.
+ * \remark Optional
+ */
+bool DownloadEngine::isTorrent(IDownloadItem * /*item*/) const
+{
+    return false;
+}
+
+/*!
+ * \brief Reimplement this method to free the slot of the given torrent
+ * while it doesn't download, e.g. when it waits for the metadata or peers.
+ * The torrent keeps running, and the next one is started.
+ * \remark Optional
+ */
+bool DownloadEngine::isStalled(IDownloadItem * /*item*/) const
+{
+    return false;
+}
+
+/*!
+ * \brief Reimplement this method to prepare the items that will start soon.
+ * \remark Optional
+ */
+void DownloadEngine::prefetch(const QList<IDownloadItem *> &/*items*/)
+{
 }
 
 /******************************************************************************
@@ -178,6 +278,16 @@ void DownloadEngine::setMaxSimultaneousDownloads(int number)
     m_maxSimultaneousDownloads = number;
 }
 
+int DownloadEngine::maxSimultaneousTorrents() const
+{
+    return m_maxSimultaneousTorrents;
+}
+
+void DownloadEngine::setMaxSimultaneousTorrents(int number)
+{
+    m_maxSimultaneousTorrents = number;
+}
+
 /******************************************************************************
  ******************************************************************************/
 QList<IDownloadItem *> DownloadEngine::downloadItems() const
@@ -284,6 +394,14 @@ void DownloadEngine::onChanged()
 {
     auto downloadItem = qobject_cast<AbstractDownloadItem *>(sender());
     emit jobStateChanged(downloadItem);
+
+    /*
+     * A torrent frees its slot without finishing,
+     * when it's stalled or when it starts seeding.
+     */
+    if (downloadItem && isTorrent(downloadItem)) {
+        scheduleStartNext();
+    }
 }
 
 void DownloadEngine::onFinished()
@@ -50,6 +50,9 @@ public:
     int maxSimultaneousDownloads() const;
     void setMaxSimultaneousDownloads(int number);
 
+    int maxSimultaneousTorrents() const;
+    void setMaxSimultaneousTorrents(int number);
+
     /* Statistics */
     QList<IDownloadItem *> downloadItems() const;
     QList<IDownloadItem *> waitingJobs() const;
@@ -92,6 +95,18 @@ public:
     virtual IDownloadItem* createItem(const QUrl &url);
     virtual IDownloadItem* createTorrentItem(const QUrl &url);
 
+protected:
+    /* Scheduling */
+    virtual bool isDeferred(IDownloadItem *item) const;
+    virtual bool isTorrent(IDownloadItem *item) const;
+    virtual bool isStalled(IDownloadItem *item) const;
+    virtual void prefetch(const QList<IDownloadItem *> &items);
+    QList<IDownloadItem *> nextJobs(qsizetype count) const;
+    void scheduleStartNext();
+
+protected slots:
+    void startNext(IDownloadItem *item);
+
 signals:
     void jobAppended(DownloadRange range);
     void jobRemoved(DownloadRange range);
@@ -108,7 +123,6 @@ private slots:
     void onChanged();
     void onFinished();
     void onRenamed(const QString &oldName, const QString &newName, bool success);
-    void startNext(IDownloadItem *item);
 
 private slots:
     void onSpeedTimerTimeout();
@@ -121,7 +135,9 @@ private:
 
     // Pool
     int m_maxSimultaneousDownloads = 4;
-    qsizetype downloadingCount() const;
+    int m_maxSimultaneousTorrents = 3;
+    bool m_isStartNextPending = false;
+    qsizetype downloadingCount(bool torrent) const;
 
     QList<IDownloadItem *> m_selectedItems = {};
     bool m_selectionAboutToChange = false;
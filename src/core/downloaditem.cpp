@@ -20,19 +20,41 @@
 #include <Core/File>
 #include <Core/NetworkManager>
 #include <Core/ResourceItem>
+#include <Core/RetryPolicy>
 #include <Core/Settings>
 
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QDir>
+#include <QtCore/QTimer>
+#include <QtCore/QtMath>
 #include <QtNetwork/QNetworkReply>
 
 using namespace Qt::Literals::StringLiterals;
 
+/*!
+ * \brief Returns the first byte of the 'Content-Range' header,
+ * e.g. 100 for "bytes 100-199/1000", or -1 if invalid.
+ */
+static qsizetype contentRangeStart(const QByteArray &contentRange)
+{
+    auto value = contentRange.trimmed();
+    auto dash = value.indexOf('-');
+    if (!value.startsWith("bytes ") || dash < 0) {
+        return -1;
+    }
+    auto ok = false;
+    auto start = value.mid(6, dash - 6).trimmed().toLongLong(&ok);
+    return ok ? static_cast<qsizetype>(start) : -1;
+}
+
 DownloadItemPrivate::DownloadItemPrivate(DownloadItem *qq)
     : q(qq)
 {
     file = new File(qq);
+    retryTimer = new QTimer(qq);
+    retryTimer->setSingleShot(true);
 }
 
 /******************************************************************************
@@ -41,6 +63,8 @@ DownloadItem::DownloadItem(DownloadManager *downloadManager) : AbstractDownloadI
   , d(new DownloadItemPrivate(this))
 {
     d->downloadManager = downloadManager;
+
+    connect(d->retryTimer, SIGNAL(timeout()), this, SLOT(onRetryTimeout()));
 }
 
 DownloadItem::~DownloadItem()
@@ -51,6 +75,13 @@ DownloadItem::~DownloadItem()
     }
 
     if (d->reply) {
+        /*
+         * abort() emits errorOccurred() and finished() synchronously:
+         * the item is being destroyed, don't record a failure of the host
+         * nor touch the file.
+         */
+        d->isAborting = true;
+        d->reply->disconnect(this);
         d->reply->abort();
         d->reply->deleteLater();
         d->reply = nullptr;
@@ -63,9 +94,26 @@ void DownloadItem::resume()
 {
     logInfo(QString("Resume '%0' (destination: '%1').").arg(d->resource->url(), localFullFileName()));
 
+    /* A manual resume supersedes the pending retry, and resets the counter */
+    d->retryTimer->stop();
+    if (!d->isRetrying) {
+        d->retryAttempt = 0;
+    }
+    d->isRetrying = false;
+
     this->beginResume();
 
-    auto flag = d->file->open(d->resource);
+    File::OpenFlag flag;
+    if (d->resumeOffset > 0 && d->file->isOpen()) {
+        /* Keep the partial data of the previous attempt */
+        logInfo(QString("Resume from offset %0 bytes.").arg(QString::number(d->resumeOffset)));
+        flag = File::Open;
+    } else {
+        d->resumeOffset = 0;
+        d->validator.clear();
+        d->isRangeSupported = false;
+        flag = d->file->open(d->resource);
+    }
 
     if (flag == File::Skip) {
         setState(Skipped);
@@ -80,8 +128,18 @@ void DownloadItem::resume()
     if (this->checkResume(connected)) {
 
         auto url = d->resource->url_TODO();
-        d->reply = d->downloadManager->networkManager()->get(url);
+
+        d->timing = {};
+        d->timing.setHost(url.host());
+        d->timing.setDuration(DownloadTiming::Queue, queueWaitTime());
+        d->connectStartTime = -1;
+        d->requestSentTime = -1;
+        d->responseTime = -1;
+        d->timingClock.start();
+
+        d->reply = d->downloadManager->networkManager()->getRange(url, d->resumeOffset, d->validator);
         d->reply->setParent(this);
+        d->isContent = false; // until the status of the response is known
 
         /* Signals/Slots of QNetworkReply */
         connect(d->reply, SIGNAL(metaDataChanged()), this, SLOT(onMetaDataChanged()));
@@ -90,6 +148,13 @@ void DownloadItem::resume()
         connect(d->reply, SIGNAL(errorOccurred(QNetworkReply::NetworkError)), this, SLOT(onErrorOccurred(QNetworkReply::NetworkError)));
         connect(d->reply, SIGNAL(finished()), this, SLOT(onFinished()));
 
+        /* Timing */
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+        connect(d->reply, SIGNAL(socketStartedConnecting()), this, SLOT(onSocketStartedConnecting()));
+#endif
+        connect(d->reply, SIGNAL(encrypted()), this, SLOT(onEncrypted()));
+        connect(d->reply, SIGNAL(requestSent()), this, SLOT(onRequestSent()));
+
         /* Signals/Slots of QIODevice */
         connect(d->reply, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
         connect(d->reply, SIGNAL(aboutToClose()), this, SLOT(onAboutToClose()));
@@ -102,15 +167,19 @@ void DownloadItem::pause()
 {
     /// \todo implement?
     logInfo(QString("Pause '%0'.").arg(d->resource->url()));
+    cancelRetry();
     AbstractDownloadItem::pause();
 }
 
 void DownloadItem::stop()
 {
     logInfo(QString("Stop '%0'.").arg(d->resource->url()));
+    cancelRetry();
     d->file->cancel();
     if (d->reply) {
+        d->isAborting = true;
         d->reply->abort();
+        d->isAborting = false;
         d->reply->deleteLater();
         d->reply = nullptr;
     }
@@ -154,6 +223,11 @@ void DownloadItem::rename(const QString &newName)
  ******************************************************************************/
 void DownloadItem::onMetaDataChanged()
 {
+    if (d->reply && d->responseTime < 0) {
+        d->responseTime = d->timingClock.elapsed();
+        auto from = d->requestSentTime >= 0 ? d->requestSentTime : 0;
+        d->timing.setDuration(DownloadTiming::Ttfb, d->responseTime - from);
+    }
     if (d->reply) {
         auto rawNewUrl = d->reply->header(QNetworkRequest::LocationHeader);
         if (rawNewUrl.isValid()) {
@@ -164,6 +238,44 @@ void DownloadItem::onMetaDataChanged()
                 logInfo(QString("HTTP redirect: '%0' to '%1'.").arg(oldUrl.toString(), newUrl.toString()));
             }
         }
+        auto statusCode = d->reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        d->isContent = statusCode == 200 || statusCode == 206;
+        if (statusCode == 206) {
+            auto start = contentRangeStart(d->reply->rawHeader(QByteArray("Content-Range")));
+            if (start != d->resumeOffset) {
+                /*
+                 * The range doesn't continue the partial file:
+                 * discard it, and restart from zero.
+                 */
+                logInfo(QString("Partial content discarded: range starts at %0 instead of %1.")
+                        .arg(QString::number(start), QString::number(d->resumeOffset)));
+                d->isContent = false;
+                d->file->cancel();
+                d->resumeOffset = 0;
+                d->validator.clear();
+                d->isRangeSupported = false;
+                d->isRestarting = true;
+                d->reply->abort();
+                return;
+            }
+        }
+        if (d->isContent) {
+            if (d->resumeOffset > 0 && statusCode == 200) {
+                /*
+                 * The server ignored the range, or the resource has changed
+                 * since the previous attempt (If-Range): restart from zero.
+                 */
+                logInfo(QString("Partial content discarded: server sent the whole content."));
+                d->file->truncate();
+                d->resumeOffset = 0;
+            }
+            d->isRangeSupported = statusCode == 206
+                    || d->reply->rawHeader(QByteArray("Accept-Ranges")).trimmed() == QByteArray("bytes");
+            auto etag = d->reply->rawHeader(QByteArray("ETag"));
+            d->validator = (!etag.isEmpty() && !etag.startsWith("W/"))
+                    ? etag
+                    : d->reply->rawHeader(QByteArray("Last-Modified"));
+        }
         auto settings = d->downloadManager->settings();
         auto rawTime = d->reply->header(QNetworkRequest::LastModifiedHeader);
         if (settings && rawTime.isValid()) {
@@ -192,8 +304,10 @@ void DownloadItem::onDownloadProgress(qint64 bytesReceived, qint64 bytesTotal)
                      QString::number(bytesReceived),
                      QString::number(bytesTotal)));
     }
-    updateInfo(static_cast<qsizetype>(bytesReceived),
-               static_cast<qsizetype>(bytesTotal));
+    /* When resuming, the reply only counts the remaining part */
+    auto offset = d->resumeOffset;
+    updateInfo(offset + static_cast<qsizetype>(bytesReceived),
+               bytesTotal > 0 ? offset + static_cast<qsizetype>(bytesTotal) : static_cast<qsizetype>(bytesTotal));
 }
 
 void DownloadItem::onRedirected(const QUrl &url)
@@ -207,6 +321,9 @@ void DownloadItem::onRedirected(const QUrl &url)
 void DownloadItem::onFinished()
 {
     logInfo(QString("Finished (%0) '%1'.").arg(state_c_str(), localFullFileName()));
+    if (d->timingClock.isValid() && d->responseTime >= 0) {
+        d->timing.setDuration(DownloadTiming::Transfer, d->timingClock.elapsed() - d->responseTime);
+    }
     switch (state()) {
     case Idle:
     case Preparing:
@@ -232,15 +349,39 @@ void DownloadItem::onFinished()
         } else {
             /* Here, finish the operation if downloading. */
             /* If network error or file error, just ignore */
+            QElapsedTimer commitTimer;
+            commitTimer.start();
             bool commited = d->file->commit();
+            d->timing.setDuration(DownloadTiming::Commit, commitTimer.elapsed());
             preFinish(commited);
+            if (commited) {
+                auto policy = d->downloadManager->retryPolicy();
+                if (policy && d->reply) {
+                    policy->recordSuccess(d->reply->url().host());
+                }
+                d->retryAttempt = 0;
+                d->resumeOffset = 0;
+                d->validator.clear();
+            }
         }
         break;
 
+    case NetworkError:
+        if (d->retryTimer->isActive()) {
+            /* Keep the partial data and the progress for the next attempt */
+            emit changed();
+            break;
+        }
+        setBytesReceived(0);
+        setBytesTotal(0);
+        d->file->cancel();
+        d->resumeOffset = 0;
+        emit changed();
+        break;
+
     case Paused:
     case Stopped:
     case Skipped:
-    case NetworkError:
     case FileError:
         setBytesReceived(0);
         setBytesTotal(0);
@@ -252,6 +393,7 @@ void DownloadItem::onFinished()
         d->reply->deleteLater();
         d->reply = nullptr;
     }
+    d->timingClock.invalidate();
     this->finish();
 }
 
@@ -320,18 +462,144 @@ void DownloadItem::onErrorOccurred(QNetworkReply::NetworkError error)
     if (d->reply) {
         logInfo(QString("Error '%0': '%1'.").arg(d->reply->url().toString(),d->reply->errorString()));
     }
-    d->file->cancel();
+    if (d->isRestarting) {
+        /* Restarted from zero at once, not counted as an attempt */
+        d->isRestarting = false;
+        d->retryTimer->start(0);
+        setState(NetworkError);
+        return;
+    }
     auto httpError = statusToHttp(error);
     setErrorMessage(httpError);
+    if (!scheduleRetry(error)) {
+        d->file->cancel();
+        d->resumeOffset = 0;
+    }
     setState(NetworkError);
 }
 
+/*!
+ * \brief Schedules a new attempt if the error is transient.
+ * Returns false if the error is permanent, or if the retries are exhausted.
+ */
+bool DownloadItem::scheduleRetry(QNetworkReply::NetworkError error)
+{
+    auto policy = d->downloadManager->retryPolicy();
+    if (!policy || !d->reply || d->isAborting) {
+        return false;
+    }
+    auto host = d->reply->url().host();
+    auto statusCode = d->reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    auto errorClass = RetryPolicy::classify(error, statusCode);
+    if (errorClass == RetryPolicy::ErrorClass::None) {
+        return false;
+    }
+    policy->recordFailure(host);
+    if (!policy->canRetry(errorClass, d->retryAttempt)) {
+        logInfo(QString("No more retry (%0 attempts).").arg(QString::number(d->retryAttempt)));
+        return false;
+    }
+    auto retryAfter = RetryPolicy::parseRetryAfter(
+                d->reply->rawHeader(QByteArray("Retry-After")),
+                QDateTime::currentDateTimeUtc());
+    auto delay = policy->nextDelay(errorClass, d->retryAttempt, host, retryAfter);
+    d->retryAttempt++;
+
+    /* Resume from offset only if the server can send the remaining part */
+    if (d->isRangeSupported && d->file->isOpen()) {
+        d->resumeOffset = d->file->size();
+    } else {
+        d->file->cancel();
+        d->resumeOffset = 0;
+    }
+    logInfo(QString("Retry %0 of %1 in %2 msec (offset: %3 bytes).")
+            .arg(QString::number(d->retryAttempt),
+                 QString::number(policy->maxAttempts()),
+                 QString::number(delay.count()),
+                 QString::number(d->resumeOffset)));
+    setErrorMessage(tr("%0 (retry %1 of %2 in %3 s)")
+                    .arg(errorMessage(),
+                         QString::number(d->retryAttempt),
+                         QString::number(policy->maxAttempts()),
+                         QString::number(qCeil(static_cast<qreal>(delay.count()) / 1000))));
+    d->retryTimer->start(delay);
+    return true;
+}
+
+bool DownloadItem::isRetryPending() const
+{
+    return d->retryTimer->isActive();
+}
+
+void DownloadItem::cancelRetry()
+{
+    d->retryTimer->stop();
+    d->retryAttempt = 0;
+    d->isRetrying = false;
+    d->resumeOffset = 0;
+    d->validator.clear();
+}
+
+void DownloadItem::onRetryTimeout()
+{
+    if (state() != NetworkError) {
+        return;
+    }
+    /* Re-enter the queue, so that the slot limit is honored */
+    d->isRetrying = true;
+    d->downloadManager->resume(this);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \brief Returns the timing breakdown of the last request.
+ */
+DownloadTiming DownloadItem::timing() const
+{
+    return d->timing;
+}
+
+/*
+ * Not emitted when the connection is reused from the pool.
+ * The time before includes the host lookup, and the wait for a free connection.
+ */
+void DownloadItem::onSocketStartedConnecting()
+{
+    d->connectStartTime = d->timingClock.elapsed();
+    d->timing.setDuration(DownloadTiming::Dns, d->connectStartTime);
+}
+
+void DownloadItem::onEncrypted()
+{
+    d->timing.setEncrypted(true);
+    if (d->connectStartTime >= 0) {
+        d->timing.setDuration(DownloadTiming::Connect, d->timingClock.elapsed() - d->connectStartTime);
+    }
+}
+
+void DownloadItem::onRequestSent()
+{
+    d->requestSentTime = d->timingClock.elapsed();
+    d->responseTime = -1; // redirected
+    if (d->connectStartTime < 0) {
+        d->timing.setConnectionReused(true);
+    } else if (!d->timing.isEncrypted()) {
+        d->timing.setDuration(DownloadTiming::Connect, d->requestSentTime - d->connectStartTime);
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
 void DownloadItem::onReadyRead()
 {
     if (!d->reply || !d->file) {
         return;
     }
     QByteArray data = d->reply->readAll();
+    if (!d->isContent) {
+        return; // error page (503, 429...): not a part of the file
+    }
     d->file->write(data);
 }
 
@@ -354,6 +622,11 @@ void DownloadItem::setResource(ResourceItem *resource)
 
 /******************************************************************************
  ******************************************************************************/
+DownloadManager* DownloadItem::downloadManager() const
+{
+    return d->downloadManager;
+}
+
 File* DownloadItem::file() const
 {
     return d->file;
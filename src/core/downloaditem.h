@@ -26,6 +26,7 @@
 
 class File;
 class DownloadItemPrivate;
+class DownloadTiming;
 class DownloadManager;
 class ResourceItem;
 
@@ -55,6 +56,10 @@ public:
 
     void rename(const QString &newName) override;
 
+    DownloadTiming timing() const;
+
+    bool isRetryPending() const override;
+
 private slots:
     void onMetaDataChanged();
     void onDownloadProgress(qint64 bytesReceived, qint64 bytesTotal);
@@ -63,8 +68,13 @@ private slots:
     void onErrorOccurred(QNetworkReply::NetworkError error);
     void onReadyRead();
     void onAboutToClose();
+    void onRetryTimeout();
+    void onSocketStartedConnecting();
+    void onEncrypted();
+    void onRequestSent();
 
 protected:
+    DownloadManager* downloadManager() const;
     File* file() const;
 
 private:
@@ -72,6 +82,8 @@ private:
     friend class DownloadItemPrivate;
 
     QString statusToHttp(QNetworkReply::NetworkError error);
+    bool scheduleRetry(QNetworkReply::NetworkError error);
+    void cancelRetry();
 };
 
 #endif // CORE_DOWNLOAD_ITEM_H
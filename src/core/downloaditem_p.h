@@ -19,11 +19,16 @@
 
 #include "downloaditem.h"
 
+#include <Core/DownloadTiming>
+
+#include <QtCore/QElapsedTimer>
+
 class DownloadManager;
 class File;
 class ResourceItem;
 
 class QNetworkReply;
+class QTimer;
 
 class DownloadItemPrivate
 {    
@@ -35,6 +40,26 @@ public:
     QNetworkReply *reply = nullptr;
     File *file = nullptr;
 
+    /* Retry */
+    QTimer *retryTimer = nullptr;
+    int retryAttempt = 0;
+    bool isRetrying = false;
+    bool isAborting = false;
+    bool isRestarting = false;
+
+    /* Resume from offset */
+    qsizetype resumeOffset = 0;
+    QByteArray validator = {};
+    bool isRangeSupported = false;
+    bool isContent = false; // the body of the current reply is written to the file
+
+    /* Timing, in msec since the request was created */
+    DownloadTiming timing = {};
+    QElapsedTimer timingClock = {};
+    qint64 connectStartTime = -1;
+    qint64 requestSentTime = -1;
+    qint64 responseTime = -1;
+
     DownloadItem *q = nullptr;
 };
 
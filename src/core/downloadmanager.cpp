@@ -19,10 +19,13 @@
 #include <Constants>
 #include <Core/DownloadItem>
 #include <Core/DownloadTorrentItem>
+#include <Core/HostResolver>
 #include <Core/NetworkManager>
 #include <Core/ResourceItem>
+#include <Core/RetryPolicy>
 #include <Core/Session>
 #include <Core/Settings>
+#include <Core/TorrentStreamServer>
 
 #include <QtCore/QDebug>
 #include <QtCore/QSettings>
@@ -47,7 +50,13 @@ using namespace Qt::Literals::StringLiterals;
 
 DownloadManager::DownloadManager(QObject *parent) : DownloadEngine(parent)
   , m_networkManager(new NetworkManager(this))
+  , m_retryPolicy(new RetryPolicy(this))
+  , m_hostResolver(new HostResolver(this))
+  , m_streamServer(new TorrentStreamServer(this))
 {
+    connect(m_hostResolver, SIGNAL(resolved(QString,bool)), this, SLOT(onHostResolved(QString,bool)));
+    connect(m_retryPolicy, SIGNAL(circuitClosed(QString)), this, SLOT(onCircuitClosed(QString)));
+
     /* Auto save of the queue */
     connect(this, SIGNAL(jobAppended(DownloadRange)), this, SLOT(onQueueChanged(DownloadRange)));
     connect(this, SIGNAL(jobRemoved(DownloadRange)), this, SLOT(onQueueChanged(DownloadRange)));
@@ -87,7 +96,23 @@ void DownloadManager::setSettings(Settings *settings)
 
 void DownloadManager::onSettingsChanged()
 {
+    if (m_networkManager->isProxyEnabled()) {
+        m_hostResolver->clear();
+    }
     setMaxSimultaneousDownloads(m_settings->maxSimultaneousDownloads());
+    setMaxSimultaneousTorrents(m_settings->maxSimultaneousTorrents());
+
+    m_retryPolicy->setEnabled(m_settings->isRetryEnabled());
+    m_retryPolicy->setMaxAttempts(m_settings->retryMaxAttempts());
+    m_retryPolicy->setBaseDelay(std::chrono::milliseconds(m_settings->retryBaseDelay()));
+    m_retryPolicy->setMaxDelay(std::chrono::seconds(m_settings->retryMaxDelay()));
+    m_retryPolicy->setRetryEnabled(RetryPolicy::ErrorClass::Timeout, m_settings->isRetryOnTimeoutEnabled());
+    m_retryPolicy->setRetryEnabled(RetryPolicy::ErrorClass::ServerError, m_settings->isRetryOnServerErrorEnabled());
+    m_retryPolicy->setRetryEnabled(RetryPolicy::ErrorClass::TooManyRequests, m_settings->isRetryOnTooManyRequestsEnabled());
+    m_retryPolicy->setRetryEnabled(RetryPolicy::ErrorClass::ConnectionReset, m_settings->isRetryOnConnectionResetEnabled());
+    m_retryPolicy->setCircuitBreakerThreshold(m_settings->circuitBreakerThreshold());
+    m_retryPolicy->setCircuitBreakerCooldown(std::chrono::seconds(m_settings->circuitBreakerCooldown()));
+
     // reload the queue here
     if (m_queueFile != m_settings->database()) {
         m_queueFile = m_settings->database();
@@ -186,6 +211,77 @@ NetworkManager* DownloadManager::networkManager() const
     return m_networkManager;
 }
 
+RetryPolicy* DownloadManager::retryPolicy() const
+{
+    return m_retryPolicy;
+}
+
+HostResolver* DownloadManager::hostResolver() const
+{
+    return m_hostResolver;
+}
+
+TorrentStreamServer* DownloadManager::streamServer() const
+{
+    return m_streamServer;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \brief Returns true if the host of the item keeps failing (open circuit),
+ * or failed to resolve recently.
+ * The host resolution is ignored behind a proxy, because the local DNS isn't used.
+ */
+bool DownloadManager::isDeferred(IDownloadItem *item) const
+{
+    auto host = item->sourceUrl().host();
+    if (m_retryPolicy->isCircuitOpen(host)) {
+        return true;
+    }
+    if (m_networkManager->isProxyEnabled()) {
+        return false;
+    }
+    return m_hostResolver->isDeferred(host);
+}
+
+bool DownloadManager::isTorrent(IDownloadItem *item) const
+{
+    return dynamic_cast<DownloadTorrentItem*>(item) != nullptr;
+}
+
+bool DownloadManager::isStalled(IDownloadItem *item) const
+{
+    auto torrentItem = dynamic_cast<DownloadTorrentItem*>(item);
+    return torrentItem && torrentItem->isStalled();
+}
+
+/*!
+ * \brief Pre-resolves the hosts of the items that will start soon.
+ * Disabled behind a proxy: the lookups would leak the hosts to the local DNS.
+ */
+void DownloadManager::prefetch(const QList<IDownloadItem *> &items)
+{
+    if (m_networkManager->isProxyEnabled()) {
+        return;
+    }
+    for (auto item : items) {
+        m_hostResolver->prefetch(item->sourceUrl().host());
+    }
+}
+
+void DownloadManager::onHostResolved(const QString &/*host*/, bool /*success*/)
+{
+    /* A deferred item may be ready now */
+    scheduleStartNext();
+}
+
+void DownloadManager::onCircuitClosed(const QString &/*host*/)
+{
+    /* The items deferred by the circuit breaker can start now */
+    scheduleStartNext();
+}
+
 /******************************************************************************
  ******************************************************************************/
 IDownloadItem* DownloadManager::createItem(const QUrl &url)
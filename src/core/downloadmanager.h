@@ -22,8 +22,11 @@
 #include <QtCore/QList>
 #include <QtCore/QString>
 
+class HostResolver;
 class ResourceItem;
+class RetryPolicy;
 class Settings;
+class TorrentStreamServer;
 
 class QTimer;
 class NetworkManager;
@@ -43,13 +46,26 @@ public:
 
     /* Queue Management */
     NetworkManager* networkManager() const;
+    RetryPolicy* retryPolicy() const;
+    HostResolver* hostResolver() const;
+
+    /* Torrent */
+    TorrentStreamServer* streamServer() const;
 
     /* Utility */
     IDownloadItem* createItem(const QUrl &url) override;
     IDownloadItem* createTorrentItem(const QUrl &url) override;
 
+protected:
+    bool isDeferred(IDownloadItem *item) const override;
+    bool isTorrent(IDownloadItem *item) const override;
+    bool isStalled(IDownloadItem *item) const override;
+    void prefetch(const QList<IDownloadItem *> &items) override;
+
 private slots:
     void onSettingsChanged();
+    void onHostResolved(const QString &host, bool success);
+    void onCircuitClosed(const QString &host);
 
     void onQueueChanged(const DownloadRange &range);
     void onQueueChanged(IDownloadItem* item);
@@ -61,6 +77,9 @@ private slots:
 private:
     /* Network parameters (SSL, Proxy, UserAgent...) */
     NetworkManager *m_networkManager = nullptr;
+    RetryPolicy *m_retryPolicy = nullptr;
+    HostResolver *m_hostResolver = nullptr;
+    TorrentStreamServer *m_streamServer = nullptr;
     Settings *m_settings = nullptr;
 
     /* Crash Recovery */
@@ -0,0 +1,223 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "downloadtiming.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QTextStream>
+
+#include <algorithm>
+
+/*!
+ * \class DownloadTiming
+ *
+ * The class DownloadTiming records where the time of a download is spent:
+ * in the queue, resolving the host, connecting, waiting for the server,
+ * transferring the data, and committing the file to the disk.
+ *
+ * The phases are measured from the QNetworkReply signals.
+ * A phase that can't be measured (for example, the connection phases
+ * when the connection is reused from the pool) has a duration of -1.
+ *
+ * \remark QNetworkReply doesn't signal the end of the TCP handshake:
+ * for an encrypted connection, Connect includes the TLS handshake.
+ */
+
+/******************************************************************************
+ ******************************************************************************/
+DownloadTiming::DownloadTiming()
+{
+    m_durations.fill(-1); // not measured
+}
+
+/******************************************************************************
+ ******************************************************************************/
+QString DownloadTiming::host() const
+{
+    return m_host;
+}
+
+void DownloadTiming::setHost(const QString &host)
+{
+    m_host = host;
+}
+
+bool DownloadTiming::isEncrypted() const
+{
+    return m_encrypted;
+}
+
+void DownloadTiming::setEncrypted(bool encrypted)
+{
+    m_encrypted = encrypted;
+}
+
+bool DownloadTiming::isConnectionReused() const
+{
+    return m_connectionReused;
+}
+
+void DownloadTiming::setConnectionReused(bool reused)
+{
+    m_connectionReused = reused;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+qint64 DownloadTiming::duration(Phase phase) const
+{
+    if (phase < 0 || phase >= PhaseCount) {
+        return -1;
+    }
+    return m_durations.at(static_cast<std::size_t>(phase));
+}
+
+void DownloadTiming::setDuration(Phase phase, qint64 msec)
+{
+    if (phase < 0 || phase >= PhaseCount) {
+        return;
+    }
+    m_durations[static_cast<std::size_t>(phase)] = qMax(qint64(-1), msec);
+}
+
+bool DownloadTiming::isMeasured(Phase phase) const
+{
+    return duration(phase) >= 0;
+}
+
+/*!
+ * \brief Returns the sum of the measured phases.
+ */
+qint64 DownloadTiming::total() const
+{
+    qint64 sum = 0;
+    for (auto msec : m_durations) {
+        if (msec > 0) {
+            sum += msec;
+        }
+    }
+    return sum;
+}
+
+bool DownloadTiming::isEmpty() const
+{
+    return std::all_of(m_durations.cbegin(), m_durations.cend(), [](qint64 msec) { return msec < 0; });
+}
+
+/******************************************************************************
+ ******************************************************************************/
+QString DownloadTiming::toString() const
+{
+    QString ret;
+    QTextStream out(&ret);
+    for (int i = 0; i < PhaseCount; ++i) {
+        auto phase = static_cast<Phase>(i);
+        out << phaseName(phase) << ": ";
+        if (isMeasured(phase)) {
+            out << duration(phase) << " ms";
+        } else {
+            out << "-";
+        }
+        out << Qt::endl;
+    }
+    out << QObject::tr("Total") << ": " << total() << " ms" << Qt::endl;
+    return ret;
+}
+
+QString DownloadTiming::phaseName(Phase phase)
+{
+    switch (phase) {
+    case Queue:     return QObject::tr("Queue wait");
+    case Dns:       return QObject::tr("DNS lookup");
+    case Connect:   return QObject::tr("Connect");
+    case Ttfb:      return QObject::tr("Time to first byte");
+    case Transfer:  return QObject::tr("Transfer");
+    case Commit:    return QObject::tr("Disk commit");
+    case PhaseCount:
+        break;
+    }
+    return {};
+}
+
+/*!
+ * \brief Returns the given \a timings aggregated by host, as CSV.
+ *
+ * Each row gives the number of requests to the host,
+ * and the mean and the max duration of each phase.
+ * The slowest hosts (mean total duration) come first.
+ */
+QString DownloadTiming::toCsv(const QList<DownloadTiming> &timings)
+{
+    struct Stats
+    {
+        QString host = {};
+        qint64 count = 0;
+        std::array<qint64, PhaseCount> sums = {};
+        std::array<qint64, PhaseCount> counts = {};
+        std::array<qint64, PhaseCount> maxs = {};
+        qint64 totalSum = 0;
+
+        qint64 meanTotal() const { return count > 0 ? totalSum / count : 0; }
+    };
+
+    QHash<QString, Stats> statsByHost;
+    for (const auto &timing : timings) {
+        if (timing.isEmpty()) {
+            continue;
+        }
+        auto &stats = statsByHost[timing.host()];
+        stats.host = timing.host();
+        stats.count++;
+        stats.totalSum += timing.total();
+        for (std::size_t i = 0; i < PhaseCount; ++i) {
+            auto msec = timing.m_durations.at(i);
+            if (msec >= 0) {
+                stats.sums[i] += msec;
+                stats.counts[i]++;
+                stats.maxs[i] = qMax(stats.maxs.at(i), msec);
+            }
+        }
+    }
+    auto rows = statsByHost.values();
+    std::sort(rows.begin(), rows.end(), [](const Stats &s1, const Stats &s2) {
+        return s1.meanTotal() > s2.meanTotal()
+                || (s1.meanTotal() == s2.meanTotal() && s1.host < s2.host);
+    });
+
+    QString ret;
+    QTextStream out(&ret);
+    out << "host,requests,mean_total_ms";
+    static const char* const columns[PhaseCount] = {
+        "queue", "dns", "connect", "ttfb", "transfer", "commit"
+    };
+    for (auto column : columns) {
+        out << ',' << column << "_mean_ms," << column << "_max_ms";
+    }
+    out << '\n';
+    for (const auto &stats : std::as_const(rows)) {
+        out << stats.host << ',' << stats.count << ',' << stats.meanTotal();
+        for (std::size_t i = 0; i < PhaseCount; ++i) {
+            if (stats.counts.at(i) > 0) {
+                out << ',' << stats.sums.at(i) / stats.counts.at(i) << ',' << stats.maxs.at(i);
+            } else {
+                out << ",,";
+            }
+        }
+        out << '\n';
+    }
+    return ret;
+}
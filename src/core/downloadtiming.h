@@ -0,0 +1,71 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CORE_DOWNLOAD_TIMING_H
+#define CORE_DOWNLOAD_TIMING_H
+
+#include <QtCore/QList>
+#include <QtCore/QString>
+
+#include <array>
+
+/*!
+ * \brief Timing breakdown of a single download request, in milliseconds.
+ */
+class DownloadTiming
+{
+public:
+    enum Phase {
+        Queue = 0,  ///< Waiting for a free slot in the queue
+        Dns,        ///< Host lookup (and waiting for a free connection)
+        Connect,    ///< TCP connect, including TLS handshake when encrypted
+        Ttfb,       ///< Time to first byte: request sent to response headers
+        Transfer,   ///< Response headers to last byte
+        Commit,     ///< Flush and rename of the file on disk
+        PhaseCount
+    };
+
+    DownloadTiming();
+
+    QString host() const;
+    void setHost(const QString &host);
+
+    bool isEncrypted() const;
+    void setEncrypted(bool encrypted);
+
+    bool isConnectionReused() const;
+    void setConnectionReused(bool reused);
+
+    qint64 duration(Phase phase) const;
+    void setDuration(Phase phase, qint64 msec);
+    bool isMeasured(Phase phase) const;
+
+    qint64 total() const;
+    bool isEmpty() const;
+
+    QString toString() const;
+
+    static QString phaseName(Phase phase);
+    static QString toCsv(const QList<DownloadTiming> &timings);
+
+private:
+    QString m_host = {};
+    bool m_encrypted = false;
+    bool m_connectionReused = false;
+    std::array<qint64, PhaseCount> m_durations = {};
+};
+
+#endif // CORE_DOWNLOAD_TIMING_H
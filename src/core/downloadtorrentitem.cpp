@@ -16,20 +16,27 @@
 
 #include "downloadtorrentitem.h"
 
+#include <Constants>
 #include <Core/DownloadManager>
 #include <Core/File>
 #include <Core/Format>
 #include <Core/ResourceItem>
 #include <Core/Torrent>
 #include <Core/TorrentContext>
+#include <Core/TorrentStreamServer>
 
+#include <QtCore/QTimer>
 
 DownloadTorrentItem::DownloadTorrentItem(DownloadManager *downloadManager)
     : DownloadItem(downloadManager)
     , m_torrent(new Torrent(this))
+    , m_stallTimer(new QTimer(this))
 {
     connect(m_torrent, &Torrent::changed, this, &DownloadTorrentItem::onTorrentChanged);
 
+    /* Notifies the DownloadEngine, that frees the slot */
+    m_stallTimer->setSingleShot(true);
+    connect(m_stallTimer, &QTimer::timeout, this, &DownloadTorrentItem::changed);
 }
 
 /******************************************************************************
@@ -75,6 +82,42 @@ Torrent* DownloadTorrentItem::torrent() const
     return m_torrent;
 }
 
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \brief Returns true if the pieces are downloaded in order,
+ * so that a media player can play the files during the download.
+ *
+ * \sa TorrentStreamServer
+ */
+bool DownloadTorrentItem::isStreaming() const
+{
+    return m_torrent->isStreaming();
+}
+
+void DownloadTorrentItem::setStreaming(bool streaming)
+{
+    if (m_torrent->isStreaming() == streaming) {
+        return;
+    }
+    logInfo(QString("%0 streaming '%1'.").arg(streaming ? QString("Enable") : QString("Disable"), resource()->url()));
+    TorrentContext::getInstance().setStreamingEnabled(m_torrent, streaming);
+}
+
+/*!
+ * \brief Returns the local URL to play the file at \a fileIndex
+ * while it's downloading. Enables the streaming mode.
+ */
+QUrl DownloadTorrentItem::streamUrl(int fileIndex)
+{
+    auto server = downloadManager()->streamServer();
+    if (!server->torrentContext()) {
+        server->setTorrentContext(&TorrentContext::getInstance());
+    }
+    setStreaming(true);
+    return server->url(m_torrent, fileIndex);
+}
+
 /******************************************************************************
  ******************************************************************************/
 void DownloadTorrentItem::onTorrentChanged()
@@ -166,6 +209,10 @@ void DownloadTorrentItem::onTorrentChanged()
             break;
         case TorrentInfo::checking_files:
             downloadItemState = IDownloadItem::Preparing;
+            if (m_torrent->recheckInfo().state == TorrentRecheckInfo::Checking) {
+                updateInfo(m_torrent->recheckInfo().bytesChecked,
+                           m_torrent->recheckInfo().bytesTotal);
+            }
             break;
 
         case TorrentInfo::downloading_metadata:
@@ -202,6 +249,7 @@ void DownloadTorrentItem::onTorrentChanged()
     }
 
     setState(downloadItemState);
+    updateStalled();
 }
 
 /******************************************************************************
@@ -297,3 +345,41 @@ bool DownloadTorrentItem::isSeeding() const
 {
     return state() == Seeding;
 }
+
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \brief Returns true if the torrent has been waiting for the metadata,
+ * or downloading slower than TORRENT_INACTIVE_DOWN_RATE, for longer
+ * than TORRENT_INACTIVITY_TIMEOUT.
+ *
+ * Like libtorrent's 'dont_count_slow_torrents', the DownloadEngine
+ * doesn't count a stalled torrent in its slots.
+ *
+ * A torrent whose files are rechecked is stalled too: the rechecks
+ * have their own slots, see TorrentContext::forceRecheck().
+ */
+bool DownloadTorrentItem::isStalled() const
+{
+    if (m_torrent->recheckInfo().state == TorrentRecheckInfo::Checking) {
+        return true;
+    }
+    return m_slowElapsedTimer.isValid()
+            && m_slowElapsedTimer.hasExpired(std::chrono::milliseconds(TORRENT_INACTIVITY_TIMEOUT).count());
+}
+
+void DownloadTorrentItem::updateStalled()
+{
+    auto isSlow = state() == DownloadingMetadata
+            || (state() == Downloading
+                && m_torrent->info().download_payload_rate < TORRENT_INACTIVE_DOWN_RATE);
+    if (!isSlow) {
+        m_slowElapsedTimer.invalidate();
+        m_stallTimer->stop();
+        return;
+    }
+    if (!m_slowElapsedTimer.isValid()) {
+        m_slowElapsedTimer.start();
+        m_stallTimer->start(TORRENT_INACTIVITY_TIMEOUT);
+    }
+}
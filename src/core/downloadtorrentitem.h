@@ -20,9 +20,12 @@
 #include <Core/DownloadItem>
 #include <Core/Torrent>
 
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QObject>
 #include <QtCore/QString>
+#include <QtCore/QUrl>
 
+class QTimer;
 
 class DownloadManager;
 
@@ -44,14 +47,23 @@ public:
 
     Torrent* torrent() const;
 
+    bool isStreaming() const;
+    void setStreaming(bool streaming);
+    QUrl streamUrl(int fileIndex);
+
+    bool isStalled() const;
+
 private slots:
     void onTorrentChanged();
 
 private:
     Torrent *m_torrent = nullptr;
+    QTimer *m_stallTimer = nullptr;
+    QElapsedTimer m_slowElapsedTimer = {};
 
     bool isPreparing() const;
     bool isSeeding() const;
+    void updateStalled();
 };
 
 #endif // CORE_DOWNLOAD_TORRENT_ITEM_H
@@ -251,6 +251,34 @@ void File::cancel()
     }
 }
 
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \brief Returns the number of bytes written so far in the temporary file.
+ */
+qsizetype File::size() const
+{
+    if (m_file) {
+        return static_cast<qsizetype>(m_file->pos());
+    }
+    return 0;
+}
+
+/*!
+ * \brief Discards the bytes written so far, but keeps the file open.
+ *
+ * Used when the server doesn't honor a range request and sends
+ * the whole content again.
+ */
+bool File::truncate()
+{
+    if (m_file && m_file->isOpen()) {
+        m_file->flush();
+        return m_file->seek(0) && m_file->resize(0);
+    }
+    return false;
+}
+
 /******************************************************************************
  ******************************************************************************/
 QString File::customFileName() const
@@ -46,6 +46,9 @@ public:
     bool commit();
     void cancel();
 
+    qsizetype size() const;
+    bool truncate();
+
     bool isOpen() const;
     bool rename(ResourceItem *resource);
     QString customFileName() const;
@@ -0,0 +1,250 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hostresolver.h"
+
+#include <Constants>
+
+#include <QtCore/QDebug>
+#include <QtCore/QTimer>
+#include <QtNetwork/QHostInfo>
+
+/*!
+ * \class HostResolver
+ *
+ * The class HostResolver resolves the hosts of the queued downloads
+ * in the background, before their turn comes.
+ *
+ * The lookups go through QHostInfo, so they also populate the host cache
+ * that QNetworkAccessManager uses when it opens the connection:
+ * the first request to a host no longer pays the DNS latency.
+ *
+ * \remark QHostInfo doesn't expose the TTL of the DNS records.
+ * The entries expire after timeToLive(), that is aligned with
+ * the lifetime of the QHostInfo cache.
+ *
+ * A host that fails to resolve is deferred: the lookup is retried
+ * after negativeTimeToLive(), up to DNS_MAX_FAILURES times. After that,
+ * the host is no longer deferred and the download fails normally.
+ */
+
+/*!
+ * \brief Returns true if the given \a host is an IP literal: nothing to resolve.
+ */
+static bool isIpAddress(const QString &host)
+{
+    return !QHostAddress(host).isNull();
+}
+
+HostResolver::HostResolver(QObject *parent) : QObject(parent)
+  , m_retryTimer(new QTimer(this))
+  , m_timeToLive(DNS_CACHE_TTL)
+  , m_negativeTimeToLive(DNS_NEGATIVE_CACHE_TTL)
+  , m_maxPendingLookups(DNS_MAX_PENDING_LOOKUPS)
+{
+    m_retryTimer->setSingleShot(true);
+    connect(m_retryTimer, SIGNAL(timeout()), this, SLOT(onRetryTimeout()));
+}
+
+HostResolver::~HostResolver()
+{
+    clear();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+std::chrono::seconds HostResolver::timeToLive() const
+{
+    return m_timeToLive;
+}
+
+void HostResolver::setTimeToLive(std::chrono::seconds ttl)
+{
+    m_timeToLive = ttl;
+}
+
+std::chrono::seconds HostResolver::negativeTimeToLive() const
+{
+    return m_negativeTimeToLive;
+}
+
+void HostResolver::setNegativeTimeToLive(std::chrono::seconds ttl)
+{
+    m_negativeTimeToLive = ttl;
+}
+
+int HostResolver::maxPendingLookups() const
+{
+    return m_maxPendingLookups;
+}
+
+void HostResolver::setMaxPendingLookups(int count)
+{
+    m_maxPendingLookups = qMax(1, count);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \brief Resolves the given \a host in the background,
+ * unless it is already resolved (and not expired) or being resolved.
+ *
+ * An IP literal is always resolved: resolved() is not emitted for it.
+ */
+void HostResolver::prefetch(const QString &host)
+{
+    if (host.isEmpty() || isIpAddress(host)) {
+        return;
+    }
+    auto currentStatus = status(host);
+    if (currentStatus == Status::Resolved || currentStatus == Status::Pending) {
+        return;
+    }
+    if (currentStatus == Status::Failed) {
+        return; // Retried by onRetryTimeout()
+    }
+    if (m_waitingHosts.contains(host)) {
+        return;
+    }
+    m_waitingHosts.append(host);
+    lookupWaitingHosts();
+}
+
+void HostResolver::clear()
+{
+    for (auto it = m_lookups.constBegin(); it != m_lookups.constEnd(); ++it) {
+        QHostInfo::abortHostLookup(it.key());
+    }
+    m_lookups.clear();
+    m_waitingHosts.clear();
+    m_entries.clear();
+    m_retryTimer->stop();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+HostResolver::Status HostResolver::status(const QString &host) const
+{
+    if (isIpAddress(host)) {
+        return Status::Resolved;
+    }
+    auto it = m_entries.constFind(host);
+    if (it == m_entries.constEnd()) {
+        return Status::Unknown;
+    }
+    if (it->status == Status::Pending) {
+        return Status::Pending;
+    }
+    if (it->expiry.hasExpired()) {
+        return Status::Unknown;
+    }
+    return it->status;
+}
+
+QList<QHostAddress> HostResolver::addresses(const QString &host) const
+{
+    if (isIpAddress(host)) {
+        return { QHostAddress(host) };
+    }
+    if (status(host) == Status::Resolved) {
+        return m_entries.value(host).addresses;
+    }
+    return {};
+}
+
+/*!
+ * \brief Returns true if the downloads from the given \a host should wait,
+ * because the host failed to resolve recently.
+ */
+bool HostResolver::isDeferred(const QString &host) const
+{
+    auto it = m_entries.constFind(host);
+    if (it == m_entries.constEnd()) {
+        return false;
+    }
+    return it->failures > 0
+            && it->failures < DNS_MAX_FAILURES
+            && it->status != Status::Resolved;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void HostResolver::lookup(const QString &host)
+{
+    auto &entry = m_entries[host];
+    entry.status = Status::Pending;
+    entry.lookupId = QHostInfo::lookupHost(host, this, SLOT(onLookedUp(QHostInfo)));
+    m_lookups.insert(entry.lookupId, host);
+}
+
+void HostResolver::lookupWaitingHosts()
+{
+    while (!m_waitingHosts.isEmpty() && m_lookups.count() < m_maxPendingLookups) {
+        auto host = m_waitingHosts.takeFirst();
+        lookup(host);
+    }
+}
+
+void HostResolver::onLookedUp(const QHostInfo &info)
+{
+    auto host = m_lookups.take(info.lookupId());
+    if (host.isEmpty()) {
+        return; // aborted
+    }
+    auto &entry = m_entries[host];
+    entry.lookupId = -1;
+
+    auto success = info.error() == QHostInfo::NoError && !info.addresses().isEmpty();
+    if (success) {
+        entry.status = Status::Resolved;
+        entry.addresses = info.addresses();
+        entry.expiry.setRemainingTime(m_timeToLive);
+        entry.failures = 0;
+    } else {
+        qWarning() << "Can't resolve host" << host << ":" << info.errorString();
+        entry.status = Status::Failed;
+        entry.addresses.clear();
+        entry.expiry.setRemainingTime(m_negativeTimeToLive);
+        entry.failures++;
+        if (entry.failures < DNS_MAX_FAILURES && !m_retryTimer->isActive()) {
+            m_retryTimer->start(m_negativeTimeToLive);
+        }
+    }
+    emit resolved(host, success);
+
+    lookupWaitingHosts();
+}
+
+void HostResolver::onRetryTimeout()
+{
+    auto hasFailedHosts = false;
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (it->status != Status::Failed || it->failures >= DNS_MAX_FAILURES) {
+            continue;
+        }
+        if (it->expiry.hasExpired()) {
+            if (!m_waitingHosts.contains(it.key())) {
+                m_waitingHosts.append(it.key());
+            }
+        } else {
+            hasFailedHosts = true;
+        }
+    }
+    lookupWaitingHosts();
+    if (hasFailedHosts) {
+        m_retryTimer->start(m_negativeTimeToLive);
+    }
+}
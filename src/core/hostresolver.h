@@ -0,0 +1,94 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CORE_HOST_RESOLVER_H
+#define CORE_HOST_RESOLVER_H
+
+#include <QtCore/QDeadlineTimer>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtNetwork/QHostAddress>
+
+#include <chrono>
+
+class QHostInfo;
+class QTimer;
+
+class HostResolver : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Status {
+        Unknown = 0,    ///< Never resolved, or expired
+        Pending,        ///< Lookup in progress
+        Resolved,
+        Failed
+    };
+
+    explicit HostResolver(QObject *parent = nullptr);
+    ~HostResolver() override;
+
+    std::chrono::seconds timeToLive() const;
+    void setTimeToLive(std::chrono::seconds ttl);
+
+    std::chrono::seconds negativeTimeToLive() const;
+    void setNegativeTimeToLive(std::chrono::seconds ttl);
+
+    int maxPendingLookups() const;
+    void setMaxPendingLookups(int count);
+
+    void prefetch(const QString &host);
+    void clear();
+
+    Status status(const QString &host) const;
+    QList<QHostAddress> addresses(const QString &host) const;
+    bool isDeferred(const QString &host) const;
+
+signals:
+    void resolved(QString host, bool success);
+
+private slots:
+    void onLookedUp(const QHostInfo &info);
+    void onRetryTimeout();
+
+private:
+    struct Entry
+    {
+        Status status = Status::Unknown;
+        QList<QHostAddress> addresses = {};
+        QDeadlineTimer expiry = {};
+        int lookupId = -1;
+        int failures = 0;
+    };
+
+    QHash<QString, Entry> m_entries = {};
+    QHash<int, QString> m_lookups = {};
+    QStringList m_waitingHosts = {};
+    QTimer *m_retryTimer = nullptr;
+
+    std::chrono::seconds m_timeToLive;
+    std::chrono::seconds m_negativeTimeToLive;
+    int m_maxPendingLookups;
+
+    void lookup(const QString &host);
+    void lookupWaitingHosts();
+};
+
+#endif // CORE_HOST_RESOLVER_H
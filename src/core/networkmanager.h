@@ -19,6 +19,7 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QString>
+#include <QtNetwork/QNetworkRequest>
 
 class Settings;
 
@@ -36,9 +37,15 @@ public:
     Settings* settings() const;
     void setSettings(Settings *settings);
 
+    QNetworkRequest request(const QUrl &url, const QString &referer = {}) const;
+
     QNetworkReply* get(const QUrl &url, const QString &referer = {});
+    QNetworkReply* getRange(const QUrl &url, qsizetype offset,
+                            const QByteArray &validator = {},
+                            const QString &referer = {});
 
     static QStringList proxyTypeNames();
+    bool isProxyEnabled() const;
 
 private slots:
     void onSettingsChanged();
@@ -50,7 +57,11 @@ private:
     QNetworkAccessManager *m_networkAccessManager = nullptr;
     Settings *m_settings = nullptr;
 
+    /* Shared by all the requests (implicitly shared, copied on write) */
+    QNetworkRequest m_requestTemplate = {};
+
     void setNetworkSettings(Settings *settings);
+    void setRequestSettings(Settings *settings);
 };
 
 #endif // CORE_NETWORK_MANAGER_H
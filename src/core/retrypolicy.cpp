@@ -0,0 +1,317 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "retrypolicy.h"
+
+#include <QtCore/QDebug>
+#include <QtCore/QLocale>
+#include <QtCore/QRandomGenerator>
+#include <QtCore/QTimer>
+#include <QtCore/QTimeZone>
+
+using namespace Qt::Literals::StringLiterals;
+
+/*!
+ * \class RetryPolicy
+ *
+ * The class RetryPolicy decides whether a failed download must be retried,
+ * and when.
+ *
+ * \li Errors are classified (timeout, 5xx, 429, connection reset),
+ * each class can be enabled or disabled.
+ * \li The delay grows exponentially with the attempt number,
+ * and is randomized ("equal jitter") to avoid synchronized retries.
+ * \li A 'Retry-After' header sent by the server takes precedence.
+ * \li A circuit breaker per host stops hammering a host that keeps failing:
+ * after N consecutive failures, the host is considered down during a cooldown.
+ */
+
+RetryPolicy::RetryPolicy(QObject *parent) : QObject(parent)
+{
+}
+
+/******************************************************************************
+ ******************************************************************************/
+bool RetryPolicy::isEnabled() const
+{
+    return m_enabled;
+}
+
+void RetryPolicy::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+}
+
+int RetryPolicy::maxAttempts() const
+{
+    return m_maxAttempts;
+}
+
+void RetryPolicy::setMaxAttempts(int attempts)
+{
+    m_maxAttempts = qMax(0, attempts);
+}
+
+std::chrono::milliseconds RetryPolicy::baseDelay() const
+{
+    return m_baseDelay;
+}
+
+void RetryPolicy::setBaseDelay(std::chrono::milliseconds delay)
+{
+    m_baseDelay = qMax(std::chrono::milliseconds(1), delay);
+}
+
+std::chrono::milliseconds RetryPolicy::maxDelay() const
+{
+    return m_maxDelay;
+}
+
+void RetryPolicy::setMaxDelay(std::chrono::milliseconds delay)
+{
+    m_maxDelay = qMax(std::chrono::milliseconds(1), delay);
+}
+
+bool RetryPolicy::isRetryEnabled(ErrorClass errorClass) const
+{
+    switch (errorClass) {
+    case ErrorClass::None:              return false;
+    case ErrorClass::Timeout:           return m_retryOnTimeout;
+    case ErrorClass::ServerError:       return m_retryOnServerError;
+    case ErrorClass::TooManyRequests:   return m_retryOnTooManyRequests;
+    case ErrorClass::ConnectionReset:   return m_retryOnConnectionReset;
+    }
+    Q_UNREACHABLE();
+}
+
+void RetryPolicy::setRetryEnabled(ErrorClass errorClass, bool enabled)
+{
+    switch (errorClass) {
+    case ErrorClass::None:                                               break;
+    case ErrorClass::Timeout:           m_retryOnTimeout = enabled;          break;
+    case ErrorClass::ServerError:       m_retryOnServerError = enabled;      break;
+    case ErrorClass::TooManyRequests:   m_retryOnTooManyRequests = enabled;  break;
+    case ErrorClass::ConnectionReset:   m_retryOnConnectionReset = enabled;  break;
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+int RetryPolicy::circuitBreakerThreshold() const
+{
+    return m_circuitBreakerThreshold;
+}
+
+/*!
+ * \brief Number of consecutive failures that opens the circuit of a host.
+ * Zero disables the circuit breaker.
+ */
+void RetryPolicy::setCircuitBreakerThreshold(int failures)
+{
+    m_circuitBreakerThreshold = qMax(0, failures);
+}
+
+std::chrono::milliseconds RetryPolicy::circuitBreakerCooldown() const
+{
+    return m_circuitBreakerCooldown;
+}
+
+void RetryPolicy::setCircuitBreakerCooldown(std::chrono::milliseconds cooldown)
+{
+    m_circuitBreakerCooldown = qMax(std::chrono::milliseconds(0), cooldown);
+}
+
+void RetryPolicy::recordSuccess(const QString &host)
+{
+    auto wasOpen = isCircuitOpen(host);
+    m_hosts.remove(host);
+    if (wasOpen) {
+        emit circuitClosed(host);
+    }
+}
+
+void RetryPolicy::recordFailure(const QString &host)
+{
+    if (host.isEmpty() || m_circuitBreakerThreshold <= 0) {
+        return;
+    }
+    auto &state = m_hosts[host];
+    state.consecutiveFailures++;
+    if (state.consecutiveFailures >= m_circuitBreakerThreshold) {
+        /*
+         * Open (or re-open, if the half-open probe failed) the circuit.
+         * The next request to this host is delayed until the cooldown expires.
+         */
+        state.openUntil.setRemainingTime(m_circuitBreakerCooldown);
+        watchCircuit(host);
+    }
+}
+
+/*!
+ * \brief Emits circuitClosed() when the cooldown of the \a host expires,
+ * so that its queued downloads can start.
+ */
+void RetryPolicy::watchCircuit(const QString &host)
+{
+    QTimer::singleShot(circuitRemainingTime(host), Qt::PreciseTimer, this, [this, host]() {
+        if (!m_hosts.contains(host)) {
+            return; // already closed by recordSuccess()
+        }
+        if (isCircuitOpen(host)) {
+            watchCircuit(host); // re-opened meanwhile
+            return;
+        }
+        emit circuitClosed(host);
+    });
+}
+
+bool RetryPolicy::isCircuitOpen(const QString &host) const
+{
+    return circuitRemainingTime(host) > std::chrono::milliseconds(0);
+}
+
+std::chrono::milliseconds RetryPolicy::circuitRemainingTime(const QString &host) const
+{
+    auto it = m_hosts.constFind(host);
+    if (it == m_hosts.constEnd() || it->openUntil.hasExpired()) {
+        return std::chrono::milliseconds(0);
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(it->openUntil.remainingTimeAsDuration());
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \brief Returns true if an error of class \a errorClass can be retried,
+ * given that \a attempt retries have already been done.
+ */
+bool RetryPolicy::canRetry(ErrorClass errorClass, int attempt) const
+{
+    return m_enabled
+            && attempt < m_maxAttempts
+            && isRetryEnabled(errorClass);
+}
+
+/*!
+ * \brief Returns the exponential backoff delay for the given \a attempt (0-based),
+ * with jitter.
+ *
+ * The delay is randomized in [d/2, d], where d = min(maxDelay, baseDelay * 2^attempt).
+ */
+std::chrono::milliseconds RetryPolicy::backoff(int attempt) const
+{
+    const qint64 base = m_baseDelay.count();
+    const qint64 cap = m_maxDelay.count();
+    const int shift = qBound(0, attempt, 30);
+    const qint64 exponential = qMin(cap, base << shift);
+    const qint64 half = exponential / 2;
+    const qint64 jitter = QRandomGenerator::global()->bounded(half + 1);
+    return std::chrono::milliseconds(exponential - half + jitter);
+}
+
+/*!
+ * \brief Returns the delay before the next attempt.
+ *
+ * The delay is the longest of: the backoff, the server's 'Retry-After'
+ * (429 and 503 only), and the remaining cooldown of the host's circuit.
+ */
+std::chrono::milliseconds RetryPolicy::nextDelay(ErrorClass errorClass,
+                                                 int attempt,
+                                                 const QString &host,
+                                                 std::chrono::milliseconds retryAfter) const
+{
+    auto delay = backoff(attempt);
+    if (errorClass == ErrorClass::TooManyRequests || errorClass == ErrorClass::ServerError) {
+        delay = qMax(delay, qMin(retryAfter, m_maxDelay));
+    }
+    delay = qMax(delay, circuitRemainingTime(host));
+    return delay;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+RetryPolicy::ErrorClass RetryPolicy::classify(QNetworkReply::NetworkError error,
+                                              int httpStatusCode)
+{
+    /*
+     * The HTTP status code is more accurate than the QNetworkReply error,
+     * that maps several codes (e.g. 429, 502, 504) to Unknown*Error.
+     */
+    switch (httpStatusCode) {
+    case 408:
+    case 504:
+        return ErrorClass::Timeout;
+    case 429:
+        return ErrorClass::TooManyRequests;
+    case 500:
+    case 502:
+    case 503:
+        return ErrorClass::ServerError;
+    default:
+        break;
+    }
+    if (httpStatusCode >= 400) {
+        return ErrorClass::None;
+    }
+    switch (error) {
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::ProxyTimeoutError:
+    case QNetworkReply::OperationCanceledError: // QNetworkAccessManager::transferTimeout()
+        return ErrorClass::Timeout;
+
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::ProxyConnectionClosedError:
+        return ErrorClass::ConnectionReset;
+
+    case QNetworkReply::InternalServerError:
+    case QNetworkReply::ServiceUnavailableError:
+        return ErrorClass::ServerError;
+
+    default:
+        break;
+    }
+    return ErrorClass::None;
+}
+
+/*!
+ * \brief Parses the value of a 'Retry-After' HTTP header.
+ *
+ * The value is either a number of seconds ("120"),
+ * or an HTTP-date ("Fri, 31 Dec 1999 23:59:59 GMT").
+ * Returns zero if the value is empty, invalid or in the past.
+ */
+std::chrono::milliseconds RetryPolicy::parseRetryAfter(const QByteArray &value,
+                                                       const QDateTime &now)
+{
+    auto str = QString::fromLatin1(value).trimmed();
+    if (str.isEmpty()) {
+        return std::chrono::milliseconds(0);
+    }
+    bool ok = false;
+    auto seconds = str.toLongLong(&ok);
+    if (ok) {
+        return std::chrono::seconds(qMax(0ll, seconds));
+    }
+    auto date = QLocale::c().toDateTime(str, "ddd, dd MMM yyyy HH:mm:ss 'GMT'"_L1);
+    if (!date.isValid()) {
+        return std::chrono::milliseconds(0);
+    }
+    date.setTimeZone(QTimeZone::utc());
+    auto msecs = now.msecsTo(date);
+    return std::chrono::milliseconds(qMax(0ll, msecs));
+}
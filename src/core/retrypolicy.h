@@ -0,0 +1,112 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CORE_RETRY_POLICY_H
+#define CORE_RETRY_POLICY_H
+
+#include <QtCore/QDateTime>
+#include <QtCore/QDeadlineTimer>
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtNetwork/QNetworkReply>
+
+#include <chrono>
+
+class RetryPolicy : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class ErrorClass {
+        None = 0,           ///< Permanent error, never retried
+        Timeout,            ///< Transfer timeout, proxy timeout, HTTP 408 and 504
+        ServerError,        ///< HTTP 500, 502 and 503
+        TooManyRequests,    ///< HTTP 429, honors 'Retry-After'
+        ConnectionReset     ///< Remote host closed, temporary network failure
+    };
+
+    explicit RetryPolicy(QObject *parent = nullptr);
+    ~RetryPolicy() override = default;
+
+    /* Rules */
+    bool isEnabled() const;
+    void setEnabled(bool enabled);
+
+    int maxAttempts() const;
+    void setMaxAttempts(int attempts);
+
+    std::chrono::milliseconds baseDelay() const;
+    void setBaseDelay(std::chrono::milliseconds delay);
+
+    std::chrono::milliseconds maxDelay() const;
+    void setMaxDelay(std::chrono::milliseconds delay);
+
+    bool isRetryEnabled(ErrorClass errorClass) const;
+    void setRetryEnabled(ErrorClass errorClass, bool enabled);
+
+    /* Circuit Breaker */
+    int circuitBreakerThreshold() const;
+    void setCircuitBreakerThreshold(int failures);
+
+    std::chrono::milliseconds circuitBreakerCooldown() const;
+    void setCircuitBreakerCooldown(std::chrono::milliseconds cooldown);
+
+    void recordSuccess(const QString &host);
+    void recordFailure(const QString &host);
+    bool isCircuitOpen(const QString &host) const;
+    std::chrono::milliseconds circuitRemainingTime(const QString &host) const;
+
+    /* Decision */
+    bool canRetry(ErrorClass errorClass, int attempt) const;
+    std::chrono::milliseconds backoff(int attempt) const;
+    std::chrono::milliseconds nextDelay(ErrorClass errorClass,
+                                        int attempt,
+                                        const QString &host,
+                                        std::chrono::milliseconds retryAfter = {}) const;
+
+    /* Utility */
+    static ErrorClass classify(QNetworkReply::NetworkError error, int httpStatusCode);
+    static std::chrono::milliseconds parseRetryAfter(const QByteArray &value,
+                                                     const QDateTime &now);
+
+signals:
+    void circuitClosed(QString host);
+
+private:
+    struct HostState
+    {
+        int consecutiveFailures = 0;
+        QDeadlineTimer openUntil = {}; // expired
+    };
+
+    bool m_enabled = true;
+    int m_maxAttempts = 5;
+    std::chrono::milliseconds m_baseDelay = std::chrono::milliseconds(1000);
+    std::chrono::milliseconds m_maxDelay = std::chrono::milliseconds(120000);
+    bool m_retryOnTimeout = true;
+    bool m_retryOnServerError = true;
+    bool m_retryOnTooManyRequests = true;
+    bool m_retryOnConnectionReset = true;
+
+    int m_circuitBreakerThreshold = 5;
+    std::chrono::milliseconds m_circuitBreakerCooldown = std::chrono::milliseconds(60000);
+    QHash<QString, HostState> m_hosts = {};
+
+    void watchCircuit(const QString &host);
+};
+
+#endif // CORE_RETRY_POLICY_H
@@ -73,6 +73,20 @@ Settings::Settings(QObject *parent) : AbstractSettings(parent)
 
     addDefaultSettingInt(REGISTRY_SOCKET_TYPE, 0);
     addDefaultSettingInt(REGISTRY_SOCKET_TIMEOUT, DEFAULT_TIMEOUT_SECS);
+    addDefaultSettingInt(REGISTRY_HOST_CONNECTIONS, DEFAULT_CONNECTIONS_PER_HOST);
+    addDefaultSettingBool(REGISTRY_HTTP2_ENABLED, false);
+    addDefaultSettingBool(REGISTRY_TLS_RESUMPTION, true);
+
+    addDefaultSettingBool(REGISTRY_RETRY_ENABLED, true);
+    addDefaultSettingInt(REGISTRY_RETRY_MAX, DEFAULT_RETRY_MAX_ATTEMPTS);
+    addDefaultSettingInt(REGISTRY_RETRY_DELAY, DEFAULT_RETRY_BASE_DELAY_MSECS);
+    addDefaultSettingInt(REGISTRY_RETRY_MAX_DELAY, DEFAULT_RETRY_MAX_DELAY_SECS);
+    addDefaultSettingBool(REGISTRY_RETRY_TIMEOUT, true);
+    addDefaultSettingBool(REGISTRY_RETRY_SERVER, true);
+    addDefaultSettingBool(REGISTRY_RETRY_THROTTLED, true);
+    addDefaultSettingBool(REGISTRY_RETRY_RESET, true);
+    addDefaultSettingInt(REGISTRY_BREAKER_FAILURES, DEFAULT_CIRCUIT_BREAKER_THRESHOLD);
+    addDefaultSettingInt(REGISTRY_BREAKER_COOLDOWN, DEFAULT_CIRCUIT_BREAKER_COOLDOWN_SECS);
 
     addDefaultSettingBool(REGISTRY_REMOTE_CREATION, true);
     addDefaultSettingBool(REGISTRY_REMOTE_LAST_MOD, true);
@@ -144,6 +158,14 @@ Settings::Settings(QObject *parent) : AbstractSettings(parent)
     addDefaultSettingString(REGISTRY_TORRENT_DIR, defaultTorrentShareFolder());
     addDefaultSettingString(REGISTRY_TORRENT_PEERS, QLatin1String(""));
     addDefaultSettingString(REGISTRY_TORRENT_ADVANCED, QLatin1String(""));
+    addDefaultSettingInt(REGISTRY_TORRENT_STATUS_TICK, DEFAULT_TORRENT_STATUS_INTERVAL_MSECS);
+    addDefaultSettingInt(REGISTRY_TORRENT_STATS_TICK, DEFAULT_TORRENT_STATS_INTERVAL_MSECS);
+    addDefaultSettingInt(REGISTRY_TORRENT_DHT_TICK, DEFAULT_TORRENT_DHT_STATS_INTERVAL_MSECS);
+    addDefaultSettingInt(REGISTRY_TORRENT_RESUME_TICK, DEFAULT_TORRENT_RESUME_DATA_INTERVAL_MSECS);
+    addDefaultSettingInt(REGISTRY_TORRENT_DISK_IO, static_cast<int>(TorrentDiskIo::Default));
+    addDefaultSettingInt(REGISTRY_TORRENT_MAX_SIMULTANEOUS, DEFAULT_TORRENT_MAX_SIMULTANEOUS);
+    addDefaultSettingInt(REGISTRY_TORRENT_RECHECKS, DEFAULT_TORRENT_CONCURRENT_RECHECKS);
+    addDefaultSettingInt(REGISTRY_TORRENT_RECHECK_BUDGET, DEFAULT_TORRENT_RECHECK_BUDGET_MB);
 
     // Tab Advanced
     addDefaultSettingInt(REGISTRY_CHECK_UPDATE, static_cast<int>(CheckUpdateBeatMode::OnceADay));
@@ -420,6 +442,136 @@ void Settings::setConnectionTimeout(int number)
     setSettingInt(REGISTRY_SOCKET_TIMEOUT, number);
 }
 
+int Settings::connectionsPerHost() const
+{
+    return getSettingInt(REGISTRY_HOST_CONNECTIONS);
+}
+
+void Settings::setConnectionsPerHost(int number)
+{
+    setSettingInt(REGISTRY_HOST_CONNECTIONS, number);
+}
+
+bool Settings::isHttp2Enabled() const
+{
+    return getSettingBool(REGISTRY_HTTP2_ENABLED);
+}
+
+void Settings::setHttp2Enabled(bool enabled)
+{
+    setSettingBool(REGISTRY_HTTP2_ENABLED, enabled);
+}
+
+bool Settings::isTlsSessionResumptionEnabled() const
+{
+    return getSettingBool(REGISTRY_TLS_RESUMPTION);
+}
+
+void Settings::setTlsSessionResumptionEnabled(bool enabled)
+{
+    setSettingBool(REGISTRY_TLS_RESUMPTION, enabled);
+}
+
+bool Settings::isRetryEnabled() const
+{
+    return getSettingBool(REGISTRY_RETRY_ENABLED);
+}
+
+void Settings::setRetryEnabled(bool enabled)
+{
+    setSettingBool(REGISTRY_RETRY_ENABLED, enabled);
+}
+
+int Settings::retryMaxAttempts() const
+{
+    return getSettingInt(REGISTRY_RETRY_MAX);
+}
+
+void Settings::setRetryMaxAttempts(int number)
+{
+    setSettingInt(REGISTRY_RETRY_MAX, number);
+}
+
+int Settings::retryBaseDelay() const
+{
+    return getSettingInt(REGISTRY_RETRY_DELAY);
+}
+
+void Settings::setRetryBaseDelay(int msecs)
+{
+    setSettingInt(REGISTRY_RETRY_DELAY, msecs);
+}
+
+int Settings::retryMaxDelay() const
+{
+    return getSettingInt(REGISTRY_RETRY_MAX_DELAY);
+}
+
+void Settings::setRetryMaxDelay(int secs)
+{
+    setSettingInt(REGISTRY_RETRY_MAX_DELAY, secs);
+}
+
+bool Settings::isRetryOnTimeoutEnabled() const
+{
+    return getSettingBool(REGISTRY_RETRY_TIMEOUT);
+}
+
+void Settings::setRetryOnTimeoutEnabled(bool enabled)
+{
+    setSettingBool(REGISTRY_RETRY_TIMEOUT, enabled);
+}
+
+bool Settings::isRetryOnServerErrorEnabled() const
+{
+    return getSettingBool(REGISTRY_RETRY_SERVER);
+}
+
+void Settings::setRetryOnServerErrorEnabled(bool enabled)
+{
+    setSettingBool(REGISTRY_RETRY_SERVER, enabled);
+}
+
+bool Settings::isRetryOnTooManyRequestsEnabled() const
+{
+    return getSettingBool(REGISTRY_RETRY_THROTTLED);
+}
+
+void Settings::setRetryOnTooManyRequestsEnabled(bool enabled)
+{
+    setSettingBool(REGISTRY_RETRY_THROTTLED, enabled);
+}
+
+bool Settings::isRetryOnConnectionResetEnabled() const
+{
+    return getSettingBool(REGISTRY_RETRY_RESET);
+}
+
+void Settings::setRetryOnConnectionResetEnabled(bool enabled)
+{
+    setSettingBool(REGISTRY_RETRY_RESET, enabled);
+}
+
+int Settings::circuitBreakerThreshold() const
+{
+    return getSettingInt(REGISTRY_BREAKER_FAILURES);
+}
+
+void Settings::setCircuitBreakerThreshold(int failures)
+{
+    setSettingInt(REGISTRY_BREAKER_FAILURES, failures);
+}
+
+int Settings::circuitBreakerCooldown() const
+{
+    return getSettingInt(REGISTRY_BREAKER_COOLDOWN);
+}
+
+void Settings::setCircuitBreakerCooldown(int secs)
+{
+    setSettingInt(REGISTRY_BREAKER_COOLDOWN, secs);
+}
+
 bool Settings::isRemoteCreationTimeEnabled() const
 {
     return getSettingBool(REGISTRY_REMOTE_CREATION);
@@ -746,6 +898,110 @@ void Settings::setTorrentSettings(const QMap<QString, QVariant> &map)
     setSettingString(REGISTRY_TORRENT_ADVANCED, value);
 }
 
+/*!
+ * \brief Intervals, in milliseconds, between two requests of
+ * the torrent status, of the session stats and of the DHT stats.
+ * 0 disables the request.
+ */
+int Settings::torrentStatusInterval() const
+{
+    return getSettingInt(REGISTRY_TORRENT_STATUS_TICK);
+}
+
+void Settings::setTorrentStatusInterval(int msecs)
+{
+    setSettingInt(REGISTRY_TORRENT_STATUS_TICK, msecs);
+}
+
+int Settings::torrentSessionStatsInterval() const
+{
+    return getSettingInt(REGISTRY_TORRENT_STATS_TICK);
+}
+
+void Settings::setTorrentSessionStatsInterval(int msecs)
+{
+    setSettingInt(REGISTRY_TORRENT_STATS_TICK, msecs);
+}
+
+int Settings::torrentDhtStatsInterval() const
+{
+    return getSettingInt(REGISTRY_TORRENT_DHT_TICK);
+}
+
+void Settings::setTorrentDhtStatsInterval(int msecs)
+{
+    setSettingInt(REGISTRY_TORRENT_DHT_TICK, msecs);
+}
+
+int Settings::torrentResumeDataInterval() const
+{
+    return getSettingInt(REGISTRY_TORRENT_RESUME_TICK);
+}
+
+void Settings::setTorrentResumeDataInterval(int msecs)
+{
+    setSettingInt(REGISTRY_TORRENT_RESUME_TICK, msecs);
+}
+
+/*!
+ * \brief The disk I/O backend of the torrent session.
+ *
+ * The backend is chosen when the session is constructed:
+ * a change takes effect at the next start of the application.
+ */
+TorrentDiskIo Settings::torrentDiskIo() const
+{
+    return static_cast<TorrentDiskIo>(getSettingInt(REGISTRY_TORRENT_DISK_IO));
+}
+
+void Settings::setTorrentDiskIo(TorrentDiskIo backend)
+{
+    setSettingInt(REGISTRY_TORRENT_DISK_IO, static_cast<int>(backend));
+}
+
+/*!
+ * \brief The number of torrents downloading at the same time,
+ * in addition to the other downloads (see maxSimultaneousDownloads()).
+ * The stalled torrents aren't counted.
+ */
+int Settings::maxSimultaneousTorrents() const
+{
+    return getSettingInt(REGISTRY_TORRENT_MAX_SIMULTANEOUS);
+}
+
+void Settings::setMaxSimultaneousTorrents(int number)
+{
+    setSettingInt(REGISTRY_TORRENT_MAX_SIMULTANEOUS, number);
+}
+
+/*!
+ * \brief The number of torrents whose files are rechecked at the same time.
+ * The other forced rechecks wait in a queue.
+ */
+int Settings::concurrentTorrentRechecks() const
+{
+    return getSettingInt(REGISTRY_TORRENT_RECHECKS);
+}
+
+void Settings::setConcurrentTorrentRechecks(int number)
+{
+    setSettingInt(REGISTRY_TORRENT_RECHECKS, number);
+}
+
+/*!
+ * \brief The disk reads in flight for the rechecks, in MiB,
+ * shared by the concurrent rechecks.
+ */
+int Settings::torrentRecheckBudget() const
+{
+    return getSettingInt(REGISTRY_TORRENT_RECHECK_BUDGET);
+}
+
+void Settings::setTorrentRecheckBudget(int megabytes)
+{
+    setSettingInt(REGISTRY_TORRENT_RECHECK_BUDGET, megabytes);
+}
+
 /******************************************************************************
  ******************************************************************************/
 // Tab Advanced
@@ -28,6 +28,12 @@ enum class ExistingFileOption{
     LastOption // for safe cast
 };
 
+enum class TorrentDiskIo{
+    Default = 0,    ///< Memory-mapped when available, POSIX otherwise
+    MemoryMapped,
+    Posix
+};
+
 enum class CheckUpdateBeatMode{
     Never = 0,
     OnceADay = 1,
@@ -141,6 +147,45 @@ public:
     int connectionTimeout() const;
     void setConnectionTimeout(int number);
 
+    int connectionsPerHost() const;
+    void setConnectionsPerHost(int number);
+
+    bool isHttp2Enabled() const;
+    void setHttp2Enabled(bool enabled);
+
+    bool isTlsSessionResumptionEnabled() const;
+    void setTlsSessionResumptionEnabled(bool enabled);
+
+    bool isRetryEnabled() const;
+    void setRetryEnabled(bool enabled);
+
+    int retryMaxAttempts() const;
+    void setRetryMaxAttempts(int number);
+
+    int retryBaseDelay() const;
+    void setRetryBaseDelay(int msecs);
+
+    int retryMaxDelay() const;
+    void setRetryMaxDelay(int secs);
+
+    bool isRetryOnTimeoutEnabled() const;
+    void setRetryOnTimeoutEnabled(bool enabled);
+
+    bool isRetryOnServerErrorEnabled() const;
+    void setRetryOnServerErrorEnabled(bool enabled);
+
+    bool isRetryOnTooManyRequestsEnabled() const;
+    void setRetryOnTooManyRequestsEnabled(bool enabled);
+
+    bool isRetryOnConnectionResetEnabled() const;
+    void setRetryOnConnectionResetEnabled(bool enabled);
+
+    int circuitBreakerThreshold() const;
+    void setCircuitBreakerThreshold(int failures);
+
+    int circuitBreakerCooldown() const;
+    void setCircuitBreakerCooldown(int secs);
+
     bool isRemoteCreationTimeEnabled() const;
     void setRemoteCreationTimeEnabled(bool enabled);
 
@@ -220,6 +265,30 @@ public:
     QMap<QString, QVariant> torrentSettings() const;
     void setTorrentSettings(const QMap<QString, QVariant> &map);
 
+    int torrentStatusInterval() const;
+    void setTorrentStatusInterval(int msecs);
+
+    int torrentSessionStatsInterval() const;
+    void setTorrentSessionStatsInterval(int msecs);
+
+    int torrentDhtStatsInterval() const;
+    void setTorrentDhtStatsInterval(int msecs);
+
+    int torrentResumeDataInterval() const;
+    void setTorrentResumeDataInterval(int msecs);
+
+    TorrentDiskIo torrentDiskIo() const;
+    void setTorrentDiskIo(TorrentDiskIo backend);
+
+    int maxSimultaneousTorrents() const;
+    void setMaxSimultaneousTorrents(int number);
+
+    int concurrentTorrentRechecks() const;
+    void setConcurrentTorrentRechecks(int number);
+
+    int torrentRecheckBudget() const;
+    void setTorrentRecheckBudget(int megabytes);
+
     // Tab Advanced
     CheckUpdateBeatMode checkUpdateBeatMode() const;
     void setCheckUpdateBeatMode(CheckUpdateBeatMode mode);
@@ -23,6 +23,9 @@
 #include <QtCore/QDebug>
 #include <QtCore/QtMath>
 #include <QtCore/QBitArray>
+
+#include <bit>     // std::countl_zero, std::countr_zero
+#include <utility> // std::exchange
 #ifdef QT_TESTLIB_LIB
 #  include <QtTest/QTest>
 #endif
@@ -134,6 +137,9 @@ TorrentHandleInfo Torrent::detail() const
 
 void Torrent::setDetail(const TorrentHandleInfo &detail, bool mustRefreshMetaInfo)
 {
+    if (!hasSamePriorities(m_detail.files, detail.files)) {
+        m_preferredFilePrioritiesDirty = true;
+    }
     m_detail = detail;
     if (mustRefreshMetaInfo) {
         m_fileModel->refreshMetaData(m_metaInfo.initialMetaInfo.files);
@@ -156,6 +162,21 @@ void Torrent::setError(TorrentError::Type errorType, const QString &message)
     m_metaInfo.error.message = message;
 }
 
+/******************************************************************************
+ ******************************************************************************/
+bool Torrent::hasSamePriorities(const QList<TorrentFileInfo> &a, const QList<TorrentFileInfo> &b)
+{
+    if (a.count() != b.count()) {
+        return false;
+    }
+    for (qsizetype i = 0; i < a.count(); ++i) {
+        if (a.at(i).priority != b.at(i).priority) {
+            return false;
+        }
+    }
+    return true;
+}
+
 /******************************************************************************
  ******************************************************************************/
 qsizetype Torrent::fileCount() const
@@ -167,7 +188,7 @@ qsizetype Torrent::fileCount() const
  ******************************************************************************/
 TorrentFileInfo::Priority Torrent::filePriority(int index) const
 {
-    if (index < 0 || index > m_detail.files.count()) {
+    if (index < 0 || index >= m_detail.files.count()) {
         return TorrentFileInfo::Normal;
     }
     return m_detail.files.at(index).priority;
@@ -175,50 +196,146 @@ TorrentFileInfo::Priority Torrent::filePriority(int index) const
 
 void Torrent::setFilePriority(int index, TorrentFileInfo::Priority priority)
 {
-    if (index < 0 || index > m_detail.files.count()) {
+    if (index < 0 || index >= m_detail.files.count()) {
         return;
     }
     m_detail.files[index].priority = priority;
+    m_preferredFilePrioritiesDirty = true;
     m_fileModel->refreshData(m_detail.files); // Synchronize
     emit changed();
 }
 
+/*!
+ * \brief Returns the file priorities, encoded as one character per file.
+ *
+ * \remark The string is cached, and rebuilt only when a priority changes,
+ * because it's requested at each update of the torrent.
+ */
 QString Torrent::preferredFilePriorities() const
 {
-    QString code;
-    for (auto fi = 0; fi < fileCount(); ++fi) {
-        auto priority = filePriority(fi);
-        switch (priority) {
-        case TorrentFileInfo::Ignore: code.append("-"); break;
-        case TorrentFileInfo::Low:    code.append("L"); break;
-        case TorrentFileInfo::Normal: code.append("N"); break;
-        case TorrentFileInfo::High:   code.append("H"); break;
+    if (m_preferredFilePrioritiesDirty) {
+        QString code;
+        code.reserve(m_detail.files.count());
+        for (const auto &fi : m_detail.files) {
+            switch (fi.priority) {
+            case TorrentFileInfo::Ignore: code.append(u'-'); break;
+            case TorrentFileInfo::Low:    code.append(u'L'); break;
+            case TorrentFileInfo::Normal: code.append(u'N'); break;
+            case TorrentFileInfo::High:   code.append(u'H'); break;
+            }
         }
+        m_preferredFilePriorities = code;
+        m_preferredFilePrioritiesDirty = false;
     }
-    return code;
+    return m_preferredFilePriorities;
 }
 
+/*!
+ * \brief Sets all the file priorities at once,
+ * and synchronizes the file model only once.
+ */
 void Torrent::setPreferredFilePriorities(const QString &priorities)
 {
-    bool hasChanged = false;
-    for (auto fi = 0; fi < fileCount(); ++fi) {
-        if (fi < priorities.length()) {
-            auto priority = TorrentFileInfo::Normal;
-            switch (priorities.at(fi).toLatin1()) {
-            case '-': priority = TorrentFileInfo::Ignore; break;
-            case 'L': priority = TorrentFileInfo::Low; break;
-            case 'N': priority = TorrentFileInfo::Normal; break;
-            case 'H': priority = TorrentFileInfo::High; break;
-            default: break;
-            }
-            QSignalBlocker blocker(this);
-            setFilePriority(fi, priority);
-            hasChanged = true;
+    auto count = qMin(fileCount(), priorities.length());
+    if (count <= 0) {
+        return;
+    }
+    for (auto fi = 0; fi < count; ++fi) {
+        auto priority = TorrentFileInfo::Normal;
+        switch (priorities.at(fi).toLatin1()) {
+        case '-': priority = TorrentFileInfo::Ignore; break;
+        case 'L': priority = TorrentFileInfo::Low; break;
+        case 'N': priority = TorrentFileInfo::Normal; break;
+        case 'H': priority = TorrentFileInfo::High; break;
+        default: break;
         }
+        m_detail.files[fi].priority = priority;
     }
-    if (hasChanged) {
-        emit changed();
+    m_preferredFilePrioritiesDirty = true;
+    m_fileModel->refreshData(m_detail.files); // Synchronize
+    emit changed();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \brief Returns true if the pieces are downloaded in order,
+ * so that the files can be played while being downloaded.
+ */
+bool Torrent::isStreaming() const
+{
+    return m_streaming;
+}
+
+void Torrent::setStreaming(bool streaming)
+{
+    m_streaming = streaming;
+}
+
+/*!
+ * \brief Returns true if the files are known to be complete,
+ * so the torrent is seeded at once, without checking the pieces.
+ */
+bool Torrent::isSeedMode() const
+{
+    return m_seedMode;
+}
+
+void Torrent::setSeedMode(bool seedMode)
+{
+    m_seedMode = seedMode;
+}
+
+/*!
+ * \brief Web seeds to add once the torrent is added to the session.
+ */
+QList<TorrentWebSeedMetaInfo> Torrent::pendingWebSeeds() const
+{
+    return m_pendingWebSeeds;
+}
+
+void Torrent::setPendingWebSeeds(const QList<TorrentWebSeedMetaInfo> &seeds)
+{
+    m_pendingWebSeeds = seeds;
+}
+
+/*!
+ * \brief Progress, throughput and ETA of the forced recheck, if any.
+ */
+TorrentRecheckInfo Torrent::recheckInfo() const
+{
+    return m_recheckInfo;
+}
+
+void Torrent::setRecheckInfo(const TorrentRecheckInfo &recheckInfo)
+{
+    m_recheckInfo = recheckInfo;
+}
+
+/*!
+ * \brief Returns the number of bytes of the file at \a fileIndex
+ * that are downloaded without gap from the given \a offset.
+ */
+qint64 Torrent::availableBytes(int fileIndex, qint64 offset) const
+{
+    const auto &meta = m_metaInfo.initialMetaInfo;
+    if (fileIndex < 0 || fileIndex >= meta.files.count() || meta.pieceByteSize <= 0) {
+        return 0;
     }
+    const auto &file = meta.files.at(fileIndex);
+    if (offset < 0 || offset >= file.bytesTotal) {
+        return 0;
+    }
+    const auto &pieces = m_info.downloadedPieces;
+    auto position = static_cast<qint64>(file.bytesOffset) + offset;
+    auto end = static_cast<qint64>(file.bytesOffset + file.bytesTotal);
+    auto piece = position / meta.pieceByteSize;
+    auto available = position;
+    while (available < end && piece < pieces.size() && pieces.testBit(piece)) {
+        ++piece;
+        available = qMin(piece * meta.pieceByteSize, end);
+    }
+    return available - position;
 }
 
 /******************************************************************************
@@ -552,14 +669,41 @@ void TorrentFileTableModel::refreshMetaData(const QList<TorrentFileMetaInfo> &fi
     endResetModel();
 }
 
+/*!
+ * \brief Updates the files, and notifies the rows that changed only.
+ *
+ * With large torrents (thousands of files), only a few files progress
+ * between two updates: the contiguous changed rows are grouped
+ * in a single dataChanged() signal.
+ */
 void TorrentFileTableModel::refreshData(const QList<TorrentFileInfo> &files)
 {
-    m_files = files;
+    auto previous = std::exchange(m_files, files);
     auto torrent = dynamic_cast<Torrent*>(parent());
     if (torrent) {
         m_downloadedPieces = torrent->info().downloadedPieces;
     }
-    emit dataChanged(index(0,0), index(rowCount(), columnCount()), {Qt::DisplayRole});
+    const auto rows = rowCount();
+    if (rows == 0) {
+        return;
+    }
+    const auto lastColumn = columnCount() - 1;
+    if (previous.count() != m_files.count()) {
+        emit dataChanged(index(0, 0), index(rows - 1, lastColumn), {Qt::DisplayRole});
+        return;
+    }
+    const auto count = qMin(static_cast<qsizetype>(rows), m_files.count());
+    qsizetype first = -1;
+    for (qsizetype i = 0; i <= count; ++i) {
+        auto changed = i < count && previous.at(i) != m_files.at(i);
+        if (changed && first < 0) {
+            first = i;
+        } else if (!changed && first >= 0) {
+            emit dataChanged(index(static_cast<int>(first), 0),
+                             index(static_cast<int>(i - 1), lastColumn), {Qt::DisplayRole});
+            first = -1;
+        }
+    }
 }
 
 /******************************************************************************
@@ -700,69 +844,160 @@ void TorrentPeerTableModel::removeUnconnectedPeers()
         }
     }
     m_peers = peers;
+    m_rows.clear();
+    for (auto i = 0; i < m_peers.count(); ++i) {
+        m_rows.insert(m_peers.at(i).endpoint, static_cast<int>(i));
+    }
     endResetModel();
 }
 
+/*!
+ * \brief Updates the peers in one pass.
+ *
+ * The peers are found by endpoint in a hash, instead of scanning the list.
+ * The changes are coalesced: one dataChanged() is emitted per range
+ * of consecutive changed rows, limited to the columns that changed.
+ */
 void TorrentPeerTableModel::refreshData(const QList<TorrentPeerInfo> &peers)
 {
     if (peers.isEmpty()) {
         return;
     }
-    m_connectedPeers.clear();
+    auto wasConnected = std::exchange(m_connectedPeers, {});
+    const quint32 allColumns = (1u << columnCount()) - 1;
+    QList<quint32> changes(m_peers.count(), 0);
     QList<TorrentPeerInfo> newItems;
 
-    for (auto newItem : peers) {
+    for (const auto &newItem : peers) {
+        if (m_connectedPeers.contains(newItem.endpoint)) {
+            continue; // duplicate
+        }
         m_connectedPeers.insert(newItem.endpoint);
-        bool replaced = false;
-        for (auto i = 0; i < m_peers.count(); ++i) {
-            auto item = m_peers.at(i);
 
-            // Try update
-            if (item.endpoint == newItem.endpoint) {
-                m_peers.replace(i, newItem);
-                auto row = static_cast<int>(i);
-                emit dataChanged(index(row, 0), index(row, columnCount()), {Qt::DisplayRole});
-                replaced = true;
-                break;
-            }
-        }
-        if (!replaced) {
+        auto it = m_rows.constFind(newItem.endpoint);
+        if (it == m_rows.constEnd()) {
             newItems.append(newItem);
+            continue;
+        }
+        auto row = it.value();
+        auto mask = changedColumns(m_peers.at(row), newItem);
+        if (!wasConnected.contains(newItem.endpoint)) {
+            mask = allColumns; // reconnected, see ConnectRole
+        }
+        if (mask) {
+            m_peers.replace(row, newItem);
+            changes[row] |= mask;
+        }
+    }
+    // Disconnected peers are repainted too, see ConnectRole
+    for (const auto &endpoint : std::as_const(wasConnected)) {
+        if (!m_connectedPeers.contains(endpoint)) {
+            auto row = m_rows.value(endpoint, -1);
+            if (row >= 0) {
+                changes[row] = allColumns;
+            }
         }
     }
     // Append remaining items
-    appendRemainingSafely(newItems);
+    appendRemainingSafely(newItems, changes);
+    emitDataChanged(changes);
 }
 
-void TorrentPeerTableModel::appendRemainingSafely(const QList<TorrentPeerInfo> &newItems)
+void TorrentPeerTableModel::appendRemainingSafely(const QList<TorrentPeerInfo> &newItems,
+                                                  QList<quint32> &changes)
 {
     if (newItems.isEmpty()) {
         return;
     }
-    int ptr = 0;
+    qsizetype ptr = 0;
     if (m_peers.count() < MAX_PEER_LIST_COUNT) {
         ptr = qMin(newItems.count(), MAX_PEER_LIST_COUNT - m_peers.count());
 
-        auto first = m_peers.count();
-        auto last = qMin(first + ptr - 1, MAX_PEER_LIST_COUNT - 1);
+        auto first = static_cast<int>(m_peers.count());
+        auto last = static_cast<int>(first + ptr - 1);
         beginInsertRows(QModelIndex(), first, last);
+        for (auto i = 0; i < ptr; ++i) {
+            m_rows.insert(newItems.at(i).endpoint, first + i);
+        }
         m_peers.append(newItems.mid(0, ptr));
         endInsertRows();
     }
-    if (ptr < newItems.count()) {
-        for (auto i = m_peers.count() - 1; i >= 0; --i) {
-            auto peer = m_peers.at(i);
-            if (m_connectedPeers.contains(peer.endpoint)) {
-                continue;
-            }
-            m_peers.replace(i, newItems.at(ptr));
-            auto row = static_cast<int>(i);
-            emit dataChanged(index(row, 0), index(row, columnCount()), {Qt::DisplayRole});
-            ptr++;
-            if (ptr >=newItems.count() ) {
-                break;
-            }
+    // Replace the unconnected peers, from the end of the list
+    const quint32 allColumns = (1u << columnCount()) - 1;
+    for (auto i = m_peers.count() - 1; i >= 0 && ptr < newItems.count(); --i) {
+        const auto &peer = m_peers.at(i);
+        if (m_connectedPeers.contains(peer.endpoint)) {
+            continue;
+        }
+        auto row = static_cast<int>(i);
+        m_rows.remove(peer.endpoint);
+        m_rows.insert(newItems.at(ptr).endpoint, row);
+        m_peers.replace(i, newItems.at(ptr));
+        if (i < changes.count()) {
+            changes[i] = allColumns;
+        }
+        ptr++;
+    }
+}
+
+/*!
+ * \brief Returns the mask of the columns whose value differs.
+ */
+quint32 TorrentPeerTableModel::changedColumns(const TorrentPeerInfo &before,
+                                              const TorrentPeerInfo &after)
+{
+    quint32 mask = 0;
+    if (before.endpoint != after.endpoint) {
+        mask |= (1u << 0) | (1u << 1);
+    }
+    if (before.userAgent != after.userAgent) {
+        mask |= 1u << 2;
+    }
+    if (before.bytesDownloaded != after.bytesDownloaded) {
+        mask |= 1u << 3;
+    }
+    if (before.bytesUploaded != after.bytesUploaded) {
+        mask |= 1u << 4;
+    }
+    if (before.availablePieces != after.availablePieces) {
+        mask |= 1u << 5;
+    }
+    if (before.lastTimeRequested != after.lastTimeRequested) {
+        mask |= 1u << 6;
+    }
+    if (before.lastTimeActive != after.lastTimeActive) {
+        mask |= 1u << 7;
+    }
+    if (before.timeDownloadQueue != after.timeDownloadQueue) {
+        mask |= 1u << 8;
+    }
+    if (before.flags != after.flags) {
+        mask |= 1u << 9;
+    }
+    if (before.sourceFlags != after.sourceFlags) {
+        mask |= 1u << 10;
+    }
+    return mask;
+}
+
+void TorrentPeerTableModel::emitDataChanged(const QList<quint32> &changes)
+{
+    qsizetype row = 0;
+    while (row < changes.count()) {
+        if (!changes.at(row)) {
+            ++row;
+            continue;
+        }
+        auto first = row;
+        quint32 mask = 0;
+        while (row < changes.count() && changes.at(row)) {
+            mask |= changes.at(row);
+            ++row;
         }
+        auto firstColumn = std::countr_zero(mask);
+        auto lastColumn = 31 - std::countl_zero(mask);
+        emit dataChanged(index(static_cast<int>(first), firstColumn),
+                         index(static_cast<int>(row - 1), lastColumn), {Qt::DisplayRole});
     }
 }
 
@@ -20,6 +20,7 @@
 #include <Core/TorrentMessage>
 
 #include <QtCore/QAbstractTableModel>
+#include <QtCore/QHash>
 #include <QtCore/QSet>
 #include <QtCore/QSortFilterProxyModel>
 
@@ -72,6 +73,20 @@ public:
     QString preferredFilePriorities() const;
     void setPreferredFilePriorities(const QString &priorities);
 
+    bool isStreaming() const;
+    void setStreaming(bool streaming);
+
+    bool isSeedMode() const;
+    void setSeedMode(bool seedMode);
+
+    QList<TorrentWebSeedMetaInfo> pendingWebSeeds() const;
+    void setPendingWebSeeds(const QList<TorrentWebSeedMetaInfo> &seeds);
+
+    TorrentRecheckInfo recheckInfo() const;
+    void setRecheckInfo(const TorrentRecheckInfo &recheckInfo);
+
+    qint64 availableBytes(int fileIndex, qint64 offset) const;
+
     void addPeer(const QString &input);
     void removeUnconnectedPeers();
 
@@ -99,9 +114,19 @@ private:
     TorrentInfo m_info = {};
     TorrentHandleInfo m_detail = {};
 
+    mutable QString m_preferredFilePriorities = {};
+    mutable bool m_preferredFilePrioritiesDirty = true;
+
+    bool m_streaming = false;
+    bool m_seedMode = false;
+    QList<TorrentWebSeedMetaInfo> m_pendingWebSeeds = {};
+    TorrentRecheckInfo m_recheckInfo = {};
+
     TorrentFileTableModel* m_fileModel = nullptr;
     TorrentPeerTableModel* m_peerModel = nullptr;
     TorrentTrackerTableModel* m_trackerModel = nullptr;
+
+    static bool hasSamePriorities(const QList<TorrentFileInfo> &a, const QList<TorrentFileInfo> &b);
 };
 
 /******************************************************************************
@@ -189,8 +214,12 @@ public:
 private:
     QList<TorrentPeerInfo> m_peers;
     QSet<EndPoint> m_connectedPeers;
+    QHash<EndPoint, int> m_rows; // row of the peer in m_peers
+
+    void appendRemainingSafely(const QList<TorrentPeerInfo> &peers, QList<quint32> &changes);
+    void emitDataChanged(const QList<quint32> &changes);
 
-    void appendRemainingSafely(const QList<TorrentPeerInfo> &peers);
+    static quint32 changedColumns(const TorrentPeerInfo &before, const TorrentPeerInfo &after);
 };
 
 /******************************************************************************
@@ -37,6 +37,41 @@ void TorrentBaseContext::setPriorityByFileOrder(Torrent *torrent, const QList<in
     }
 }
 
+/*!
+ * \brief Requests the full detail (files, peers, pieces...) of the given
+ * \a torrent at each status update, typically while a view displays it.
+ */
+void TorrentBaseContext::subscribe(Torrent *torrent)
+{
+    Q_UNUSED(torrent)
+}
+
+void TorrentBaseContext::unsubscribe(Torrent *torrent)
+{
+    Q_UNUSED(torrent)
+}
+
+/*!
+ * \brief Downloads the pieces of the given \a torrent in order,
+ * so that its files can be played while being downloaded.
+ */
+void TorrentBaseContext::setStreamingEnabled(Torrent *torrent, bool enabled)
+{
+    Q_ASSERT(torrent);
+    torrent->setStreaming(enabled);
+}
+
+/*!
+ * \brief Prioritizes the pieces of the file at \a fileIndex that follow
+ * the given \a offset, typically the read position of a media player.
+ */
+void TorrentBaseContext::setStreamingPosition(Torrent *torrent, int fileIndex, qint64 offset)
+{
+    Q_UNUSED(torrent)
+    Q_UNUSED(fileIndex)
+    Q_UNUSED(offset)
+}
+
 TorrentFileInfo::Priority TorrentBaseContext::computePriority(int row, qsizetype count)
 {
     if (count < 3) {
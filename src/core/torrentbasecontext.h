@@ -30,6 +30,12 @@ public:
     virtual void setPriority(Torrent *torrent, int index, TorrentFileInfo::Priority p);
     virtual void setPriorityByFileOrder(Torrent *torrent, const QList<int> &rows);
 
+    virtual void subscribe(Torrent *torrent);
+    virtual void unsubscribe(Torrent *torrent);
+
+    virtual void setStreamingEnabled(Torrent *torrent, bool enabled);
+    virtual void setStreamingPosition(Torrent *torrent, int fileIndex, qint64 offset);
+
     static TorrentFileInfo::Priority computePriority(int row, qsizetype count);
 };
 
@@ -89,6 +89,18 @@ void TorrentContext::setNetworkManager(NetworkManager *networkManager)
     d->networkManager = networkManager;
 }
 
+/*!
+ * \brief Creates and starts the session.
+ *
+ * The disk I/O backend and the session state (DHT node, IP filter)
+ * are given to the session constructor: call it once, with the
+ * stored preferences, before the torrents are used.
+ */
+void TorrentContext::init(TorrentDiskIo diskIo, const QString &sessionStateFileName)
+{
+    d->init(diskIo, sessionStateFileName);
+}
+
 /******************************************************************************
  ******************************************************************************/
 Settings* TorrentContext::settings() const
@@ -133,6 +145,21 @@ QList<TorrentSettingItem> TorrentContext::presetHighPerf() const
     return d->presetHighPerf();
 }
 
+QList<TorrentSettingItem> TorrentContext::presetNvme() const
+{
+    return d->presetNvme();
+}
+
+QList<TorrentSettingItem> TorrentContext::presetHddArray() const
+{
+    return d->presetHddArray();
+}
+
+QList<TorrentSettingItem> TorrentContext::presetLowRam() const
+{
+    return d->presetLowRam();
+}
+
 /******************************************************************************
  ******************************************************************************/
 bool TorrentContext::isEnabled() const
@@ -147,6 +174,29 @@ void TorrentContext::setEnabled(bool enabled)
     }
 }
 
+/*!
+ * \brief Receives also the debug and statistic alerts, that are logged.
+ * By default, only the alerts that the application consumes are posted.
+ */
+bool TorrentContext::isVerboseAlertsEnabled() const
+{
+    return d->isVerboseAlertsEnabled();
+}
+
+void TorrentContext::setVerboseAlertsEnabled(bool enabled)
+{
+    d->setVerboseAlertsEnabled(enabled);
+}
+
+/*!
+ * \brief Returns the time series of the session performance counters,
+ * sampled at each session stats interval.
+ */
+TorrentSessionStatsModel* TorrentContext::sessionStatsModel() const
+{
+    return d->sessionStatsModel;
+}
+
 /******************************************************************************
  ******************************************************************************/
 void TorrentContext::prepareTorrent(Torrent *torrent)
@@ -226,6 +276,21 @@ void TorrentContext::pauseTorrent(Torrent *torrent)
     }
 }
 
+/*!
+ * \brief Rechecks the files of the given \a torrent.
+ *
+ * The rechecks are queued, and the progress, throughput and ETA
+ * are given by Torrent::recheckInfo().
+ */
+void TorrentContext::forceRecheck(Torrent *torrent)
+{
+    try {
+        d->forceRecheck(torrent);
+    } catch (std::exception const& e) {
+        qWarning() << "Caught exception in " << Q_FUNC_INFO << ": " << QString::fromUtf8(e.what());
+    }
+}
+
 /******************************************************************************
  ******************************************************************************/
 void TorrentContext::setPriority(Torrent *torrent, int index, TorrentFileInfo::Priority p)
@@ -237,3 +302,44 @@ void TorrentContext::setPriority(Torrent *torrent, int index, TorrentFileInfo::P
         qWarning() << "Caught exception in " << Q_FUNC_INFO << ": " << QString::fromUtf8(e.what());
     }
 }
+
+/******************************************************************************
+ ******************************************************************************/
+void TorrentContext::subscribe(Torrent *torrent)
+{
+    try {
+        d->subscribe(torrent);
+    } catch (std::exception const& e) {
+        qWarning() << "Caught exception in " << Q_FUNC_INFO << ": " << QString::fromUtf8(e.what());
+    }
+}
+
+void TorrentContext::unsubscribe(Torrent *torrent)
+{
+    try {
+        d->unsubscribe(torrent);
+    } catch (std::exception const& e) {
+        qWarning() << "Caught exception in " << Q_FUNC_INFO << ": " << QString::fromUtf8(e.what());
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void TorrentContext::setStreamingEnabled(Torrent *torrent, bool enabled)
+{
+    try {
+        TorrentBaseContext::setStreamingEnabled(torrent, enabled);
+        d->setStreamingEnabled(torrent, enabled);
+    } catch (std::exception const& e) {
+        qWarning() << "Caught exception in " << Q_FUNC_INFO << ": " << QString::fromUtf8(e.what());
+    }
+}
+
+void TorrentContext::setStreamingPosition(Torrent *torrent, int fileIndex, qint64 offset)
+{
+    try {
+        d->setStreamingPosition(torrent, fileIndex, offset);
+    } catch (std::exception const& e) {
+        qWarning() << "Caught exception in " << Q_FUNC_INFO << ": " << QString::fromUtf8(e.what());
+    }
+}
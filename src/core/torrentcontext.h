@@ -27,6 +27,8 @@ class NetworkManager;
 class Settings;
 class Torrent;
 class TorrentContextPrivate;
+class TorrentSessionStatsModel;
+enum class TorrentDiskIo;
 
 struct TorrentSettingItem
 {
@@ -68,6 +70,8 @@ public:
 
     void setNetworkManager(NetworkManager *networkManager);
 
+    void init(TorrentDiskIo diskIo, const QString &sessionStateFileName);
+
     /* Settings */
     Settings* settings() const;
     void setSettings(Settings *settings);
@@ -76,11 +80,19 @@ public:
     QList<TorrentSettingItem> presetDefault() const;
     QList<TorrentSettingItem> presetMinCache() const;
     QList<TorrentSettingItem> presetHighPerf() const;
+    QList<TorrentSettingItem> presetNvme() const;
+    QList<TorrentSettingItem> presetHddArray() const;
+    QList<TorrentSettingItem> presetLowRam() const;
 
     /* Session */
     bool isEnabled() const;
     void setEnabled(bool enabled);
 
+    bool isVerboseAlertsEnabled() const;
+    void setVerboseAlertsEnabled(bool enabled);
+
+    TorrentSessionStatsModel* sessionStatsModel() const;
+
     /* Torrents */
     void prepareTorrent(Torrent *torrent);
     void stopPrepare(Torrent *torrent);
@@ -92,8 +104,16 @@ public:
     void resumeTorrent(Torrent *torrent);
     void pauseTorrent(Torrent *torrent);
 
+    void forceRecheck(Torrent *torrent);
+
     void setPriority(Torrent *torrent, int index, TorrentFileInfo::Priority p) override;
 
+    void subscribe(Torrent *torrent) override;
+    void unsubscribe(Torrent *torrent) override;
+
+    void setStreamingEnabled(Torrent *torrent, bool enabled) override;
+    void setStreamingPosition(Torrent *torrent, int fileIndex, qint64 offset) override;
+
 signals:
     void changed();
 
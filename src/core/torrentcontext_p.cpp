@@ -21,12 +21,18 @@
 #include <Core/ResourceItem>
 #include <Core/Settings>
 #include <Core/Torrent>
+#include <Core/TorrentSessionStatsModel>
 
 #include <QtCore/QDebug>
 #include <QtCore/QByteArray>
 #include <QtCore/QDir>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QPointer>
+#include <QtCore/QSaveFile>
+#include <QtCore/QThreadPool>
+#include <QtCore/QTimer>
 #include <QtCore/QUrl>
 #include <QtCore/QtMath>
 #include <QtCore/QVector>
@@ -36,6 +42,7 @@
 #include <chrono>
 #include <fstream>   // std::fstream
 #include <string>    // std::string
+#include <utility>   // std::exchange
 
 #include "libtorrent/add_torrent_params.hpp"
 #include "libtorrent/alert_types.hpp"
@@ -49,13 +56,19 @@
 #include "libtorrent/identify_client.hpp"
 #include "libtorrent/ip_filter.hpp"
 #include "libtorrent/magnet_uri.hpp"
+#include "libtorrent/mmap_disk_io.hpp"      // mmap_disk_io_constructor
 #include "libtorrent/operations.hpp"
 #include "libtorrent/peer_info.hpp"
+#include "libtorrent/posix_disk_io.hpp"     // posix_disk_io_constructor
+#include "libtorrent/read_resume_data.hpp"
 #include "libtorrent/session.hpp"
+#include "libtorrent/session_params.hpp"
+#include "libtorrent/session_stats.hpp"     // find_metric_idx
 #include "libtorrent/settings_pack.hpp"
 #include "libtorrent/string_view.hpp"
 #include "libtorrent/time.hpp"
 #include "libtorrent/torrent_info.hpp"
+#include "libtorrent/write_resume_data.hpp"
 
 #ifndef TORRENT_DISABLE_EXTENSIONS
 #   include <libtorrent/extensions/smart_ban.hpp>
@@ -78,31 +91,107 @@ static const lt::status_flags_t s_torrent_status_flags =
         | lt::torrent_handle::query_verified_pieces
         ;
 
+/*!
+ * \brief Returns the categories of the alerts consumed by the application.
+ *
+ * The verbose categories (logs, peers, blocks...) generate
+ * thousands of alerts per second on a busy swarm: they're enabled
+ * only when \a verbose is true, typically while a debug view is open.
+ */
+static lt::alert_category_t alertMask(bool verbose)
+{
+    if (verbose) {
+        return lt::alert_category::all;
+    }
+    return lt::alert_category::status
+            | lt::alert_category::error
+            | lt::alert_category::storage // resume data
+            | lt::alert_category::performance_warning;
+}
+
+/* State saved on exit, and restored at next start */
+static const lt::save_state_flags_t s_session_state_flags =
+        lt::session_handle::save_dht_state
+        | lt::session_handle::save_ip_filter
+        ;
+
 const std::chrono::milliseconds TIMEOUT_TERMINATING( 3000 );
-const std::chrono::milliseconds TIMEOUT_REFRESH( 500);
+const std::chrono::milliseconds TIMEOUT_IDLE( 2000 ); // max wait for an alert
+const std::chrono::milliseconds TIMEOUT_RESUME_DATA( 2000 ); // max wait for the resume data, on exit
+
+
+/*!
+ * \brief Returns the default settings of the application.
+ *
+ * They're libtorrent's defaults, except that the piece hashing
+ * (rechecks, and the pieces received) is spread over the cores.
+ * They're also the default values shown in the tab Advanced,
+ * so that a value chosen there is always stored, and applied.
+ */
+static lt::settings_pack defaultSettings()
+{
+    auto pack = lt::default_settings();
+    auto cores = qMax(1, QThread::idealThreadCount());
+    pack.set_int(lt::settings_pack::hashing_threads, qBound(1, cores / 2, 8));
+    return pack;
+}
 
+static lt::disk_io_constructor_type diskIoConstructor(TorrentDiskIo diskIo)
+{
+    switch (diskIo) {
+#if TORRENT_HAVE_MMAP || TORRENT_HAVE_MAP_VIEW_OF_FILE
+    case TorrentDiskIo::MemoryMapped:
+        return lt::mmap_disk_io_constructor;
+#endif
+    case TorrentDiskIo::Posix:
+        return lt::posix_disk_io_constructor;
+    case TorrentDiskIo::Default:
+    default:
+        return lt::default_disk_io_constructor;
+    }
+}
+
+static const char* diskIoName(TorrentDiskIo diskIo)
+{
+    switch (diskIo) {
+    case TorrentDiskIo::MemoryMapped: return "memory-mapped";
+    case TorrentDiskIo::Posix: return "posix";
+    case TorrentDiskIo::Default:
+    default:
+        return "default";
+    }
+}
 
 TorrentContextPrivate::TorrentContextPrivate(TorrentContext *qq)
     : QObject(qq)
     , q(qq)
     , workerThread(new WorkerThread(this))
+    , sessionStatsModel(new TorrentSessionStatsModel(this))
+    , m_preparePool(new QThreadPool(this))
 {
     qRegisterMetaType<TorrentData>("TorrentData");
     qRegisterMetaType<TorrentStatus>("TorrentStatus");
+    qRegisterMetaType<TorrentStatusBatch>("TorrentStatusBatch");
+    qRegisterMetaType<TorrentSessionStats>("TorrentSessionStats");
+    qRegisterMetaType<lt::torrent_handle>("lt::torrent_handle");
 
     connect(workerThread, &WorkerThread::metadataUpdated, this, &TorrentContextPrivate::onMetadataUpdated);
     connect(workerThread, &WorkerThread::dataUpdated, this, &TorrentContextPrivate::onDataUpdated);
     connect(workerThread, &WorkerThread::statusUpdated, this, &TorrentContextPrivate::onStatusUpdated);
+    connect(workerThread, &WorkerThread::torrentAdded, this, &TorrentContextPrivate::onHandleAdded);
+    connect(workerThread, &WorkerThread::torrentRemoved, this, &TorrentContextPrivate::onHandleRemoved);
+    connect(workerThread, &WorkerThread::torrentChecked, this, &TorrentContextPrivate::onTorrentChecked);
+    connect(workerThread, &WorkerThread::sessionStatsUpdated, this, &TorrentContextPrivate::onSessionStatsUpdated);
 
     connect(workerThread, &WorkerThread::stopped, this, &TorrentContextPrivate::onStopped);
     connect(workerThread, &QThread::finished, workerThread, &QObject::deleteLater);
-
-    workerThread->setEnabled(false);
-    workerThread->start();
 }
 
 TorrentContextPrivate::~TorrentContextPrivate()
 {
+    m_preparePool->clear();
+    m_preparePool->waitForDone();
+
     workerThread->stop();
     if (!workerThread->wait(TIMEOUT_TERMINATING.count())) {
         qDebug_1 << Q_FUNC_INFO << "Terminating...";
@@ -113,12 +202,31 @@ TorrentContextPrivate::~TorrentContextPrivate()
 
 /******************************************************************************
  ******************************************************************************/
-void TorrentContextPrivate::onSettingsChanged()
+/*!
+ * \brief Creates the session, with the given disk I/O backend and state file,
+ * and starts it paused: the settings enable it.
+ */
+void TorrentContextPrivate::init(TorrentDiskIo diskIo, const QString &sessionStateFileName)
 {
-    if (!settings) {
+    if (workerThread->isRunning() || workerThread->isFinished()) {
+        qDebug_1 << Q_FUNC_INFO << "session already started";
         return;
     }
-    lt::settings_pack pack = lt::default_settings(); /* = fromSettings(settings)*/
+    workerThread->createSession(diskIo, sessionStateFileName);
+    workerThread->setEnabled(false);
+    workerThread->start();
+
+    onSettingsChanged();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void TorrentContextPrivate::onSettingsChanged()
+{
+    if (!settings || !workerThread->isRunning()) {
+        return; // applied by init()
+    }
+    lt::settings_pack pack = defaultSettings(); /* = fromSettings(settings)*/
 
     auto map = settings->torrentSettings();
     QMapIterator<QString, QVariant> it(map);
@@ -152,10 +260,30 @@ void TorrentContextPrivate::onSettingsChanged()
         }
     }
 
+    /*
+     * Rechecks: owned by the recheck settings, not by the tab Advanced.
+     * The disk reads in flight (checking_mem_usage, in blocks of 16 KiB)
+     * are shared by the concurrent rechecks.
+     */
+    auto budgetBlocks = qMax(1, settings->torrentRecheckBudget()) * 64;
+    m_maxConcurrentRechecks = qMax(1, settings->concurrentTorrentRechecks());
+    pack.set_int(lt::settings_pack::active_checking, m_maxConcurrentRechecks); // the seeds are auto-managed
+    pack.set_int(lt::settings_pack::checking_mem_usage, qMax(1, budgetBlocks / m_maxConcurrentRechecks));
+
     workerThread->setSettings(pack);
+    workerThread->setIntervals(settings->torrentStatusInterval(),
+                               settings->torrentSessionStatsInterval(),
+                               settings->torrentDhtStatsInterval());
+    workerThread->setResumeDataInterval(settings->torrentResumeDataInterval());
+
+    // The fast-resume data is stored next to the session (queue) file
+    auto sessionPath = QFileInfo(settings->database()).absolutePath();
+    workerThread->setResumeDataPath(QDir(sessionPath).filePath(u"resume"_s));
 
     auto enabled = settings->isTorrentEnabled();
     workerThread->setEnabled(enabled);
+
+    startNextRechecks();
 }
 
 /******************************************************************************
@@ -165,12 +293,12 @@ void TorrentContextPrivate::onSettingsChanged()
  */
 QList<TorrentSettingItem> TorrentContextPrivate::allSettingsKeysAndValues() const
 {
-    return _toPreset( lt::default_settings() );
+    return _toPreset( defaultSettings() );
 }
 
 QList<TorrentSettingItem> TorrentContextPrivate::presetDefault() const
 {
-    return _toPreset( lt::default_settings() );
+    return _toPreset( defaultSettings() );
 }
 
 QList<TorrentSettingItem> TorrentContextPrivate::presetMinCache() const
@@ -183,6 +311,60 @@ QList<TorrentSettingItem> TorrentContextPrivate::presetHighPerf() const
     return _toPreset( lt::high_performance_seed() );
 }
 
+/*!
+ * \brief Settings for solid-state drives with deep queues (NVMe).
+ *
+ * Many concurrent disk jobs and a large write queue keep the drive busy,
+ * and the piece hashing is spread over the cores.
+ */
+QList<TorrentSettingItem> TorrentContextPrivate::presetNvme() const
+{
+    auto pack = defaultSettings();
+    auto cores = qMax(1, QThread::idealThreadCount());
+    pack.set_int(lt::settings_pack::aio_threads, qBound(8, 2 * cores, 32));
+    pack.set_int(lt::settings_pack::hashing_threads, qBound(2, cores / 2, 8));
+    pack.set_int(lt::settings_pack::max_queued_disk_bytes, 8 * 1024 * 1024);
+    pack.set_int(lt::settings_pack::send_buffer_watermark, 3 * 1024 * 1024);
+    pack.set_int(lt::settings_pack::send_buffer_watermark_factor, 150);
+    pack.set_int(lt::settings_pack::file_pool_size, 500);
+    return _toPreset( pack );
+}
+
+/*!
+ * \brief Settings for rotating disks, alone or in an array (RAID, NAS).
+ *
+ * Few concurrent disk jobs limit the seeks, while a large write queue
+ * lets the disk backend coalesce the blocks into longer writes.
+ */
+QList<TorrentSettingItem> TorrentContextPrivate::presetHddArray() const
+{
+    auto pack = defaultSettings();
+    pack.set_int(lt::settings_pack::aio_threads, 4);
+    pack.set_int(lt::settings_pack::hashing_threads, 2);
+    pack.set_int(lt::settings_pack::max_queued_disk_bytes, 16 * 1024 * 1024);
+    pack.set_int(lt::settings_pack::send_buffer_watermark, 1024 * 1024);
+    pack.set_int(lt::settings_pack::file_pool_size, 100);
+    return _toPreset( pack );
+}
+
+/*!
+ * \brief Settings for desktop machines with little memory.
+ *
+ * Less aggressive than min_memory_usage(), that targets embedded devices:
+ * the buffers are reduced but the transfer rates remain usable.
+ */
+QList<TorrentSettingItem> TorrentContextPrivate::presetLowRam() const
+{
+    auto pack = defaultSettings();
+    pack.set_int(lt::settings_pack::aio_threads, 2);
+    pack.set_int(lt::settings_pack::hashing_threads, 1);
+    pack.set_int(lt::settings_pack::max_queued_disk_bytes, 256 * 1024);
+    pack.set_int(lt::settings_pack::send_buffer_watermark, 128 * 1024);
+    pack.set_int(lt::settings_pack::file_pool_size, 20);
+    pack.set_int(lt::settings_pack::max_peer_recv_buffer_size, 512 * 1024);
+    return _toPreset( pack );
+}
+
 /******************************************************************************
  ******************************************************************************/
 QList<TorrentSettingItem> TorrentContextPrivate::_toPreset(const lt::settings_pack all) const
@@ -217,6 +399,8 @@ QList<TorrentSettingItem> TorrentContextPrivate::_toPreset(const lt::settings_pa
             switch (index) {
             case lt::settings_pack::user_agent:
             case lt::settings_pack::alert_mask:
+            case lt::settings_pack::active_checking:    // Rechecks
+            case lt::settings_pack::checking_mem_usage: // Rechecks
                 continue;
             default:
                 break;
@@ -275,63 +459,63 @@ void TorrentContextPrivate::onMetadataUpdated(TorrentData data)
         torrent->setDetail(data.detail, true);
         torrent->setMetaInfo(data.metaInfo); // setMetaInfo will emit the GUI update signal
 
-        auto handle = workerThread->findTorrent(data.unique_id);
-        if (handle.is_valid()) {
+        auto handle = find(torrent);
+        if (!handle.is_valid()) {
+            return;
+        }
+        auto torrentFile = torrent->localFullFileName();  // destination
+        ensureDestinationPathExists(torrent);
+
+        /*
+         * Getting the metadata from the network thread, bencoding it
+         * and parsing it back take seconds for torrents with many files:
+         * it's done in the thread pool. The torrent is updated afterwards,
+         * see onTorrentFileSaved().
+         */
+        QPointer<Torrent> guard(torrent);
+        m_preparePool->start([this, guard, handle, torrentFile]() {
             auto ti = handle.torrent_file();
-
+            if (!ti) {
+                return;
+            }
+            std::shared_ptr<lt::torrent_info const> saved;
             try {
+                saved = writeTorrentFileFromMagnet(torrentFile, ti);
+
+            } catch (const std::exception &exception) {
                 /*
-                 * Try to save the torrent file on disk.
-                 *
-                 * Note:
                  * Torrent files in BitTorrent v2 throw exception
                  * because Bencode cannot write a file with missing piece hashes.
                  */
-
-                if (ti) {
-                    auto torrentFile = torrent->localFullFileName();  // destination
-                    ensureDestinationPathExists(torrent);
-
-                    writeTorrentFileFromMagnet(torrentFile, ti);
-
-                    /*
-                     * The .torrent file is immediately loaded after being written,
-                     * so that the program ensures the file is correctly written
-                     * (compliant with the bittorrent format specification).
-                     */
-                    readTorrentFile(torrentFile, torrent);
-                }
-                /*
-                 * `removeTorrent` aborts the torrent download,
-                 * but contrary to the name, it keeps the file on disk.
-                 *
-                 * This is temporarly disabled.
-                 */
-                // removeTorrent(torrent);
-
-            } catch (const std::exception &exception) {
-
                 qWarning() << "Caught exception" << QString::fromUtf8(exception.what());
+            }
+            /*
+             * Safe mode: the .torrent file is not saved on disk,
+             * the metadata received from the swarm is used as is.
+             */
+            auto initialMetaInfo = TorrentUtils::toTorrentInitialMetaInfo(saved ? saved : ti);
 
-                /*
-                 * Safe mode: .torrent file is not saved on disk.
-                 */
-                if (ti) {
-                    auto metaInfo = torrent->metaInfo();
+            QMetaObject::invokeMethod(this, [this, guard, initialMetaInfo]() {
+                onTorrentFileSaved(guard, initialMetaInfo);
+            }, Qt::QueuedConnection);
+        });
+    }
+}
 
-                    TorrentInitialMetaInfo initialMetaInfo = TorrentUtils::toTorrentInitialMetaInfo(ti);
-                    metaInfo.initialMetaInfo = initialMetaInfo;
+void TorrentContextPrivate::onTorrentFileSaved(Torrent *torrent, const TorrentInitialMetaInfo &initialMetaInfo)
+{
+    if (!torrent) {
+        return; // destroyed meanwhile
+    }
+    auto info = torrent->info();
+    info.state = TorrentInfo::stopped;
+    torrent->setInfo(info, true);
 
-                    auto info = torrent->info();
-                    info.state = TorrentInfo::stopped;
-                    torrent->setInfo(info, true);
-                    torrent->setMetaInfo(metaInfo); // setMetaInfo will emit the GUI update signal
+    auto metaInfo = torrent->metaInfo();
+    metaInfo.initialMetaInfo = initialMetaInfo;
+    torrent->setMetaInfo(metaInfo); // setMetaInfo will emit the GUI update signal
 
-                    resetPriorities(torrent);
-                }
-            }
-        }
-    }
+    resetPriorities(torrent);
 }
 
 /******************************************************************************
@@ -340,24 +524,105 @@ void TorrentContextPrivate::onDataUpdated(TorrentData data)
 {
     qDebug_1 << Q_FUNC_INFO;
     auto torrent = find(data.unique_id);
-    if (torrent) {
-        torrent->setDetail(data.detail, true);
-        torrent->setMetaInfo(data.metaInfo); // setMetaInfo will emit the GUI update signal
+    if (!torrent) {
+        // Removed while it was being added
+        auto handle = handleMap.take(data.unique_id);
+        if (handle.is_valid()) {
+            workerThread->removeTorrent(handle);
+        }
+        return;
+    }
+    auto resumeRequested = pendingTorrents.take(torrent);
+    if (data.metaInfo.error.type == TorrentError::FailedToAddError) {
+        unbind(torrent);
+        failTorrent(torrent, data.metaInfo.error.message);
+        return;
+    }
+    torrent->setDetail(data.detail, true);
+    torrent->setMetaInfo(data.metaInfo); // setMetaInfo will emit the GUI update signal
+    if (resumeRequested) {
+        resumeTorrent(torrent);
     }
 }
 
 /******************************************************************************
  ******************************************************************************/
-void TorrentContextPrivate::onStatusUpdated(TorrentStatus status)
+/*!
+ * \brief Applies the statuses of a tick.
+ *
+ * The batch contains the changed torrents only, and each status
+ * tells what changed: the unchanged parts are not applied.
+ */
+void TorrentContextPrivate::onStatusUpdated(TorrentStatusBatch batch)
 {
-    qDebug_1 << Q_FUNC_INFO;
-    auto torrent = find(status.unique_id);
-    if (torrent) {
-        torrent->setInfo(status.info, false);
-        torrent->setDetail(status.detail, false);
+    qDebug_1 << Q_FUNC_INFO << batch.count();
+    for (const auto &status : std::as_const(batch)) {
+        auto torrent = find(status.unique_id);
+        if (!torrent) {
+            continue;
+        }
+        if (status.changes & (TorrentStatus::InfoChanged | TorrentStatus::PiecesChanged)) {
+            torrent->setInfo(status.info, false);
+        }
+        auto recheck = m_rechecks.constFind(torrent);
+        if (recheck != m_rechecks.constEnd()) {
+            if (status.info.error.type != TorrentError::NoError || status.info.isPaused) {
+                finishRecheck(torrent); // the paused torrent resumes its check later
+            } else if (status.info.state == TorrentInfo::checking_files) {
+                auto info = torrent->recheckInfo();
+                info.update(status.info.percent, recheck->elapsed());
+                torrent->setRecheckInfo(info);
+            }
+        }
+        if (status.changes & TorrentStatus::DetailChanged) {
+            torrent->setDetail(status.detail, false); // setDetail() notifies
+        } else {
+            emit torrent->changed(); // setInfo() doesn't notify
+        }
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \brief Caches the handle of the torrent, once it's added to the session.
+ *
+ * The control operations (pause, resume, priorities...) then use
+ * the cached handle, instead of looking it up in the session.
+ */
+void TorrentContextPrivate::onHandleAdded(UniqueId uuid, lt::torrent_handle handle)
+{
+    handleMap.insert(uuid, handle);
+
+    auto torrent = find(uuid);
+    if (torrent && !torrent->pendingWebSeeds().isEmpty()) {
+        for (const auto &seed : torrent->pendingWebSeeds()) {
+            addSeed(torrent, seed);
+        }
+        torrent->setPendingWebSeeds({});
+    }
+}
+
+void TorrentContextPrivate::onHandleRemoved(UniqueId uuid)
+{
+    handleMap.remove(uuid);
+}
+
+void TorrentContextPrivate::onTorrentChecked(UniqueId uuid)
+{
+    auto torrent = find(uuid);
+    if (torrent && m_rechecks.contains(torrent)) {
+        finishRecheck(torrent);
     }
 }
 
+/******************************************************************************
+ ******************************************************************************/
+void TorrentContextPrivate::onSessionStatsUpdated(TorrentSessionStats stats)
+{
+    sessionStatsModel->append(stats);
+}
+
 /******************************************************************************
  ******************************************************************************/
 void TorrentContextPrivate::ensureDestinationPathExists(Torrent *torrent)
@@ -621,36 +886,48 @@ void TorrentContextPrivate::writeTorrentFile(const QString &filename, QIODevice
     }
 }
 
-void TorrentContextPrivate::writeTorrentFileFromMagnet(const QString &filename, std::shared_ptr<lt::torrent_info const> ti)
+/*!
+ * \brief Writes the .torrent file of the metadata received from the swarm.
+ *
+ * The encoded file is parsed back in memory, to ensure that it's compliant
+ * with the bittorrent format specification, before being written.
+ * Returns the parsed metadata, or nullptr if the file is not valid.
+ *
+ * Thread-safe: called from the thread pool.
+ *
+ * \remark Throws an exception for the torrents in v2-mode that miss
+ * piece layers, i.e. when the metadata comes from a magnet link.
+ */
+std::shared_ptr<lt::torrent_info const> TorrentContextPrivate::writeTorrentFileFromMagnet(
+        const QString &filename, std::shared_ptr<lt::torrent_info const> ti)
 {
     /*
-     * BUGFIX Libtorrent v2.0.9
-     * This method is temporarly deprecated
-     * due to bug with generate() when writing v2-mode torrents to disk.
+     * Bittorrent Encoding
+     * Unlike create_torrent::generate(), write_torrent_file_buf() keeps
+     * the piece layers of the v2 torrents. The metadata is only read.
      */
-    return;
-
-    archiveExistingFile(filename);
-
-    // Bittorrent Encoding
-    lt::create_torrent ct(*ti);
+    lt::add_torrent_params atp;
+    atp.ti = std::const_pointer_cast<lt::torrent_info>(ti);
+    auto buffer = lt::write_torrent_file_buf(atp, {}); // this method throws exception
 
-    // BUG
-    // Torrent in v2-mode are currently not supported,
-    // because the mode doesn't generate piece hash.
-    /// \todo add piece layers manually before generate() it
-    auto entry = ct.generate(); // this method throws exception
-
-    std::vector<char> buffer;
-    lt::bencode(std::back_inserter(buffer), entry);
+    // Validate
+    lt::error_code ec;
+    auto parsed = std::make_shared<lt::torrent_info const>(
+                lt::span<char const>(buffer), ec, lt::from_span);
+    if (ec) {
+        qWarning() << "Invalid torrent file" << filename << ":" << QString::fromStdString(ec.message());
+        return nullptr;
+    }
 
     // Write
-    QByteArray data(&buffer[0], static_cast<int>(buffer.size()));
-    QFile file(filename);
-    if (file.open(QIODevice::WriteOnly)) {
-        file.write(data);
-        file.close();
+    archiveExistingFile(filename);
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)
+            || file.write(buffer.data(), static_cast<qint64>(buffer.size())) != static_cast<qint64>(buffer.size())
+            || !file.commit()) {
+        qWarning() << "Can't write torrent file" << filename << ":" << file.errorString();
     }
+    return parsed;
 }
 
 /******************************************************************************
@@ -702,6 +979,9 @@ void TorrentContextPrivate::resetPriorities(Torrent *torrent)
 bool TorrentContextPrivate::hasTorrent(Torrent *torrent)
 {
     qDebug_1 << Q_FUNC_INFO;
+    if (pendingTorrents.contains(torrent)) {
+        return true;
+    }
     auto handle = find(torrent);
     return handle.is_valid();
 }
@@ -713,6 +993,9 @@ bool TorrentContextPrivate::hasTorrent(Torrent *torrent)
  */
 bool TorrentContextPrivate::addTorrent(Torrent *torrent) // resumeTorrent
 {
+    if (pendingTorrents.contains(torrent)) {
+        return true; // already being added
+    }
     auto info = torrent->info();
     info.state = TorrentInfo::checking_files;
     torrent->setInfo(info, false);
@@ -727,7 +1010,6 @@ bool TorrentContextPrivate::addTorrent(Torrent *torrent) // resumeTorrent
     qDebug_1 << Q_FUNC_INFO << source;
 
     ensureDestinationPathExists(torrent);
-    auto outputPath = torrent->localFilePath();
 
     lt::add_torrent_params p;
 
@@ -736,56 +1018,16 @@ bool TorrentContextPrivate::addTorrent(Torrent *torrent) // resumeTorrent
         info.state = TorrentInfo::downloading_metadata;
         torrent->setInfo(info, false);
 
-        auto bytes = source.toLatin1();
-        // QByteArray bytes = source.toUtf8();
-
-        auto ptr = bytes.constData();
-        auto size = static_cast<boost::string_view::size_type>(bytes.size());
-
-        lt::string_view uri { ptr, size };
         lt::error_code ec;
-        p = lt::parse_magnet_uri(uri.to_string(), ec);
+        p = TorrentUtils::fromMagnetUri(source, ec);
         if (ec) {
             qDebug_1 << "invalid magnet link:";
-            qDebug_1 << QString::fromStdString(uri.to_string());
+            qDebug_1 << source;
             qDebug_1 << QString::fromStdString(ec.message());
             return false;
         }
 
-        // https://www.libtorrent.org/manual-ref.html#magnet-links
-        p.file_priorities.clear();
-        // First 1,000,000 files in the torrent will not be downloaded
-        p.file_priorities.assign(1000000, lt::dont_download);
-
     } else {
-        if (isTorrentSource(source)) { // Add from .torrent file
-            auto torrent = source.toStdString();
-            lt::error_code ec;
-            auto ti = std::make_shared<lt::torrent_info>(torrent, ec);
-            if (ec) {
-                qDebug_1 << "failed to load torrent";
-                qDebug_1 << QString::fromStdString(torrent);
-                qDebug_1 << QString::fromStdString(ec.message());
-                return false;
-            }
-            p.ti = ti;
-
-        } else {
-
-            // Add from the info-hash of the torrent
-            //
-            // set this to the info hash of the torrent to add in case the info-hash
-            // is the only known property of the torrent. i.e. you don't have a
-            // .torrent file nor a magnet link.
-
-            auto s = source.toLocal8Bit().data();
-            lt::sha1_hash h1(s);
-            lt::info_hash_t infohashes(h1);
-            lt::add_torrent_params p;
-            p.info_hashes = infohashes;
-        }
-
-        p.file_priorities.clear();
         for (auto fi = 0; fi < torrent->fileCount(); ++fi) {
             auto priority = TorrentUtils::fromPriority(torrent->filePriority(fi));
             p.file_priorities.push_back(priority);
@@ -793,28 +1035,106 @@ bool TorrentContextPrivate::addTorrent(Torrent *torrent) // resumeTorrent
     }
 
     p.flags &= ~lt::torrent_flags::duplicate_is_error; // do not raise exception if duplicate
+    TorrentUtils::setQueueFlags(p);
+    if (torrent->isStreaming()) {
+        p.flags |= lt::torrent_flags::sequential_download;
+    }
+    if (torrent->isSeedMode()) {
+        p.flags |= lt::torrent_flags::seed_mode; // don't check the pieces
+    }
+
+    p.save_path = torrent->localFilePath().toStdString();
+
+    /*
+     * Parsing the .torrent file and reading the resume data can take
+     * a while for big torrents, or for thousands of them: it's done
+     * in the thread pool. The torrent is added to the session afterwards,
+     * see onTorrentPrepared().
+     */
+    pendingTorrents.insert(torrent, false);
+
+    QPointer<Torrent> guard(torrent);
+    auto isMagnet = isMagnetSource(source);
+    auto worker = workerThread;
+    m_preparePool->start([this, guard, p, source, isMagnet, worker]() mutable {
+        QString error;
+        if (!isMagnet) {
+            if (isTorrentSource(source)) { // Add from .torrent file
+                auto path = source.toStdString();
+                lt::error_code ec;
+                auto ti = std::make_shared<lt::torrent_info>(path, ec);
+                if (ec) {
+                    error = QString::fromStdString(ec.message());
+                } else {
+                    p.ti = ti;
+                }
+
+            } else {
 
-    p.save_path = outputPath.toStdString();
+                // Add from the info-hash of the torrent
+                //
+                // set this to the info hash of the torrent to add in case the info-hash
+                // is the only known property of the torrent. i.e. you don't have a
+                // .torrent file nor a magnet link.
+
+                auto s = source.toLocal8Bit();
+                lt::sha1_hash h1(s.constData());
+                p.info_hashes = lt::info_hash_t(h1);
+            }
+        }
+        if (error.isEmpty() && worker->readResumeData(p)) {
+            qDebug_2 << "fast-resume data loaded";
+        }
+        QMetaObject::invokeMethod(this, [this, guard, p, error]() mutable {
+            onTorrentPrepared(guard, std::move(p), error);
+        }, Qt::QueuedConnection);
+    });
+    return true;
+}
 
-    // Blocking insertion
-    lt::error_code ec2;
-    auto handle = workerThread->addTorrent(std::move(p), ec2);
-    if (ec2) {
+/*!
+ * \brief Binds the prepared torrent to its info-hash, and queues its insertion.
+ */
+void TorrentContextPrivate::onTorrentPrepared(Torrent *torrent, lt::add_torrent_params p, const QString &error)
+{
+    if (!torrent || !pendingTorrents.contains(torrent)) {
+        return; // deleted or removed meanwhile
+    }
+    if (!error.isEmpty()) {
         qDebug_1 << "failed to load torrent";
-        qDebug_1 << QString::fromStdString(source.toStdString());
-        qDebug_1 << QString::fromStdString(ec2.message());
-        return false;
+        qDebug_1 << error;
+        pendingTorrents.remove(torrent);
+        failTorrent(torrent, error);
+        return;
     }
 
-    if (!handle.is_valid()) {
-        return false;
+    auto hash = p.ti ? p.ti->info_hash() : p.info_hashes.v1;
+    auto uuid = TorrentUtils::toUniqueId(hash);
+    bind(uuid, torrent);
+    if (subscribers.contains(torrent)) {
+        workerThread->subscribe(uuid);
     }
 
-    handle.pause();
+    /*
+     * The insertions are batched: all the torrents prepared during
+     * the same event loop iteration are sent to the session at once.
+     */
+    if (m_addQueue.empty()) {
+        QTimer::singleShot(0, this, [this]() {
+            workerThread->asyncAddTorrents(std::exchange(m_addQueue, {}));
+        });
+    }
+    m_addQueue.push_back(std::move(p));
+}
 
-    auto uuid = TorrentUtils::toUniqueId(handle.info_hash());
-    hashMap.insert(uuid, torrent);
-    return true;
+void TorrentContextPrivate::failTorrent(Torrent *torrent, const QString &message)
+{
+    auto info = torrent->info();
+    info.state = TorrentInfo::stopped;
+    info.error = TorrentError(TorrentError::FailedToAddError);
+    info.error.message = message;
+    torrent->setInfo(info, false);
+    emit torrent->changed(); // setInfo() doesn't notify
 }
 
 /******************************************************************************
@@ -824,11 +1144,24 @@ void TorrentContextPrivate::removeTorrent(Torrent *torrent)
     /// \todo rename method?
 
     qDebug_1 << Q_FUNC_INFO;
+    auto uuid = uniqueId(torrent);
+    if (pendingTorrents.remove(torrent)) {
+        // Not in the session yet: removed when added, see onDataUpdated()
+        if (!uuid.isEmpty()) {
+            workerThread->unsubscribe(uuid);
+            unbind(torrent);
+        }
+        return;
+    }
+    cancelRecheck(torrent);
     auto handle = find(torrent);
     if (handle.is_valid()) {
         workerThread->removeTorrent(handle); // needs calling lt::session
-        auto uuid = TorrentUtils::toUniqueId(handle.info_hash());
-        hashMap.remove(uuid);
+    }
+    if (!uuid.isEmpty()) {
+        workerThread->unsubscribe(uuid);
+        handleMap.remove(uuid);
+        unbind(torrent);
     }
 }
 
@@ -837,8 +1170,13 @@ void TorrentContextPrivate::removeTorrent(Torrent *torrent)
 void TorrentContextPrivate::resumeTorrent(Torrent *torrent)
 {
     qDebug_1 << Q_FUNC_INFO;
+    if (pendingTorrents.contains(torrent)) {
+        pendingTorrents.insert(torrent, true); // resumed once added
+        return;
+    }
     auto handle = find(torrent);
     if (handle.is_valid()) {
+        handle.unset_flags(lt::torrent_flags::upload_mode); // see fromMagnetUri()
         handle.resume();
     }
 }
@@ -846,6 +1184,10 @@ void TorrentContextPrivate::resumeTorrent(Torrent *torrent)
 void TorrentContextPrivate::pauseTorrent(Torrent *torrent)
 {
     qDebug_1 << Q_FUNC_INFO;
+    if (pendingTorrents.contains(torrent)) {
+        pendingTorrents.insert(torrent, false);
+        return;
+    }
     auto handle = find(torrent);
     if (handle.is_valid()) {
         handle.pause();
@@ -987,12 +1329,80 @@ void TorrentContextPrivate::removeTracker(Torrent *torrent,
 
 /******************************************************************************
  ******************************************************************************/
+/*!
+ * \brief Queues the recheck of the files of the given \a torrent.
+ *
+ * At most 'concurrentTorrentRechecks' torrents are checked at the same time,
+ * so that a bulk recheck (e.g. after moving the storage) doesn't saturate
+ * the disk at the expense of the active downloads.
+ *
+ * A paused torrent is checked once resumed: it doesn't wait for a slot.
+ */
 void TorrentContextPrivate::forceRecheck(Torrent *torrent)
 {
     qDebug_1 << Q_FUNC_INFO;
+    if (m_rechecks.contains(torrent) || m_recheckQueue.contains(torrent)) {
+        return;
+    }
+    auto handle = find(torrent);
+    if (!handle.is_valid()) {
+        return;
+    }
+    if (torrent->info().isPaused) {
+        handle.force_recheck();
+        return;
+    }
+    TorrentRecheckInfo info;
+    info.state = TorrentRecheckInfo::Queued;
+    info.bytesTotal = torrent->metaInfo().initialMetaInfo.bytesTotal;
+    torrent->setRecheckInfo(info);
+    m_recheckQueue.append(torrent);
+    startNextRechecks();
+    emit torrent->changed();
+}
+
+void TorrentContextPrivate::startNextRechecks()
+{
+    while (!m_recheckQueue.isEmpty() && m_rechecks.count() < m_maxConcurrentRechecks) {
+        startRecheck(m_recheckQueue.takeFirst());
+    }
+}
+
+void TorrentContextPrivate::startRecheck(Torrent *torrent)
+{
+    auto info = torrent->recheckInfo();
     auto handle = find(torrent);
     if (handle.is_valid()) {
+        QElapsedTimer timer;
+        timer.start();
+        m_rechecks.insert(torrent, timer);
+        info.state = TorrentRecheckInfo::Checking;
         handle.force_recheck();
+    } else {
+        info = {};
+    }
+    torrent->setRecheckInfo(info);
+    emit torrent->changed();
+}
+
+/*!
+ * \brief Releases the slot of the recheck, and starts the next ones.
+ */
+void TorrentContextPrivate::finishRecheck(Torrent *torrent)
+{
+    auto timer = m_rechecks.take(torrent);
+    auto info = torrent->recheckInfo();
+    qDebug_1 << Q_FUNC_INFO << info.bytesTotal << "bytes in" << timer.elapsed() << "msec";
+    torrent->setRecheckInfo({});
+    emit torrent->changed();
+    startNextRechecks();
+}
+
+void TorrentContextPrivate::cancelRecheck(Torrent *torrent)
+{
+    m_recheckQueue.removeAll(torrent);
+    if (m_rechecks.remove(torrent)) {
+        startNextRechecks();
     }
 }
 
@@ -1089,25 +1499,158 @@ void TorrentContextPrivate::renameFile(Torrent *torrent, int index, const QStrin
 
 /******************************************************************************
  ******************************************************************************/
-inline Torrent* TorrentContextPrivate::find(const UniqueId &uuid)
+void TorrentContextPrivate::subscribe(Torrent *torrent)
 {
-    qDebug_1 << Q_FUNC_INFO;
-    return hashMap.value(uuid, nullptr);
+    subscribers.insert(torrent);
+    auto uuid = uniqueId(torrent);
+    if (!uuid.isEmpty()) {
+        workerThread->subscribe(uuid);
+    }
 }
 
-inline lt::torrent_handle TorrentContextPrivate::find(Torrent *torrent)
+void TorrentContextPrivate::unsubscribe(Torrent *torrent)
 {
-    qDebug_1 << Q_FUNC_INFO;
-    auto info_hash = hashMap.key(torrent, UniqueId());
-    return workerThread->findTorrent(info_hash);
-    //    return hashMap.key(item, lt::torrent_handle());
+    subscribers.remove(torrent);
+    auto uuid = uniqueId(torrent);
+    if (!uuid.isEmpty()) {
+        workerThread->unsubscribe(uuid);
+    }
 }
 
 /******************************************************************************
  ******************************************************************************/
-WorkerThread::WorkerThread(QObject *parent) : QThread(parent)
-  , m_session_ptr(new lt::session())
+/*!
+ * \brief Downloads the pieces in order, instead of rarest-first.
+ */
+void TorrentContextPrivate::setStreamingEnabled(Torrent *torrent, bool enabled)
 {
+    auto handle = find(torrent);
+    if (handle.is_valid()) {
+        if (enabled) {
+            handle.set_flags(lt::torrent_flags::sequential_download);
+        } else {
+            handle.unset_flags(lt::torrent_flags::sequential_download);
+            handle.clear_piece_deadlines();
+        }
+    }
+}
+
+/*!
+ * \brief Sets deadlines on a sliding window of pieces, from the read
+ * position of the file. The closest pieces get the shortest deadlines.
+ */
+void TorrentContextPrivate::setStreamingPosition(Torrent *torrent, int fileIndex, qint64 offset)
+{
+    auto handle = find(torrent);
+    if (!handle.is_valid()) {
+        return;
+    }
+    auto ti = handle.torrent_file();
+    if (!ti || fileIndex < 0 || fileIndex >= ti->num_files()) {
+        return;
+    }
+    auto findex = static_cast<lt::file_index_t>(fileIndex);
+    auto fileSize = ti->files().file_size(findex);
+    if (fileSize <= 0) {
+        return;
+    }
+    offset = qBound<qint64>(0, offset, fileSize - 1);
+    auto windowEnd = qMin(offset + TORRENT_STREAMING_WINDOW_BYTES, fileSize) - 1;
+
+    auto first = static_cast<int>(ti->map_file(findex, offset, 0).piece);
+    auto last = static_cast<int>(ti->map_file(findex, windowEnd, 0).piece);
+
+    handle.clear_piece_deadlines();
+    for (auto piece = first; piece <= last; ++piece) {
+        auto deadline = TORRENT_STREAMING_DEADLINE_MSECS * (1 + piece - first);
+        handle.set_piece_deadline(static_cast<lt::piece_index_t>(piece), deadline);
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+bool TorrentContextPrivate::isVerboseAlertsEnabled() const
+{
+    return workerThread->isVerboseAlertsEnabled();
+}
+
+void TorrentContextPrivate::setVerboseAlertsEnabled(bool enabled)
+{
+    workerThread->setVerboseAlertsEnabled(enabled);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+inline Torrent* TorrentContextPrivate::find(const UniqueId &uuid)
+{
+    qDebug_1 << Q_FUNC_INFO;
+    return hashMap.value(uuid, nullptr);
+}
+
+/*!
+ * \brief Returns the cached handle of the given \a torrent.
+ *
+ * The handle is invalid if the torrent is not in the session (yet).
+ */
+inline lt::torrent_handle TorrentContextPrivate::find(Torrent *torrent)
+{
+    qDebug_1 << Q_FUNC_INFO;
+    return handleMap.value(uuidMap.value(torrent));
+}
+
+inline UniqueId TorrentContextPrivate::uniqueId(Torrent *torrent) const
+{
+    return uuidMap.value(torrent);
+}
+
+/*!
+ * \brief Binds the \a torrent to its info-hash, in both directions.
+ */
+void TorrentContextPrivate::bind(const UniqueId &uuid, Torrent *torrent)
+{
+    unbind(torrent);
+    if (auto previous = hashMap.value(uuid, nullptr)) {
+        uuidMap.remove(previous);
+    }
+    hashMap.insert(uuid, torrent);
+    uuidMap.insert(torrent, uuid);
+}
+
+void TorrentContextPrivate::unbind(Torrent *torrent)
+{
+    auto it = uuidMap.constFind(torrent);
+    if (it != uuidMap.constEnd()) {
+        hashMap.remove(it.value());
+        uuidMap.erase(it);
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+WorkerThread::WorkerThread(QObject *parent) : QThread(parent)
+  , m_statusInterval(DEFAULT_TORRENT_STATUS_INTERVAL_MSECS)
+  , m_sessionStatsInterval(DEFAULT_TORRENT_STATS_INTERVAL_MSECS)
+  , m_dhtStatsInterval(DEFAULT_TORRENT_DHT_STATS_INTERVAL_MSECS)
+  , m_resumeDataInterval(DEFAULT_TORRENT_RESUME_DATA_INTERVAL_MSECS)
+{
+}
+
+/*!
+ * \brief Creates the session, before the thread is started.
+ */
+void WorkerThread::createSession(TorrentDiskIo diskIo, const QString &sessionStateFileName)
+{
+    Q_ASSERT(!m_session_ptr);
+    setSessionStateFileName(sessionStateFileName);
+    /*
+     * The disk I/O subsystem can't be replaced in a running session,
+     * and the DHT node id is only read at construction:
+     * both are given to the session constructor.
+     */
+    auto params = readSessionState(sessionStateFileName);
+    params.disk_io_constructor = diskIoConstructor(diskIo);
+    m_session_ptr = new lt::session(std::move(params));
+    qDebug_2 << "disk I/O backend:" << diskIoName(diskIo);
 }
 
 /******************************************************************************
@@ -1115,6 +1658,13 @@ WorkerThread::WorkerThread(QObject *parent) : QThread(parent)
 void WorkerThread::stop()
 {
     shouldQuit = true;
+    /*
+     * Wake up the loop, that waits for an alert:
+     * the session stats are posted back almost immediately.
+     */
+    if (m_session_ptr && m_session_ptr->is_valid()) {
+        m_session_ptr->post_session_stats();
+    }
 }
 
 /******************************************************************************
@@ -1138,6 +1688,195 @@ void WorkerThread::setEnabled(bool enabled)
         } else {
             m_session_ptr->pause();
         }
+        m_enabled = enabled;
+    }
+}
+
+bool WorkerThread::isVerboseAlertsEnabled() const
+{
+    return m_verboseAlertsEnabled;
+}
+
+/*!
+ * \brief Enables the verbose alert categories, and logs their alerts.
+ */
+void WorkerThread::setVerboseAlertsEnabled(bool enabled)
+{
+    m_verboseAlertsEnabled = enabled;
+    if (m_session_ptr && m_session_ptr->is_valid()) {
+        lt::settings_pack pack;
+        pack.set_int(lt::settings_pack::alert_mask, alertMask(enabled));
+        m_session_ptr->apply_settings(pack);
+    }
+}
+
+/*!
+ * \brief Sets the intervals between two posts of the torrent updates,
+ * of the session stats and of the DHT stats. 0 disables the post.
+ */
+void WorkerThread::setIntervals(int statusMsecs, int sessionStatsMsecs, int dhtStatsMsecs)
+{
+    m_statusInterval = qMax(0, statusMsecs);
+    m_sessionStatsInterval = qMax(0, sessionStatsMsecs);
+    m_dhtStatsInterval = qMax(0, dhtStatsMsecs);
+}
+
+/*!
+ * \brief Sets the interval between two saves of the fast-resume data
+ * of the modified torrents. 0 disables the periodic save.
+ * The resume data is saved on exit anyway.
+ */
+void WorkerThread::setResumeDataInterval(int msecs)
+{
+    m_resumeDataInterval = qMax(0, msecs);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+QString WorkerThread::resumeDataPath() const
+{
+    QMutexLocker locker(&m_pathMutex);
+    return m_resumeDataPath;
+}
+
+void WorkerThread::setResumeDataPath(const QString &path)
+{
+    QMutexLocker locker(&m_pathMutex);
+    m_resumeDataPath = path;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+QString WorkerThread::sessionStateFileName() const
+{
+    QMutexLocker locker(&m_pathMutex);
+    return m_sessionStateFileName;
+}
+
+/*!
+ * \brief Sets the file where the session state (DHT state, IP filter)
+ * is saved on exit.
+ */
+void WorkerThread::setSessionStateFileName(const QString &fileName)
+{
+    QMutexLocker locker(&m_pathMutex);
+    m_sessionStateFileName = fileName;
+}
+
+/*!
+ * \brief Reads the state saved by saveSessionState(), to construct the session.
+ *
+ * The DHT state keeps the node id and the routing table,
+ * what avoids bootstrapping the DHT from the routers.
+ * Returns default parameters at first start, or if the file is invalid.
+ */
+lt::session_params WorkerThread::readSessionState(const QString &fileName)
+{
+    if (fileName.isEmpty()) {
+        return {};
+    }
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {}; // first start
+    }
+    auto bytes = file.readAll();
+    file.close();
+    try {
+        return lt::read_session_params({bytes.constData(), bytes.size()}, s_session_state_flags);
+
+    } catch (std::exception const& e) {
+        qWarning() << "Invalid session state" << fileName << ":" << QString::fromUtf8(e.what());
+    }
+    return {};
+}
+
+void WorkerThread::saveSessionState(lt::session &session)
+{
+    auto fileName = sessionStateFileName();
+    if (fileName.isEmpty()) {
+        return;
+    }
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    auto state = session.session_state(s_session_state_flags);
+    auto buffer = lt::write_session_params_buf(state, s_session_state_flags);
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)
+            || file.write(buffer.data(), static_cast<qint64>(buffer.size())) != static_cast<qint64>(buffer.size())
+            || !file.commit()) {
+        qWarning() << "Can't write the session state" << fileName << ":" << file.errorString();
+    }
+}
+
+QString WorkerThread::resumeDataFileName(const UniqueId &uuid) const
+{
+    auto path = resumeDataPath();
+    if (path.isEmpty() || uuid.isEmpty()) {
+        return {};
+    }
+    return QDir(path).filePath(uuid + u".fastresume"_s);
+}
+
+/*!
+ * \brief Replaces the given \a params with the fast-resume data
+ * saved during a previous session, if any.
+ *
+ * The torrent then doesn't need to be re-checked: libtorrent
+ * trusts the pieces and the file priorities stored in the resume data.
+ * Returns false if there's no valid resume data.
+ */
+bool WorkerThread::readResumeData(lt::add_torrent_params &params) const
+{
+    auto hash = params.ti ? params.ti->info_hash() : params.info_hashes.v1;
+    auto fileName = resumeDataFileName(TorrentUtils::toUniqueId(hash));
+    if (fileName.isEmpty() || !QFileInfo::exists(fileName)) {
+        return false;
+    }
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Can't read the resume data" << fileName << ":" << file.errorString();
+        return false;
+    }
+    auto bytes = file.readAll();
+    file.close();
+
+    lt::error_code ec;
+    auto resumed = lt::read_resume_data({bytes.constData(), bytes.size()}, ec);
+    if (ec) {
+        qWarning() << "Invalid resume data" << fileName << ":" << QString::fromStdString(ec.message());
+        QFile::remove(fileName);
+        return false;
+    }
+    if (params.ti) {
+        resumed.ti = params.ti; // the .torrent file prevails
+        if (!params.file_priorities.empty()) {
+            resumed.file_priorities = params.file_priorities; // user's choice
+        }
+    }
+    resumed.save_path = params.save_path;
+    /* The queue flags of the resume data are obsolete, see addTorrent() */
+    auto queueFlags = lt::torrent_flags::paused | lt::torrent_flags::auto_managed;
+    resumed.flags = (resumed.flags & ~queueFlags) | (params.flags & queueFlags);
+    params = std::move(resumed);
+    return true;
+}
+
+/*!
+ * \brief Requests the resume data of the torrents modified since the last save.
+ * The data is received asynchronously, and written by handleSaveResumeData().
+ */
+void WorkerThread::requestResumeData(lt::session &session, bool flush)
+{
+    lt::resume_data_flags_t flags = lt::torrent_handle::save_info_dict
+            | lt::torrent_handle::only_if_modified;
+    if (flush) {
+        flags |= lt::torrent_handle::flush_disk_cache;
+    }
+    for (const auto &handle : session.get_torrents()) {
+        if (handle.is_valid() && handle.need_save_resume_data(flags)) {
+            handle.save_resume_data(flags);
+            m_pendingResumeData++;
+        }
     }
 }
 
@@ -1159,7 +1898,7 @@ void WorkerThread::setSettings(lt::settings_pack &pack)
 
         // Settings that can't be modified by the user
         pack.set_str(lt::settings_pack::user_agent, std::string());
-        pack.set_int(lt::settings_pack::alert_mask, lt::alert::all_categories);
+        pack.set_int(lt::settings_pack::alert_mask, alertMask(m_verboseAlertsEnabled));
 
         m_session_ptr->apply_settings(pack);
     }
@@ -1184,15 +1923,19 @@ TorrentInitialMetaInfo WorkerThread::dump(const QString &filename) const
 
 /******************************************************************************
  ******************************************************************************/
-lt::torrent_handle WorkerThread::addTorrent(lt::add_torrent_params const& params,
-                                            lt::error_code& ec)
+/*!
+ * \brief Adds the torrents to the session, without blocking.
+ * Each torrent is notified by an add_torrent_alert, see onTorrentAdded().
+ */
+void WorkerThread::asyncAddTorrents(std::vector<lt::add_torrent_params> params)
 {
-    qDebug_2 << Q_FUNC_INFO;
+    qDebug_2 << Q_FUNC_INFO << params.size();
     Q_ASSERT(m_session_ptr);
     if (m_session_ptr && m_session_ptr->is_valid()) {
-        return m_session_ptr->add_torrent(params, ec);
+        for (auto &p : params) {
+            m_session_ptr->async_add_torrent(std::move(p));
+        }
     }
-    return {};
 }
 
 /******************************************************************************
@@ -1202,6 +1945,14 @@ void WorkerThread::removeTorrent(const lt::torrent_handle& h, lt::remove_flags_t
     qDebug_2 << Q_FUNC_INFO;
     Q_ASSERT(m_session_ptr);
     if (m_session_ptr && m_session_ptr->is_valid()) {
+        if (options & lt::session_handle::delete_files) {
+            QFile::remove(resumeDataFileName(TorrentUtils::toUniqueId(h.info_hash())));
+        } else if (h.is_valid()) {
+            // Keep the progress: the request is processed before the removal
+            h.save_resume_data(lt::torrent_handle::save_info_dict
+                               | lt::torrent_handle::flush_disk_cache);
+            m_pendingResumeData++;
+        }
         m_session_ptr->remove_torrent(h, options);
     }
 }
@@ -1219,6 +1970,40 @@ lt::torrent_handle WorkerThread::findTorrent(const UniqueId &uuid) const
     return lt::torrent_handle();
 }
 
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \brief Includes the detail of the torrent in its status updates.
+ *
+ * A status is posted at once, because the torrent might not change,
+ * hence not be updated, for a while (e.g. when paused).
+ */
+void WorkerThread::subscribe(const UniqueId &uuid)
+{
+    {
+        QMutexLocker locker(&m_subscriptionMutex);
+        m_subscriptions.insert(uuid);
+    }
+    if (m_session_ptr && m_session_ptr->is_valid()) {
+        auto handle = findTorrent(uuid);
+        if (handle.is_valid()) {
+            handle.post_status(s_torrent_status_flags);
+        }
+    }
+}
+
+void WorkerThread::unsubscribe(const UniqueId &uuid)
+{
+    QMutexLocker locker(&m_subscriptionMutex);
+    m_subscriptions.remove(uuid);
+}
+
+bool WorkerThread::isSubscribed(const UniqueId &uuid) const
+{
+    QMutexLocker locker(&m_subscriptionMutex);
+    return m_subscriptions.contains(uuid);
+}
+
 /******************************************************************************
  ******************************************************************************/
 void WorkerThread::run()
@@ -1263,26 +2048,86 @@ void WorkerThread::run()
 //    session.set_dht_storage(std::move(params.dht_storage_constructor));
 //#endif
 
-    lt::ip_filter loaded_ip_filter;
-    session.set_ip_filter(loaded_ip_filter);
-
     session.pause();
+    m_enabled = false;
+
+    /*
+     * The loop sleeps until an alert arrives, or until the next post is due.
+     * Each post (torrent updates, session stats, DHT stats) has its own cadence.
+     * While the session is paused, nothing is posted: the thread only wakes up
+     * for the alerts, or every TIMEOUT_IDLE.
+     */
+    using Clock = std::chrono::steady_clock;
+    auto nextStatus = Clock::now();
+    auto nextSessionStats = nextStatus;
+    auto nextDhtStats = nextStatus;
+    auto nextResumeData = nextStatus + std::chrono::milliseconds(m_resumeDataInterval);
+
+    std::vector<lt::alert*> alerts;
 
     // main loop
     while (!shouldQuit) {
-        session.post_torrent_updates(s_torrent_status_flags);
-        session.post_session_stats();
-        session.post_dht_stats();
+        auto now = Clock::now();
+        auto deadline = now + TIMEOUT_IDLE;
+
+        auto schedule = [&now, &deadline](int interval, Clock::time_point &next) {
+            if (interval <= 0) {
+                return false;
+            }
+            auto due = now >= next;
+            if (due) {
+                next = now + std::chrono::milliseconds(interval);
+            }
+            deadline = std::min(deadline, next);
+            return due;
+        };
 
-        QThread::msleep(TIMEOUT_REFRESH.count());
+        if (m_enabled) {
+            if (schedule(m_statusInterval, nextStatus)) {
+                session.post_torrent_updates(s_torrent_status_flags);
+            }
+            if (schedule(m_sessionStatsInterval, nextSessionStats)) {
+                session.post_session_stats();
+            }
+            if (schedule(m_dhtStatsInterval, nextDhtStats)) {
+                session.post_dht_stats();
+            }
+            if (schedule(m_resumeDataInterval, nextResumeData)) {
+                requestResumeData(session, false);
+            }
+        }
 
-        std::vector<lt::alert*> alerts;
-        session.pop_alerts(&alerts);
-        for (auto a : alerts) {
-            signalizeAlert(a);
+        auto timeout = std::max(Clock::duration::zero(), deadline - Clock::now());
+        if (session.wait_for_alert(std::chrono::duration_cast<lt::time_duration>(timeout))) {
+            session.pop_alerts(&alerts);
+            for (auto a : alerts) {
+                signalizeAlert(a);
+            }
         }
     } // end of main loop
 
+    /*
+     * Save the resume data of the modified torrents, so that they
+     * come back at next start without a full re-check of their files.
+     */
+    session.pause();
+    requestResumeData(session, true);
+    auto resumeDeadline = Clock::now() + TIMEOUT_RESUME_DATA;
+    while (m_pendingResumeData > 0 && Clock::now() < resumeDeadline) {
+        auto timeout = std::max(Clock::duration::zero(), resumeDeadline - Clock::now());
+        if (session.wait_for_alert(std::chrono::duration_cast<lt::time_duration>(timeout))) {
+            session.pop_alerts(&alerts);
+            for (auto a : alerts) {
+                signalizeAlert(a);
+            }
+        }
+    }
+    if (m_pendingResumeData > 0) {
+        qWarning() << "Timeout: resume data not saved for" << m_pendingResumeData.load() << "torrent(s)";
+    }
+
+    saveSessionState(session);
+
     qDebug_2 << Q_FUNC_INFO << "Closing session... ";
 
     /*
@@ -1302,378 +2147,201 @@ void WorkerThread::run()
 
 /******************************************************************************
  ******************************************************************************/
+/*!
+ * \brief Dispatch table, indexed by lt::alert::type().
+ * A null entry means the alert is not consumed.
+ */
+const WorkerThread::AlertHandlers& WorkerThread::alertHandlers()
+{
+    static const AlertHandlers handlers = [] {
+        AlertHandlers ret = {};
+        ret[lt::add_torrent_alert::alert_type] = &WorkerThread::handleAddTorrent;
+        ret[lt::torrent_removed_alert::alert_type] = &WorkerThread::handleTorrentRemoved;
+        ret[lt::torrent_checked_alert::alert_type] = &WorkerThread::handleTorrentChecked;
+        ret[lt::state_update_alert::alert_type] = &WorkerThread::handleStateUpdate;
+        ret[lt::metadata_received_alert::alert_type] = &WorkerThread::handleMetadataReceived;
+        ret[lt::metadata_failed_alert::alert_type] = &WorkerThread::handleMetadataFailed;
+        ret[lt::performance_alert::alert_type] = &WorkerThread::handlePerformanceWarning;
+        ret[lt::session_stats_alert::alert_type] = &WorkerThread::handleSessionStats;
+        ret[lt::alerts_dropped_alert::alert_type] = &WorkerThread::handleAlertsDropped;
+        ret[lt::save_resume_data_alert::alert_type] = &WorkerThread::handleSaveResumeData;
+        ret[lt::save_resume_data_failed_alert::alert_type] = &WorkerThread::handleSaveResumeDataFailed;
+        return ret;
+    }();
+    return handlers;
+}
+
 /*!
  * \brief Convert lt::alert to QSignal
  */
 void WorkerThread::signalizeAlert(lt::alert* a)
 {
-    /* status_notification */
-    if (auto s = lt::alert_cast<lt::torrent_removed_alert>(a)) {
-        //QString hash = toString(s->info_hashes.get_best());
-        //  emit torrentRemoved(hash);
-    }
-    else if (auto s = lt::alert_cast<lt::state_changed_alert>(a)) {
-        //        lt::torrent_status::state_t oldStatus = s->prev_state;
-        //        lt::torrent_status::state_t newStatus = s->state;
-        //  emit torrentStateChanged(oldState, newState); // rem quel torrent ?
-    }
-    else if (auto s = lt::alert_cast<lt::hash_failed_alert>(a)) {
-        //        int piece_index = (int)s->piece_index;
-        //  emit pieceHashCheckFailed(piece_index);
-    }
-    else if (auto s = lt::alert_cast<lt::torrent_finished_alert>(a)) {
-        //        emit torrentFinished();
-    }
-    else if (auto s = lt::alert_cast<lt::torrent_paused_alert>(a)) {
-        //        emit torrentPaused();
-    }
-    else if (auto s = lt::alert_cast<lt::torrent_resumed_alert>(a)) {
-        //        emit torrentResumed();
-    }
-    else if (auto s = lt::alert_cast<lt::torrent_checked_alert>(a)) {
-        //        emit torrentChecked();
-    }
-    else if (auto s = lt::alert_cast<lt::fastresume_rejected_alert>(a)) {
-        //        emit torrentFastResumeFailed();
-    }
-    else if (auto s = lt::alert_cast<lt::trackerid_alert>(a)) {
-        //        emit trackeridReceived();
-    }
-    else if (auto s = lt::alert_cast<lt::torrent_error_alert>(a)) {
-        //        emit torrentError();
-    }
-    else if (auto s = lt::alert_cast<lt::torrent_need_cert_alert>(a)) {
-        //        emit torrentSSLError();
-    }
-    else if (auto s = lt::alert_cast<lt::add_torrent_alert>(a)) {
-        onTorrentAdded(s->handle, s->params, s->error);
+    auto type = a->type();
+    if (type >= 0 && type < lt::num_alert_types) {
+        auto handler = alertHandlers()[static_cast<std::size_t>(type)];
+        if (handler) {
+            (this->*handler)(a);
+            return;
+        }
     }
-    else if (auto s = lt::alert_cast<lt::state_update_alert>(a)) {
-        /* Note: This alert is emitted very often (each loop) */
-        // log(s);
-        onStateUpdated(s->status);
+    if (m_verboseAlertsEnabled) {
+        log(a);
     }
+}
 
-    // magnet extension
-    else if (auto s = lt::alert_cast<lt::metadata_failed_alert>(a)) {
-        //        emit metadataFailed();
-        qWarning() << "metadata that was received was corrupt";
-    }
-    else if (auto s = lt::alert_cast<lt::metadata_received_alert>(a)) {
-        onMetadataReceived(s->handle);
-    }
+void WorkerThread::handleAddTorrent(lt::alert *a)
+{
+    auto s = static_cast<lt::add_torrent_alert*>(a);
+    onTorrentAdded(s->handle, s->params, s->error);
+}
 
+void WorkerThread::handleTorrentRemoved(lt::alert *a)
+{
+    auto s = static_cast<lt::torrent_removed_alert*>(a);
+    auto uuid = TorrentUtils::toUniqueId(s->info_hashes.v1);
+    m_postedStatuses.remove(uuid);
+    emit torrentRemoved(uuid);
+}
 
-    // IP
-    else if (auto s = lt::alert_cast<lt::external_ip_alert>(a)) {
-        Q_UNUSED(s) //  emit externalIpAddressReceived();
-    }
-    else if (auto s = lt::alert_cast<lt::peer_blocked_alert>(a)) {
-        Q_UNUSED(s) //  emit peerIpBlocked();
-    }
-    // dht
-    else if (auto s = lt::alert_cast<lt::dht_announce_alert>(a)) {
-        Q_UNUSED(s) //  emit peerDHT();
-    }
-    else if (auto s = lt::alert_cast<lt::dht_get_peers_alert>(a)) {
-        Q_UNUSED(s) //  emit peerDHTReceviedd();
-    }
-    else if (auto s = lt::alert_cast<lt::dht_bootstrap_alert>(a)) {
-        Q_UNUSED(s) //  emit peerDHTbootstrapDone();
-    }
-    else if (auto s = lt::alert_cast<lt::dht_error_alert>(a)) {
-        Q_UNUSED(s) //  emit peerDHTError();
-    }
-    else if (auto s = lt::alert_cast<lt::dht_immutable_item_alert>(a)) {
-        Q_UNUSED(s) //  emit peerDHTImmmutablee();
-    }
-    else if (auto s = lt::alert_cast<lt::dht_mutable_item_alert>(a)) {
-        Q_UNUSED(s) //  emit peerDHTmutablee();
-    }
-    else if (auto s = lt::alert_cast<lt::dht_put_alert>(a)) {
-        Q_UNUSED(s) //  emit peerDHTput();
-    }
-    else if (auto s = lt::alert_cast<lt::i2p_alert>(a)) {
-        Q_UNUSED(s) //  emit i2pError();
-    }
-    else if (auto s = lt::alert_cast<lt::dht_outgoing_get_peers_alert>(a)) {
-        Q_UNUSED(s) //  emit dht_get_peers_Sent();
-    }
+void WorkerThread::handleTorrentChecked(lt::alert *a)
+{
+    auto s = static_cast<lt::torrent_checked_alert*>(a);
+    emit torrentChecked(TorrentUtils::toUniqueId(s->handle.info_hash()));
+}
 
+void WorkerThread::handleStateUpdate(lt::alert *a)
+{
+    /* Note: This alert is emitted very often (each loop) */
+    auto s = static_cast<lt::state_update_alert*>(a);
+    onStateUpdated(s->status);
+}
 
+void WorkerThread::handleMetadataReceived(lt::alert *a)
+{
+    auto s = static_cast<lt::metadata_received_alert*>(a);
+    onMetadataReceived(s->handle);
+}
 
-    // Firewall error ?
-    else if (auto s = lt::alert_cast<lt::udp_error_alert>(a)) {
-        Q_UNUSED(s) //  emit protocolError();
-    }
-    else if (auto s = lt::alert_cast<lt::listen_succeeded_alert>(a)) {
-        Q_UNUSED(s) //  emit hostPortOpened();
-    }
-    else if (auto s = lt::alert_cast<lt::listen_failed_alert>(a)) {
-        Q_UNUSED(s) //  emit hostPortOpenFailed();
-    }
-    else if (auto s = lt::alert_cast<lt::portmap_alert>(a)) {
-        Q_UNUSED(s) //  emit portOpened();
-    }
-    else if (auto s = lt::alert_cast<lt::portmap_error_alert>(a)) {
-        Q_UNUSED(s) //  emit portOpenFailed();
-    }
-    else if (auto s = lt::alert_cast<lt::portmap_log_alert>(a)) {
-        Q_UNUSED(s) //  emit debugPort();
-    }
-    else if (auto s = lt::alert_cast<lt::log_alert>(a)) {
-        Q_UNUSED(s) //  emit debugLog();
-    }
-    else if (auto s = lt::alert_cast<lt::torrent_log_alert>(a)) {
-        Q_UNUSED(s) //  emit debugTorrentLog();
-    }
-    else if (auto s = lt::alert_cast<lt::peer_log_alert>(a)) {
-        Q_UNUSED(s) //  emit debugPeerLog();
-    }
-    else if (auto s = lt::alert_cast<lt::lsd_error_alert>(a)) {
-        Q_UNUSED(s) //  emit debugLSDPeerLog();
-    }
-    else if (auto s = lt::alert_cast<lt::dht_log_alert>(a)) {
-        Q_UNUSED(s) //  emit debugDHTLog();
-    }
-    else if (auto s = lt::alert_cast<lt::dht_pkt_alert>(a)) {
-        Q_UNUSED(s) //  emit dht_pkt_alert();
-    }
-    else if (auto s = lt::alert_cast<lt::dht_get_peers_reply_alert>(a)) {
-        Q_UNUSED(s) //  emit dht_get_peers_reply_alert();
-    }
-    else if (auto s = lt::alert_cast<lt::dht_direct_response_alert>(a)) {
-        Q_UNUSED(s) //  emit dht_direct_response_alert();
-    }
-    else if (auto s = lt::alert_cast<lt::picker_log_alert>(a)) {
-        Q_UNUSED(s) //  emit debugPickerLog();
-    }
-    else if (auto s = lt::alert_cast<lt::session_error_alert>(a)) {
-        Q_UNUSED(s) //  emit session_error_alert();
-    }
-    else if (auto s = lt::alert_cast<lt::dht_live_nodes_alert>(a)) {
-        Q_UNUSED(s) //  emit dht_live_nodes_alert();
-    }
-    else if (auto s = lt::alert_cast<lt::dht_sample_infohashes_alert>(a)) {
-        Q_UNUSED(s) //  emit dht_sample_infohashes_alert();
-    }
+void WorkerThread::handleMetadataFailed(lt::alert *a)
+{
+    Q_UNUSED(a)
+    qWarning() << "metadata that was received was corrupt";
+}
 
+void WorkerThread::handlePerformanceWarning(lt::alert *a)
+{
+    m_lastPerformanceWarning = QString::fromStdString(a->message());
+    m_performanceWarnings++;
+    qWarning() << "[alert]" << m_lastPerformanceWarning;
+}
 
-    /* stats_notification */
-    else if (auto s = lt::alert_cast<lt::session_stats_alert>(a)) {
-        //        const lt::span<std::int64_t const> counters = s->counters() ;
+/*!
+ * \brief Indexes of the session counters, in session_stats_alert::counters().
+ */
+struct SessionMetrics
+{
+    int queuedDiskJobs = lt::find_metric_idx("disk.queued_disk_jobs");
+    int queuedWriteBytes = lt::find_metric_idx("disk.queued_write_bytes");
+    int readOps = lt::find_metric_idx("disk.num_read_ops");
+    int writeOps = lt::find_metric_idx("disk.num_write_ops");
+    int readTime = lt::find_metric_idx("disk.disk_read_time");
+    int writeTime = lt::find_metric_idx("disk.disk_write_time");
+    int pickerBusyLoops = lt::find_metric_idx("picker.piece_picker_busy_loops");
+    int uploadQueue = lt::find_metric_idx("net.limiter_up_queue");
+    int downloadQueue = lt::find_metric_idx("net.limiter_down_queue");
+    int connectedPeers = lt::find_metric_idx("peer.num_peers_connected");
+    int tooManyPeers = lt::find_metric_idx("peer.too_many_peers");
+};
 
-        // TODO
+/*!
+ * \brief Converts the counters posted by post_session_stats() to a sample.
+ * The cumulative counters are converted to deltas since the previous sample.
+ */
+void WorkerThread::handleSessionStats(lt::alert *a)
+{
+    static const SessionMetrics metrics;
 
-        Q_UNUSED(s) //  emit sessionStatsUpdated();
-    }
-    else if (auto s = lt::alert_cast<lt::dht_stats_alert>(a)) {
-        Q_UNUSED(s) //  emit dhtStatsUpdated();
-    }
-    else if (auto s = lt::alert_cast<lt::session_stats_header_alert>(a)) {
-        Q_UNUSED(s) //  emit session_stats_header_Updated();
+    auto s = static_cast<lt::session_stats_alert*>(a);
+    auto counters = s->counters();
+    auto size = static_cast<int>(counters.size());
+    if (m_previousCounters.size() != counters.size()) {
+        m_previousCounters.assign(counters.begin(), counters.end()); // first sample
     }
+    auto value = [&counters, size](int index) -> qint64 {
+        return index >= 0 && index < size ? counters[index] : 0;
+    };
+    auto delta = [this, &value, size](int index) -> qint64 {
+        return index >= 0 && index < size ? value(index) - m_previousCounters[index] : 0;
+    };
 
+    TorrentSessionStats stats;
+    stats.timestamp = QDateTime::currentDateTimeUtc();
 
-    /* storage_notification */
-    else if (auto s = lt::alert_cast<lt::read_piece_alert>(a)) {
-        Q_UNUSED(s) // emit fileCompleted(index);
-    }
-    else if (auto s = lt::alert_cast<lt::file_prio_alert>(a)) {
-        Q_UNUSED(s)
-    }
-    else if (auto s = lt::alert_cast<lt::oversized_file_alert>(a)) {
-        Q_UNUSED(s)
-    }
-    else if (auto s = lt::alert_cast<lt::torrent_conflict_alert>(a)) {
-        Q_UNUSED(s)
-    }
-    else if (auto s = lt::alert_cast<lt::peer_info_alert>(a)) {
-        Q_UNUSED(s)
-    }
-    else if (auto s = lt::alert_cast<lt::file_progress_alert>(a)) {
-        Q_UNUSED(s)
-    }
-    else if (auto s = lt::alert_cast<lt::piece_info_alert>(a)) {
-        Q_UNUSED(s)
-    }
-    else if (auto s = lt::alert_cast<lt::piece_availability_alert>(a)) {
-        Q_UNUSED(s)
-    }
-    else if (auto s = lt::alert_cast<lt::tracker_list_alert>(a)) {
-        Q_UNUSED(s)
-    }
+    stats.diskQueuedJobs = value(metrics.queuedDiskJobs);
+    stats.diskQueuedWriteBytes = value(metrics.queuedWriteBytes);
+    auto readOps = delta(metrics.readOps);
+    auto writeOps = delta(metrics.writeOps);
+    stats.diskReadTime = readOps > 0 ? delta(metrics.readTime) / readOps : 0;
+    stats.diskWriteTime = writeOps > 0 ? delta(metrics.writeTime) / writeOps : 0;
 
-    else if (auto s = lt::alert_cast<lt::file_renamed_alert>(a)) {
-        //        int index = (int)s->index;
-        //        QString newName = QString::fromUtf8(s->new_name());
-        Q_UNUSED(s) //  emit fileRenamed(index, newName);
-    }
-    else if (auto s = lt::alert_cast<lt::file_rename_failed_alert>(a)) {
-        //        int index = (int)s->index;
-        //        QString errorMessage = QString::fromStdString(s->error.message());
-        Q_UNUSED(s) //  emit fileRenameFailed(index, errorMessage);
-    }
-    else if (auto s = lt::alert_cast<lt::storage_moved_alert>(a)) {
-        Q_UNUSED(s) //  emit storageMoved();
-    }
-    else if (auto s = lt::alert_cast<lt::storage_moved_failed_alert>(a)) {
-        Q_UNUSED(s) //  emit storageMoveFailed();
-    }
-    else if (auto s = lt::alert_cast<lt::torrent_deleted_alert>(a)) {
-        Q_UNUSED(s) //  emit torrentDeleted();
-    }
-    else if (auto s = lt::alert_cast<lt::torrent_delete_failed_alert>(a)) {
-        Q_UNUSED(s) //  emit torrentDeleteFailed();
-    }
-    else if (auto s = lt::alert_cast<lt::save_resume_data_alert>(a)) {
-        Q_UNUSED(s) //  emit resumeDataSaved();
+    stats.pickerBusyLoops = delta(metrics.pickerBusyLoops);
 
-    } else if (auto s = lt::alert_cast<lt::save_resume_data_failed_alert>(a)) {
-        Q_UNUSED(s) //  emit resumeDataSaveFailed();
-    }
-    else if (auto s = lt::alert_cast<lt::file_error_alert>(a)) {
-        Q_UNUSED(s) //  emit fileReadOrWriteError();
-    }
-    else if (auto s = lt::alert_cast<lt::cache_flushed_alert>(a)) {
-        Q_UNUSED(s) //  emit cache_flushed();
-    }
+    stats.performanceWarnings = std::exchange(m_performanceWarnings, 0);
+    stats.lastPerformanceWarning = std::exchange(m_lastPerformanceWarning, {});
 
+    stats.uploadQueue = value(metrics.uploadQueue);
+    stats.downloadQueue = value(metrics.downloadQueue);
 
+    stats.connectedPeers = value(metrics.connectedPeers);
+    stats.rejectedPeers = delta(metrics.tooManyPeers);
 
+    m_previousCounters.assign(counters.begin(), counters.end());
 
-    /* file_progress_notification */
-    else if (auto s = lt::alert_cast<lt::file_completed_alert>(a)) {
-        //        int index = (int)s->index;
-        Q_UNUSED(s) //  emit fileCompleted(index);
-    }
-
-    /* performance_warning */
-    else if (auto s = lt::alert_cast<lt::performance_alert>(a)) {
-        //        QString message = QString::fromStdString(s->message());
-        Q_UNUSED(s) //  emit performanceWarning(message);
-    }
+    emit sessionStatsUpdated(stats);
+}
 
-    /* tracker_notification & error_notification */
-    else if (auto s = lt::alert_cast<lt::tracker_error_alert>(a)) {
-        //        int times_in_row = s->times_in_row;
-        Q_UNUSED(s) //  emit trackerConnectionFailed(times_in_row, errorCode);
-    }
-    else if (auto s = lt::alert_cast<lt::tracker_warning_alert>(a)) {
-        //        QString message = QString::fromUtf8(s->warning_message());
-        Q_UNUSED(s) //  emit trackerMessageReceived(message);
-    }
-    else if (auto s = lt::alert_cast<lt::scrape_reply_alert>(a)) {
-        //        int incomplete = s->incomplete;
-        //        int complete = s->complete;
-        Q_UNUSED(s) //  emit trackerScrapeSucceeded(incomplete, complete);
-    }
-    else if (auto s = lt::alert_cast<lt::scrape_failed_alert>(a)) {
-        //        QString errorCode = QString::fromStdString(s->error.message());
-        //        QString errorMessage = QString::fromUtf8(s->error_message());
-        Q_UNUSED(s) //  emit trackerScrapeFailed(errorCode, errorMessage);
-    }
-    else if (auto s = lt::alert_cast<lt::tracker_reply_alert>(a)) {
-        //        int peersCount = s->num_peers;
-        Q_UNUSED(s) //  emit trackerInfo(peersCount);
-    }
-    else if (auto s = lt::alert_cast<lt::dht_reply_alert>(a)) {
-        //        int peersCount = s->num_peers;
-        Q_UNUSED(s) //  emit trackerDHTInfo(peersCount);
-    }
-    else if (auto s = lt::alert_cast<lt::tracker_announce_alert>(a)) {
-        //        int eventcode = s->event;
-        Q_UNUSED(s) //  emit trackerEventSent(eventcode);
-    }
+void WorkerThread::handleAlertsDropped(lt::alert *a)
+{
+    Q_UNUSED(a)
+    qWarning() << "Alert queue grew too big.";
+}
 
-    /* peer_notification */
-    else if (auto s = lt::alert_cast<lt::peer_ban_alert>(a)) {
-        Q_UNUSED(s) //  emit peerBanned();
-    }
-    else if (auto s = lt::alert_cast<lt::peer_unsnubbed_alert>(a)) {
-        Q_UNUSED(s) //  emit peerUnsnubbed();
-    }
-    else if (auto s = lt::alert_cast<lt::peer_snubbed_alert>(a)) {
-        Q_UNUSED(s) //  emit peerSnubbed();
-    }
-    else if (auto s = lt::alert_cast<lt::peer_error_alert>(a)) {
-        //        QString operation = QString::fromUtf8(lt::operation_name(s->op));
-        //        QString errorCode = QString::fromStdString(s->error.message());
-        Q_UNUSED(s) //  emit peerAboutToDisconnected(operation, errorCode);
+void WorkerThread::handleSaveResumeData(lt::alert *a)
+{
+    auto s = static_cast<lt::save_resume_data_alert*>(a);
+    if (m_pendingResumeData > 0) {
+        m_pendingResumeData--;
     }
-    else if (auto s = lt::alert_cast<lt::peer_connect_alert>(a)) {
-        Q_UNUSED(s)
-        // don't log every peer we try to connect to
+    auto uuid = TorrentUtils::toUniqueId(s->handle.info_hash());
+    auto fileName = resumeDataFileName(uuid);
+    if (fileName.isEmpty()) {
         return;
-        //  int socket_type = s->socket_type;
-        //  emit peerConnected(socket_type);
-    }
-    else if (auto s = lt::alert_cast<lt::peer_disconnected_alert>(a)) {
-        //        int socket_type = s->socket_type;
-        //        operation_t const op;
-        //		error_code const error;
-        //		close_reason_t const reason;
-        Q_UNUSED(s) //  emit peerDisconnected(/*socket_type*/);
-    }
-    else if (auto s = lt::alert_cast<lt::invalid_request_alert>(a)) {
-        //        peer_request const request;
-        //		bool const we_have;
-        //		bool const peer_interested;
-        //		bool const withheld;
-        Q_UNUSED(s) //  emit peerInvalidPieceReceived();
-    }
-    else if (auto s = lt::alert_cast<lt::piece_finished_alert>(a)) {
-        Q_UNUSED(s) //  emit pieceFinished();
-    }
-    else if (auto s = lt::alert_cast<lt::lsd_peer_alert>(a)) {
-        Q_UNUSED(s) //  emit lsd_peer();
-    }
-    else if (auto s = lt::alert_cast<lt::incoming_connection_alert>(a)) {
-        Q_UNUSED(s) //  emit peerIncomingConnectionAccepted();
-    }
-    else if (auto s = lt::alert_cast<lt::incoming_request_alert>(a)) {
-        Q_UNUSED(s) //  emit peerIncomingrequestAccepted();
     }
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
 
-
-    /* block_progress_notification */
-    else if (auto s = lt::alert_cast<lt::request_dropped_alert>(a)) {
-        Q_UNUSED(s) //  emit peerPieceRejected();
-    }
-    else if (auto s = lt::alert_cast<lt::block_timeout_alert>(a)) {
-        Q_UNUSED(s) //  emit peerPieceTimeOut();
-    }
-    else if (auto s = lt::alert_cast<lt::block_finished_alert>(a)) {
-        Q_UNUSED(s) //  emit peerPieceFinished();
-    }
-    else if (auto s = lt::alert_cast<lt::block_downloading_alert>(a)) {
-        Q_UNUSED(s) //  emit peerPieceDownloading();
-    }
-    else if (auto s = lt::alert_cast<lt::unwanted_block_alert>(a)) {
-        Q_UNUSED(s) //  emit peerPieceUnwanted();
-    }
-
-    else if (auto s = lt::alert_cast<lt::url_seed_alert>(a)) {
-        Q_UNUSED(s) //  emit seedUrlFailed();
-    }
-    else if (auto s = lt::alert_cast<lt::block_uploaded_alert>(a)) {
-        Q_UNUSED(s) //  emit blockUploaded();
+    auto buffer = lt::write_resume_data_buf(s->params);
+    QSaveFile file(fileName);
+    if (file.open(QIODevice::WriteOnly)
+            && file.write(buffer.data(), static_cast<qint64>(buffer.size())) == static_cast<qint64>(buffer.size())
+            && file.commit()) {
+        emit resumeDataSaved();
+    } else {
+        qWarning() << "Can't write the resume data" << fileName << ":" << file.errorString();
+        emit resumeDataSaveFailed();
     }
+}
 
-
-    /* block_progress_notification */
-    else if (auto s = lt::alert_cast<lt::alerts_dropped_alert>(a)) {
-        Q_UNUSED(s) //  emit alerts_dropped_alert();
-        qWarning() << "Alert queue grew too big.";
-    }
-    else if (auto s = lt::alert_cast<lt::socks5_alert>(a)) {
-        Q_UNUSED(s) //  emit socks5_alert();
+void WorkerThread::handleSaveResumeDataFailed(lt::alert *a)
+{
+    auto s = static_cast<lt::save_resume_data_failed_alert*>(a);
+    if (m_pendingResumeData > 0) {
+        m_pendingResumeData--;
     }
-
-    else {
-        // if we didn't handle the alert, print it to the log
-        qWarning() << Q_FUNC_INFO << "didn't handle the alert (unkown/uncatched alert).";
+    if (s->error == lt::errors::resume_data_not_modified) {
+        return;
     }
+    qWarning() << "[alert]" << QString::fromStdString(s->message());
+    emit resumeDataSaveFailed();
 }
 
 /******************************************************************************
@@ -1695,14 +2363,19 @@ inline void WorkerThread::onTorrentAdded(const lt::torrent_handle &handle,
     if (error) {
         // Failed to add the torrent
 
+        // Note: the handle is invalid, the info-hash comes from the params
+        auto hash = params.ti ? params.ti->info_hash() : params.info_hashes.v1;
+
         TorrentData d;
-        d.unique_id = TorrentUtils::toUniqueId(handle.info_hash());
+        d.unique_id = TorrentUtils::toUniqueId(hash);
         d.metaInfo.error = TorrentError(TorrentError::FailedToAddError);
         d.metaInfo.error.message = QString::fromStdString(error.message());
         emit dataUpdated(d);
         return;
     }
 
+    // Emitted before dataUpdated(), so the handle is cached when the data arrives
+    emit torrentAdded(TorrentUtils::toUniqueId(handle.info_hash()), handle);
 
     signalizeDataUpdated(handle, params);
 }
@@ -1716,12 +2389,10 @@ inline void WorkerThread::onMetadataReceived(const lt::torrent_handle &handle)
     if (handle.is_valid()) {
 
         // set all the files priority to zero, to not download them
-        if (handle.torrent_file()) {
-            auto fileCount = handle.torrent_file()->num_files();
-            for (auto i = 0; i < fileCount; i++) {
-                auto findex = static_cast<lt::file_index_t>(i);
-                handle.file_priority(findex, lt::dont_download);
-            }
+        if (auto ti = handle.torrent_file()) {
+            std::vector<lt::download_priority_t> priorities(
+                        static_cast<std::size_t>(ti->num_files()), lt::dont_download);
+            handle.prioritize_files(priorities);
         }
         handle.pause();
 
@@ -1740,10 +2411,56 @@ inline void WorkerThread::onMetadataReceived(const lt::torrent_handle &handle)
 
 /******************************************************************************
  ******************************************************************************/
+/*!
+ * \brief Posts the statuses of the tick to the GUI thread, in one batch.
+ *
+ * A status that doesn't differ from the previously posted one is dropped:
+ * the GUI thread only works for the torrents that changed.
+ *
+ * The torrents that start seeding are handed over to libtorrent's queue,
+ * that limits the seeds to 'active_seeds'. Until then, the torrent
+ * is scheduled by the DownloadEngine, see TorrentContextPrivate::addTorrent().
+ */
 inline void WorkerThread::onStateUpdated(const std::vector<lt::torrent_status> &status)
 {
-    for (auto s : status) {
-        signalizeStatusUpdated(s);
+    TorrentStatusBatch batch;
+    batch.reserve(static_cast<qsizetype>(status.size()));
+    for (const auto &st : status) {
+        if (st.is_seeding
+                && !(st.flags & lt::torrent_flags::auto_managed)
+                && !(st.flags & lt::torrent_flags::paused)) {
+            st.handle.set_flags(lt::torrent_flags::auto_managed);
+        }
+        TorrentStatus s;
+        if (!toTorrentStatus(st, s)) {
+            continue;
+        }
+        auto it = m_postedStatuses.find(s.unique_id);
+        if (it == m_postedStatuses.end()) {
+            s.changes = TorrentStatus::InfoChanged | TorrentStatus::PiecesChanged;
+            if (s.hasDetail) {
+                s.changes |= TorrentStatus::DetailChanged;
+            }
+            m_postedStatuses.insert(s.unique_id, s);
+        } else {
+            s.changes = s.changesSince(it.value());
+            if (s.changes == TorrentStatus::NoChange) {
+                continue;
+            }
+            if (!s.hasDetail) {
+                /* Keep the detail that the GUI thread received last */
+                auto previous = it.value();
+                it.value() = s;
+                it.value().detail = previous.detail;
+                it.value().hasDetail = previous.hasDetail;
+            } else {
+                it.value() = s;
+            }
+        }
+        batch.append(s);
+    }
+    if (!batch.isEmpty()) {
+        emit statusUpdated(batch);
     }
 }
 
@@ -1769,17 +2486,24 @@ inline void WorkerThread::signalizeDataUpdated(const lt::torrent_handle &handle,
     emit dataUpdated(d);
 }
 
-inline void WorkerThread::signalizeStatusUpdated(const lt::torrent_status &status)
+inline bool WorkerThread::toTorrentStatus(const lt::torrent_status &status, TorrentStatus &s) const
 {
-    qDebug_2 << Q_FUNC_INFO;
     auto handle = status.handle;
     if (!handle.is_valid()) {
-        return;
+        return false;
     }
 
-    TorrentStatus s;
     s.unique_id = TorrentUtils::toUniqueId(handle.info_hash());
-    s.detail = TorrentUtils::toTorrentHandleInfo(handle);
+
+    /*
+     * The detail (files, peers, pieces...) requires several blocking calls
+     * to the libtorrent network thread: it's queried only for the torrents
+     * that a view displays. The other ones get the torrent_status fields only.
+     */
+    if (isSubscribed(s.unique_id)) {
+        s.detail = TorrentUtils::toTorrentHandleInfo(handle);
+        s.hasDetail = true;
+    }
 
     TorrentInfo t;
 
@@ -1865,6 +2589,8 @@ inline void WorkerThread::signalizeStatusUpdated(const lt::torrent_status &statu
 
     //  t.need_save_resume = state.need_save_resume;
 
+    t.isPaused                  = (status.flags & lt::torrent_flags::paused)
+                                    && !(status.flags & lt::torrent_flags::auto_managed);
     t.isSeeding                 = status.is_seeding;
     t.isFinished                = status.is_finished;
     t.hasMetadata               = status.has_metadata;
@@ -1888,7 +2614,7 @@ inline void WorkerThread::signalizeStatusUpdated(const lt::torrent_status &statu
     // t.flags = status.flags(); // see torrent flags
 
     s.info = t;
-    emit statusUpdated(s);
+    return true;
 }
 
 /******************************************************************************
@@ -2013,6 +2739,53 @@ TorrentInitialMetaInfo TorrentUtils::toTorrentInitialMetaInfo(std::shared_ptr<lt
     return m;
 }
 
+/*!
+ * \brief Returns the parameters to add the given magnet link
+ * in metadata-only mode.
+ *
+ * In upload mode, the torrent doesn't request any piece: it only downloads
+ * the metadata from the swarm. The files are prioritized once the metadata
+ * is received (see onMetadataReceived()), and the mode is left on resume.
+ *
+ * \remark Previously, a vector of 1,000,000 'dont_download' priorities
+ * was allocated for each magnet link, and kept until the metadata arrived.
+ */
+lt::add_torrent_params TorrentUtils::fromMagnetUri(const QString &uri, lt::error_code &ec)
+{
+    auto p = lt::parse_magnet_uri(uri.toLatin1().toStdString(), ec);
+    if (ec) {
+        return p;
+    }
+    p.file_priorities.clear();
+    p.flags |= lt::torrent_flags::upload_mode;
+    return p;
+}
+
+/*!
+ * \brief Sets the queue flags of a torrent being added to the session.
+ *
+ * The DownloadEngine decides when the torrent downloads: the torrent
+ * is added paused, and resumed by resumeTorrent(). libtorrent's queue
+ * mustn't pause it, so it's not auto-managed. Once finished, the torrent
+ * is handed over to libtorrent's queue, see WorkerThread::onStateUpdated().
+ *
+ * A magnet link that only fetches its metadata (upload mode, see
+ * fromMagnetUri()) is started at once: nothing else resumes it
+ * while the item is preparing.
+ */
+void TorrentUtils::setQueueFlags(lt::add_torrent_params &p)
+{
+    p.flags &= ~lt::torrent_flags::auto_managed;
+    auto isMetadataOnly = !p.ti && (p.flags & lt::torrent_flags::upload_mode);
+    if (isMetadataOnly) {
+        p.flags &= ~lt::torrent_flags::paused;
+    } else {
+        p.flags |= lt::torrent_flags::paused;
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
 TorrentHandleInfo TorrentUtils::toTorrentHandleInfo(const lt::torrent_handle &handle)
 {
     qDebug_2 << Q_FUNC_INFO;
@@ -2044,11 +2817,13 @@ TorrentHandleInfo TorrentUtils::toTorrentHandleInfo(const lt::torrent_handle &ha
                       static_cast<qsizetype>(progress.size()),
                       static_cast<qsizetype>(priorities.size()) });
 
+        // Built from the bulk snapshots above: no per-file call to the handle
+        t.files.reserve(count);
         for (auto index = 0; index < count; ++index) {
-            auto findex = static_cast<lt::file_index_t>(index);
+            auto i = static_cast<std::size_t>(index);
             TorrentFileInfo fi;
-            fi.bytesReceived = static_cast<qsizetype>(progress.at(static_cast<std::size_t>(index)));
-            fi.priority = toPriority(handle.file_priority(findex));
+            fi.bytesReceived = static_cast<qsizetype>(progress[i]);
+            fi.priority = toPriority(priorities[i]);
             t.files.append(fi);
         }
     }
@@ -2258,31 +3033,57 @@ QString TorrentUtils::toString(const lt::sha1_hash &hash)
     return {};
 }
 
+/*!
+ * \brief Lookup table that mirrors the bits of a byte.
+ */
+static constexpr std::array<uchar, 256> s_mirroredBytes = [] {
+    std::array<uchar, 256> table = {};
+    for (auto i = 0; i < 256; ++i) {
+        uchar mirrored = 0;
+        for (auto bit = 0; bit < 8; ++bit) {
+            if (i & (1 << bit)) {
+                mirrored |= static_cast<uchar>(0x80 >> bit);
+            }
+        }
+        table[static_cast<std::size_t>(i)] = mirrored;
+    }
+    return table;
+}();
+
+/*!
+ * \brief Converts the bitfield in bulk, instead of bit by bit.
+ *
+ * lt::bitfield stores the bits in network order (bit 0 is the MSB of
+ * the first byte), whereas QBitArray stores them LSB first.
+ * Hence each byte is mirrored with a lookup table,
+ * then the buffer is copied at once into the QBitArray.
+ */
 QBitArray TorrentUtils::toBitArray(const lt::typed_bitfield<lt::piece_index_t> &vec)
 {
     auto size = vec.size();
-    QBitArray ba(size, false);
-    for (auto i = 0; i < size; ++i) {
-        if (vec.get_bit(static_cast<lt::piece_index_t>(i))) {
-            ba.setBit(i);
-        }
+    if (size <= 0 || !vec.data()) {
+        return {};
     }
-    return ba;
+    auto byteCount = (size + 7) / 8;
+    QByteArray bytes(byteCount, Qt::Uninitialized);
+    auto src = reinterpret_cast<const uchar*>(vec.data());
+    auto dst = reinterpret_cast<uchar*>(bytes.data());
+    for (auto i = 0; i < byteCount; ++i) {
+        dst[i] = s_mirroredBytes[src[i]];
+    }
+    return QBitArray::fromBits(bytes.constData(), size);
 }
 
 QBitArray TorrentUtils::toBitArray(const std::map<lt::piece_index_t, lt::bitfield> &map)
 {
-    int size = 0;
-    QList<int> indexes;
-    for (auto kv : map) {
-        auto key = kv.first;
-        auto index = static_cast<int>(key);
-        indexes.append(index);
-        size = qMax(size, index);
+    if (map.empty()) {
+        return {};
     }
+    // std::map is sorted: the last key is the highest piece index
+    auto size = static_cast<int>(map.rbegin()->first) + 1;
     QBitArray ba(size, false);
-    for (auto index : indexes) {
-        ba.setBit(index);
+    for (const auto &kv : map) {
+        ba.setBit(static_cast<int>(kv.first));
     }
     return ba;
 }
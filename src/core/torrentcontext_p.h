@@ -19,29 +19,44 @@
 
 #include "torrentcontext.h"
 
+#include <Core/Settings>
 #include <Core/TorrentMessage>
 
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QObject>
 #include <QtCore/QThread>
 #include <QtCore/QMap>
+#include <QtCore/QMutex>
+#include <QtCore/QSet>
 
+#include <array>  // std::array
+#include <atomic> // std::atomic
+#include <cstdint> // std::int64_t
 #include <vector> // std::vector
 #include <ctime>  // std::time_t, definition required by MSVC 2017
 
 #include "libtorrent/fwd.hpp"
+#include "libtorrent/add_torrent_params.hpp" // lt::add_torrent_params
+#include "libtorrent/alert_types.hpp"   // lt::num_alert_types
 #include "libtorrent/bitfield.hpp"      // lt::typed_bitfield
 #include "libtorrent/error_code.hpp"    // lt::error_code
 #include "libtorrent/session_types.hpp" // lt::remove_flags_t
 #include "libtorrent/string_view.hpp"   // lt:string_view
 #include "libtorrent/sha1_hash.hpp"     // lt::sha1_hash
+#include "libtorrent/torrent_handle.hpp" // lt::torrent_handle
+
+/* Enable the type to be used in queued connections. */
+Q_DECLARE_METATYPE(lt::torrent_handle)
 
 class NetworkManager;
 class Settings;
 class Torrent;
+class TorrentSessionStatsModel;
 class WorkerThread;
 
 class QIODevice;
 class QNetworkReply;
+class QThreadPool;
 
 class TorrentContextPrivate : public QObject
 {  
@@ -55,6 +70,9 @@ public:
     QList<TorrentSettingItem> presetDefault() const;
     QList<TorrentSettingItem> presetMinCache() const;
     QList<TorrentSettingItem> presetHighPerf() const;
+    QList<TorrentSettingItem> presetNvme() const;
+    QList<TorrentSettingItem> presetHddArray() const;
+    QList<TorrentSettingItem> presetLowRam() const;
 
     void prepareTorrent(Torrent *torrent);
     void stopPrepare(Torrent *torrent);
@@ -97,36 +115,77 @@ public:
 
     void renameFile(Torrent *torrent, int index, const QString &newName);
 
+    void subscribe(Torrent *torrent);
+    void unsubscribe(Torrent *torrent);
+
+    void setStreamingEnabled(Torrent *torrent, bool enabled);
+    void setStreamingPosition(Torrent *torrent, int fileIndex, qint64 offset);
+
+    bool isVerboseAlertsEnabled() const;
+    void setVerboseAlertsEnabled(bool enabled);
+
+    void init(TorrentDiskIo diskIo, const QString &sessionStateFileName);
+
 public slots:
     void onSettingsChanged();
 
     void onStopped();
     void onMetadataUpdated(TorrentData data);
     void onDataUpdated(TorrentData data);
-    void onStatusUpdated(TorrentStatus status);
+    void onStatusUpdated(TorrentStatusBatch batch);
+    void onHandleAdded(UniqueId uuid, lt::torrent_handle handle);
+    void onHandleRemoved(UniqueId uuid);
+    void onTorrentChecked(UniqueId uuid);
+    void onSessionStatsUpdated(TorrentSessionStats stats);
 
 public:
     TorrentContext *q = nullptr;
     WorkerThread *workerThread = nullptr;
     Settings *settings = nullptr;
     NetworkManager *networkManager = nullptr;
+    TorrentSessionStatsModel *sessionStatsModel = nullptr;
     QHash<UniqueId, Torrent*> hashMap = {};
+    QHash<Torrent*, UniqueId> uuidMap = {}; // reverse of hashMap
+    QHash<UniqueId, lt::torrent_handle> handleMap = {}; // cached once added to the session
+    QSet<Torrent*> subscribers = {};
+    QHash<Torrent*, bool> pendingTorrents = {}; // being added, value is true if resume is requested
 
     inline Torrent *find(const UniqueId &uuid);
     inline lt::torrent_handle find(Torrent *torrent);
+    inline UniqueId uniqueId(Torrent *torrent) const;
+
+    void bind(const UniqueId &uuid, Torrent *torrent);
+    void unbind(Torrent *torrent);
 
 private slots:
     void onNetworkReplyFinished();
 
 private:
     QHash<QNetworkReply *, Torrent *> m_currentDownloads = {};
+    QThreadPool *m_preparePool = nullptr;
+    std::vector<lt::add_torrent_params> m_addQueue = {};
+
+    QList<Torrent*> m_recheckQueue = {};
+    QHash<Torrent*, QElapsedTimer> m_rechecks = {}; // being checked, with their start time
+    int m_maxConcurrentRechecks = 1; // see onSettingsChanged()
+
+    void startNextRechecks();
+    void startRecheck(Torrent *torrent);
+    void finishRecheck(Torrent *torrent);
+    void cancelRecheck(Torrent *torrent);
+
+    void onTorrentPrepared(Torrent *torrent, lt::add_torrent_params p, const QString &error);
+    void onTorrentFileSaved(Torrent *torrent, const TorrentInitialMetaInfo &initialMetaInfo);
+    void failTorrent(Torrent *torrent, const QString &message);
+
     void downloadMagnetLink(Torrent *torrent);
     void downloadTorrentFile(Torrent *torrent);
     void abortNetworkReply(Torrent *torrent);
 
-    void archiveExistingFile(const QString &filename);
+    static void archiveExistingFile(const QString &filename);
     void writeTorrentFile(const QString &filename, QIODevice *data);
-    void writeTorrentFileFromMagnet(const QString &filename, std::shared_ptr<lt::torrent_info const> ti);
+    static std::shared_ptr<lt::torrent_info const> writeTorrentFileFromMagnet(
+            const QString &filename, std::shared_ptr<lt::torrent_info const> ti);
     void readTorrentFile(const QString &filename, Torrent *torrent);
 
     void resetPriorities(Torrent *torrent);
@@ -144,7 +203,9 @@ class WorkerThread : public QThread
     Q_OBJECT
 
 public:
-    WorkerThread(QObject *parent = nullptr);
+    explicit WorkerThread(QObject *parent = nullptr);
+
+    void createSession(TorrentDiskIo diskIo, const QString &sessionStateFileName);
 
     void run() override;
     void stop();
@@ -155,17 +216,40 @@ public:
     bool isEnabled() const;
     void setEnabled(bool enabled);
 
-    lt::torrent_handle addTorrent(lt::add_torrent_params const& params, lt::error_code& ec);
+    void setIntervals(int statusMsecs, int sessionStatsMsecs, int dhtStatsMsecs);
+    void setResumeDataInterval(int msecs);
+
+    QString resumeDataPath() const;
+    void setResumeDataPath(const QString &path);
+
+    QString sessionStateFileName() const;
+    void setSessionStateFileName(const QString &fileName);
+
+    bool readResumeData(lt::add_torrent_params &params) const;
+
+    bool isVerboseAlertsEnabled() const;
+    void setVerboseAlertsEnabled(bool enabled);
+
+    void asyncAddTorrents(std::vector<lt::add_torrent_params> params);
     void removeTorrent(const lt::torrent_handle& h, lt::remove_flags_t options = {});
 
     lt::torrent_handle findTorrent(const UniqueId &uuid) const;
 
+    void subscribe(const UniqueId &uuid);
+    void unsubscribe(const UniqueId &uuid);
+
     TorrentInitialMetaInfo dump(const QString &filename) const;
 
 signals:
     void metadataUpdated(TorrentData data);
     void dataUpdated(TorrentData data);
-    void statusUpdated(TorrentStatus status);
+    void statusUpdated(TorrentStatusBatch batch);
+
+    void torrentAdded(UniqueId uuid, lt::torrent_handle handle);
+    void torrentRemoved(UniqueId uuid);
+    void torrentChecked(UniqueId uuid);
+
+    void sessionStatsUpdated(TorrentSessionStats stats);
 
     void resumeDataSaved();
     void resumeDataSaveFailed();
@@ -173,17 +257,59 @@ signals:
     void stopped();
 
 private:
-    bool shouldQuit = false;
+    std::atomic<bool> shouldQuit = false;
+    std::atomic<bool> m_enabled = false;
+    std::atomic<bool> m_verboseAlertsEnabled = false;
+    std::atomic<int> m_statusInterval;
+    std::atomic<int> m_sessionStatsInterval;
+    std::atomic<int> m_dhtStatsInterval;
+    std::atomic<int> m_resumeDataInterval;
+    std::atomic<int> m_pendingResumeData = 0;
     lt::session *m_session_ptr = nullptr;
 
+    std::vector<std::int64_t> m_previousCounters = {}; // for the deltas of the session stats
+    qint64 m_performanceWarnings = 0; // since the previous session stats
+    QString m_lastPerformanceWarning = {};
+
+    mutable QMutex m_subscriptionMutex;
+    QSet<UniqueId> m_subscriptions = {};
+    QHash<UniqueId, TorrentStatus> m_postedStatuses = {}; // last status posted to the GUI thread
+    bool isSubscribed(const UniqueId &uuid) const;
+
+    mutable QMutex m_pathMutex;
+    QString m_resumeDataPath = {};
+    QString m_sessionStateFileName = {};
+
+    QString resumeDataFileName(const UniqueId &uuid) const;
+    void requestResumeData(lt::session &session, bool flush);
+
+    static lt::session_params readSessionState(const QString &fileName);
+    void saveSessionState(lt::session &session);
+
+    using AlertHandler = void (WorkerThread::*)(lt::alert *a);
+    using AlertHandlers = std::array<AlertHandler, lt::num_alert_types>;
+    static const AlertHandlers& alertHandlers();
+
     void signalizeAlert(lt::alert* alert);
 
+    void handleAddTorrent(lt::alert *a);
+    void handleTorrentRemoved(lt::alert *a);
+    void handleTorrentChecked(lt::alert *a);
+    void handleStateUpdate(lt::alert *a);
+    void handleMetadataReceived(lt::alert *a);
+    void handleMetadataFailed(lt::alert *a);
+    void handlePerformanceWarning(lt::alert *a);
+    void handleSessionStats(lt::alert *a);
+    void handleAlertsDropped(lt::alert *a);
+    void handleSaveResumeData(lt::alert *a);
+    void handleSaveResumeDataFailed(lt::alert *a);
+
     inline void onTorrentAdded(const lt::torrent_handle &handle, const lt::add_torrent_params &params, const lt::error_code &error);
     inline void onMetadataReceived(const lt::torrent_handle &handle);
     inline void onStateUpdated(const std::vector<lt::torrent_status> &status);
 
     inline void signalizeDataUpdated(const lt::torrent_handle &handle, const lt::add_torrent_params &params);
-    inline void signalizeStatusUpdated(const lt::torrent_status &status);
+    inline bool toTorrentStatus(const lt::torrent_status &status, TorrentStatus &s) const;
     
     inline void log(lt::alert *s);
 };
@@ -202,6 +328,8 @@ public:
 
     static TorrentInitialMetaInfo toTorrentInitialMetaInfo(std::shared_ptr<lt::torrent_info const> ti);
     static TorrentMetaInfo toTorrentMetaInfo(const lt::add_torrent_params &params);
+    static lt::add_torrent_params fromMagnetUri(const QString &uri, lt::error_code &ec);
+    static void setQueueFlags(lt::add_torrent_params &p);
     static TorrentHandleInfo toTorrentHandleInfo(const lt::torrent_handle &handle);
 
     static QString toString(const std::string &str);
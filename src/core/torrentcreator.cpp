@@ -0,0 +1,238 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "torrentcreator.h"
+
+#include <QtCore/QDebug>
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "libtorrent/create_torrent.hpp"
+#include "libtorrent/error_code.hpp"
+#include "libtorrent/file_storage.hpp"
+#include "libtorrent/settings_pack.hpp"
+
+/* Thrown from the hash callback, to abort the hashing */
+struct TorrentCreatorCanceled : public std::exception
+{
+    const char* what() const noexcept override { return "canceled"; }
+};
+
+/*!
+ * \class TorrentCreator
+ *
+ * The class TorrentCreator creates a .torrent file from local files.
+ *
+ * The pieces are hashed by the libtorrent disk I/O subsystem,
+ * with one hashing thread per core by default, so the throughput
+ * scales with the cores until the disk becomes the bottleneck.
+ */
+
+TorrentCreator::TorrentCreator(QObject *parent) : QObject(parent)
+  , m_pool(new QThreadPool(this))
+{
+    m_pool->setMaxThreadCount(1);
+}
+
+TorrentCreator::~TorrentCreator()
+{
+    cancel();
+    m_pool->waitForDone();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+bool TorrentCreator::isRunning() const
+{
+    return m_running;
+}
+
+QString TorrentCreator::errorString() const
+{
+    return m_errorString;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \brief Creates the torrent in a background thread.
+ * The signal finished() is emitted when it's done, or canceled.
+ */
+void TorrentCreator::start(const Parameters &parameters)
+{
+    if (m_running) {
+        return;
+    }
+    m_running = true;
+    m_canceled = false;
+    m_errorString.clear();
+
+    m_pool->start([this, parameters]() {
+        /* Limit the notifications to the GUI thread */
+        auto lastNotified = -1;
+        auto callback = [this, &lastNotified](int piecesHashed, int pieceCount) {
+            auto step = qMax(1, pieceCount / 200);
+            if (piecesHashed == pieceCount || piecesHashed - lastNotified >= step) {
+                lastNotified = piecesHashed;
+                QMetaObject::invokeMethod(this, [this, piecesHashed, pieceCount]() {
+                    emit progress(piecesHashed, pieceCount);
+                }, Qt::QueuedConnection);
+            }
+        };
+        QString errorString;
+        auto success = create(parameters, callback, &m_canceled, &errorString);
+
+        QMetaObject::invokeMethod(this, [this, success, errorString]() {
+            m_errorString = errorString;
+            m_running = false;
+            emit finished(success);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void TorrentCreator::cancel()
+{
+    m_canceled = true;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+static lt::create_flags_t toCreateFlags(TorrentCreator::Mode mode)
+{
+    switch (mode) {
+    case TorrentCreator::Mode::V1: return lt::create_torrent::v1_only;
+    case TorrentCreator::Mode::V2: return lt::create_torrent::v2_only;
+    case TorrentCreator::Mode::Hybrid:
+    default:
+        return {};
+    }
+}
+
+static inline void setError(QString *errorString, const QString &message)
+{
+    if (errorString) {
+        *errorString = message;
+    }
+}
+
+/*!
+ * \brief Creates the torrent, in the calling thread.
+ *
+ * The \a progress callback is called from a libtorrent thread,
+ * after each hashed piece. Returns false on failure or cancellation.
+ */
+bool TorrentCreator::create(const Parameters &parameters,
+                            const ProgressCallback &progress,
+                            const std::atomic<bool> *canceled,
+                            QString *errorString)
+{
+    QFileInfo source(parameters.sourcePath);
+    if (!source.exists()) {
+        setError(errorString, tr("Can't find '%0'.").arg(parameters.sourcePath));
+        return false;
+    }
+    if (parameters.torrentFileName.isEmpty()) {
+        setError(errorString, tr("The torrent file name is empty."));
+        return false;
+    }
+
+    try {
+        auto flags = toCreateFlags(parameters.mode);
+
+        lt::file_storage fs;
+        auto path = QDir::toNativeSeparators(source.absoluteFilePath()).toStdString();
+        lt::add_files(fs, path, flags);
+        if (fs.num_files() == 0) {
+            setError(errorString, tr("There's no file to share in '%0'.").arg(parameters.sourcePath));
+            return false;
+        }
+
+        lt::create_torrent ct(fs, parameters.pieceSize, flags);
+
+        auto tier = 0;
+        for (const auto &tracker : parameters.trackers) {
+            ct.add_tracker(tracker.toStdString(), tier++);
+        }
+        for (const auto &webSeed : parameters.webSeeds) {
+            ct.add_url_seed(webSeed.toStdString());
+        }
+        if (!parameters.comment.isEmpty()) {
+            ct.set_comment(parameters.comment.toUtf8().constData());
+        }
+        if (!parameters.creator.isEmpty()) {
+            ct.set_creator(parameters.creator.toUtf8().constData());
+        }
+        ct.set_priv(parameters.isPrivate);
+
+        /*
+         * The disk I/O subsystem hashes several pieces at once,
+         * in parallel on the hashing threads.
+         */
+        auto threadCount = parameters.threadCount > 0
+                ? parameters.threadCount
+                : qMax(1, QThread::idealThreadCount());
+        lt::settings_pack settings;
+        settings.set_int(lt::settings_pack::hashing_threads, threadCount);
+        settings.set_int(lt::settings_pack::aio_threads, threadCount);
+
+        auto pieceCount = ct.num_pieces();
+        auto piecesHashed = 0;
+        auto parentPath = QDir::toNativeSeparators(source.absolutePath()).toStdString();
+        lt::error_code ec;
+        lt::set_piece_hashes(ct, parentPath, settings,
+                             [&](lt::piece_index_t) {
+            if (canceled && *canceled) {
+                throw TorrentCreatorCanceled();
+            }
+            piecesHashed++;
+            if (progress) {
+                progress(piecesHashed, pieceCount);
+            }
+        }, ec);
+        if (ec) {
+            setError(errorString, QString::fromStdString(ec.message()));
+            return false;
+        }
+
+        auto buffer = ct.generate_buf();
+
+        QSaveFile file(parameters.torrentFileName);
+        if (!file.open(QIODevice::WriteOnly)
+                || file.write(buffer.data(), static_cast<qint64>(buffer.size())) != static_cast<qint64>(buffer.size())
+                || !file.commit()) {
+            setError(errorString, tr("Can't save file '%0': %1").arg(
+                         parameters.torrentFileName, file.errorString()));
+            return false;
+        }
+
+    } catch (const TorrentCreatorCanceled &) {
+        setError(errorString, tr("Canceled."));
+        return false;
+
+    } catch (const std::exception &exception) {
+        qWarning() << "Caught exception" << QString::fromUtf8(exception.what());
+        setError(errorString, QString::fromUtf8(exception.what()));
+        return false;
+    }
+    return true;
+}
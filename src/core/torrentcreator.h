@@ -0,0 +1,81 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CORE_TORRENT_CREATOR_H
+#define CORE_TORRENT_CREATOR_H
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include <atomic>
+#include <functional>
+
+class QThreadPool;
+
+class TorrentCreator : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Mode {
+        Hybrid = 0, ///< BitTorrent v1 and v2
+        V1,
+        V2
+    };
+
+    struct Parameters
+    {
+        QString sourcePath = {};        ///< file or directory to share
+        QString torrentFileName = {};   ///< .torrent file to create
+        Mode mode = Mode::Hybrid;
+        int pieceSize = 0;              ///< in bytes, 0 means automatic
+        QStringList trackers = {};      ///< one tier per tracker
+        QStringList webSeeds = {};      ///< base URLs where the source is published (BEP 19)
+        QString comment = {};
+        QString creator = {};
+        bool isPrivate = false;
+        int threadCount = 0;            ///< hashing threads, 0 means one per core
+    };
+
+    using ProgressCallback = std::function<void(int piecesHashed, int pieceCount)>;
+
+    explicit TorrentCreator(QObject *parent = nullptr);
+    ~TorrentCreator() override;
+
+    bool isRunning() const;
+    QString errorString() const;
+
+    void start(const Parameters &parameters);
+    void cancel();
+
+    static bool create(const Parameters &parameters,
+                       const ProgressCallback &progress = {},
+                       const std::atomic<bool> *canceled = nullptr,
+                       QString *errorString = nullptr);
+
+signals:
+    void progress(int piecesHashed, int pieceCount);
+    void finished(bool success);
+
+private:
+    QThreadPool *m_pool = nullptr;
+    std::atomic<bool> m_canceled = false;
+    QString m_errorString = {};
+    bool m_running = false;
+};
+
+#endif // CORE_TORRENT_CREATOR_H
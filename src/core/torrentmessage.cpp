@@ -16,6 +16,8 @@
 
 #include "torrentmessage.h"
 
+#include <QtCore/QtMath>
+
 template<typename Enum>
 static inline void _q_set_flag(QFlags<Enum> *f, Enum flag, bool on = true)
 {
@@ -359,6 +361,57 @@ const char* TorrentInfo::torrentState_c_str() const
     Q_UNREACHABLE();
 }
 
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \brief Returns the Change flags between the \a previous status and this one.
+ */
+int TorrentStatus::changesSince(const TorrentStatus &previous) const
+{
+    int ret = NoChange;
+    if (info.downloadedPieces != previous.info.downloadedPieces
+            || info.verifiedPieces != previous.info.verifiedPieces) {
+        ret |= PiecesChanged;
+    }
+    /* Compare the other fields: the bit arrays are shared, not copied */
+    auto other = previous.info;
+    other.downloadedPieces = info.downloadedPieces;
+    other.verifiedPieces = info.verifiedPieces;
+    if (info != other) {
+        ret |= InfoChanged;
+    }
+    if (hasDetail && (!previous.hasDetail || detail != previous.detail)) {
+        ret |= DetailChanged;
+    }
+    return ret;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \brief Updates the checked bytes and the throughput, from the checking
+ * \a percent (between 0 and 100) reported by libtorrent.
+ */
+void TorrentRecheckInfo::update(qreal percent, qint64 elapsedMsecs)
+{
+    auto bytes = static_cast<qsizetype>(percent / 100 * static_cast<qreal>(bytesTotal));
+    bytesChecked = qBound(qsizetype(0), bytes, bytesTotal);
+    if (elapsedMsecs > 0) {
+        speed = 1000 * static_cast<qreal>(bytesChecked) / static_cast<qreal>(elapsedMsecs);
+    } else {
+        speed = 0;
+    }
+}
+
+QTime TorrentRecheckInfo::remainingTime() const
+{
+    if (speed > 0 && bytesChecked > 0 && bytesTotal > 0) {
+        auto estimatedTime = qCeil(static_cast<qreal>(bytesTotal - bytesChecked) / speed);
+        return QTime(0, 0, 0).addSecs(estimatedTime);
+    }
+    return {};
+}
+
 /******************************************************************************
  ******************************************************************************/
 TorrentNodeInfo::TorrentNodeInfo(const QString &_host, int _port)
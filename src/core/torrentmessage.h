@@ -395,6 +395,7 @@ public:
 
     int seedRank = 0;
 
+    bool isPaused = false; // by the user, not by libtorrent's queue
     bool isSeeding = false;
     bool isFinished = false;
     bool hasMetadata = false;
@@ -564,11 +565,77 @@ struct TorrentData
 
 struct TorrentStatus
 {
+    enum Change {
+        NoChange        = 0x00,
+        InfoChanged     = 0x01, // fields of the torrent_status, except the pieces
+        PiecesChanged   = 0x02, // downloaded or verified pieces
+        DetailChanged   = 0x04  // files, peers, trackers... (subscribed torrents only)
+    };
+
     auto operator<=>(const TorrentStatus&) const = default;
 
+    int changesSince(const TorrentStatus &previous) const;
+
     UniqueId unique_id = {};
     TorrentInfo info = {};
     TorrentHandleInfo detail = {};
+    bool hasDetail = false; // detail is queried for the subscribed torrents only
+    int changes = NoChange; // since the status previously posted to the GUI thread
+};
+
+/*!
+ * The changed statuses of a tick, posted at once to the GUI thread.
+ * QList is implicitly shared: the queued connection doesn't copy the statuses.
+ */
+using TorrentStatusBatch = QList<TorrentStatus>;
+
+/*!
+ * Progress of a forced recheck, see TorrentContext::forceRecheck().
+ */
+struct TorrentRecheckInfo
+{
+    enum State {
+        None = 0,
+        Queued,     // waiting for a recheck slot
+        Checking
+    };
+
+    auto operator<=>(const TorrentRecheckInfo&) const = default;
+
+    void update(qreal percent, qint64 elapsedMsecs);
+    QTime remainingTime() const;
+
+    State state = None;
+    qsizetype bytesChecked = 0;
+    qsizetype bytesTotal = 0;
+    qreal speed = 0; // bytes per second, since the recheck started
+};
+
+/*!
+ * Sample of the libtorrent session performance counters (session_stats_alert).
+ * The "since the previous sample" values are deltas of cumulative counters.
+ */
+struct TorrentSessionStats
+{
+    auto operator<=>(const TorrentSessionStats&) const = default;
+
+    QDateTime timestamp = {};
+
+    qint64 diskQueuedJobs = 0;          // disk.queued_disk_jobs
+    qint64 diskQueuedWriteBytes = 0;    // disk.queued_write_bytes
+    qint64 diskReadTime = 0;            // average time of a read job, in microseconds, since the previous sample
+    qint64 diskWriteTime = 0;           // average time of a write job, in microseconds, since the previous sample
+
+    qint64 pickerBusyLoops = 0;         // picker.piece_picker_busy_loops, since the previous sample
+
+    qint64 performanceWarnings = 0;     // performance_alert count, since the previous sample
+    QString lastPerformanceWarning = {};
+
+    qint64 uploadQueue = 0;             // net.limiter_up_queue: peers waiting for upload bandwidth
+    qint64 downloadQueue = 0;           // net.limiter_down_queue
+
+    qint64 connectedPeers = 0;          // peer.num_peers_connected
+    qint64 rejectedPeers = 0;           // peer.too_many_peers: disconnected at the connection limit, since the previous sample
 };
 
 /* Enable the type to be used with QVariant. */
@@ -576,5 +643,7 @@ Q_DECLARE_METATYPE(TorrentData)
 
 Q_DECLARE_METATYPE(TorrentStatus)
 
+Q_DECLARE_METATYPE(TorrentSessionStats)
+
 
 #endif // CORE_TORRENT_MESSAGE_H
@@ -0,0 +1,238 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "torrentsessionstatsmodel.h"
+
+#include <Constants>
+#include <Core/Format>
+
+#include <iterator> // std::size
+
+/*!
+ * \class TorrentSessionStatsModel
+ *
+ * The class TorrentSessionStatsModel keeps the last samples of the libtorrent
+ * session performance counters, one per row, as a time series.
+ * The oldest samples are removed beyond capacity().
+ *
+ * The series can be exported with toCsv(), to compare the settings offline.
+ */
+
+static const char *const s_csvColumns[] = {
+    "timestamp",
+    "disk_queued_jobs",
+    "disk_queued_write_bytes",
+    "disk_read_time_us",
+    "disk_write_time_us",
+    "picker_busy_loops",
+    "performance_warnings",
+    "last_performance_warning",
+    "upload_queue",
+    "download_queue",
+    "connected_peers",
+    "rejected_peers"
+};
+
+static const int s_columnCount = static_cast<int>(std::size(s_csvColumns));
+
+static QVariant value(const TorrentSessionStats &stats, int column)
+{
+    switch (column) {
+    case  0: return stats.timestamp;
+    case  1: return stats.diskQueuedJobs;
+    case  2: return stats.diskQueuedWriteBytes;
+    case  3: return stats.diskReadTime;
+    case  4: return stats.diskWriteTime;
+    case  5: return stats.pickerBusyLoops;
+    case  6: return stats.performanceWarnings;
+    case  7: return stats.lastPerformanceWarning;
+    case  8: return stats.uploadQueue;
+    case  9: return stats.downloadQueue;
+    case 10: return stats.connectedPeers;
+    case 11: return stats.rejectedPeers;
+    default:
+        break;
+    }
+    return {};
+}
+
+static QByteArray escapeCsv(const QString &text)
+{
+    auto field = text.toUtf8();
+    if (field.contains(',') || field.contains('"') || field.contains('\n')) {
+        field.replace("\"", "\"\"");
+        field.prepend('"');
+        field.append('"');
+    }
+    return field;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+TorrentSessionStatsModel::TorrentSessionStatsModel(QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_capacity(TORRENT_SESSION_STATS_HISTORY)
+{
+    retranslateUi();
+}
+
+void TorrentSessionStatsModel::retranslateUi()
+{
+    m_headers = QStringList()
+            << tr("Time")
+            << tr("Disk Queue")
+            << tr("Queued Writes")
+            << tr("Read Time (µs)")
+            << tr("Write Time (µs)")
+            << tr("Picker Stalls")
+            << tr("Warnings")
+            << tr("Last Warning")
+            << tr("Upload Queue")
+            << tr("Download Queue")
+            << tr("Peers")
+            << tr("Peers at Limit");
+    Q_ASSERT(m_headers.count() == s_columnCount);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+int TorrentSessionStatsModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(m_samples.count());
+}
+
+int TorrentSessionStatsModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : s_columnCount;
+}
+
+QVariant TorrentSessionStatsModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_samples.count()) {
+        return {};
+    }
+    const auto &stats = m_samples.at(index.row());
+    if (role == Qt::TextAlignmentRole) {
+        if (index.column() == 0 || index.column() == 7) {
+            return int(Qt::AlignLeft | Qt::AlignVCenter);
+        }
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+
+    } else if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case  0: return stats.timestamp.toLocalTime().toString(QLatin1String("hh:mm:ss"));
+        case  2: return Format::fileSizeToString(stats.diskQueuedWriteBytes);
+        default:
+            break;
+        }
+        return value(stats, index.column());
+    }
+    return {};
+}
+
+QVariant TorrentSessionStatsModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        if (section >= 0 && section < m_headers.count()) {
+            return m_headers.at(section);
+        }
+        return {};
+    }
+    return QAbstractItemModel::headerData(section, orientation, role);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+int TorrentSessionStatsModel::capacity() const
+{
+    return m_capacity;
+}
+
+void TorrentSessionStatsModel::setCapacity(int capacity)
+{
+    m_capacity = qMax(1, capacity);
+    removeOldest(static_cast<int>(m_samples.count()) - m_capacity);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+TorrentSessionStats TorrentSessionStatsModel::at(int row) const
+{
+    return m_samples.value(row);
+}
+
+/*!
+ * \brief Appends the given sample. The oldest sample is removed
+ * if the model is full.
+ */
+void TorrentSessionStatsModel::append(const TorrentSessionStats &stats)
+{
+    removeOldest(static_cast<int>(m_samples.count()) + 1 - m_capacity);
+    auto row = static_cast<int>(m_samples.count());
+    beginInsertRows(QModelIndex(), row, row);
+    m_samples.append(stats);
+    endInsertRows();
+}
+
+void TorrentSessionStatsModel::clear()
+{
+    beginResetModel();
+    m_samples.clear();
+    endResetModel();
+}
+
+void TorrentSessionStatsModel::removeOldest(int count)
+{
+    if (count <= 0) {
+        return;
+    }
+    beginRemoveRows(QModelIndex(), 0, count - 1);
+    m_samples.remove(0, count);
+    endRemoveRows();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \brief Returns the samples as comma-separated values, with a header line.
+ * The column names and the values are not localized,
+ * and the timestamps are in UTC (ISO 8601).
+ */
+QByteArray TorrentSessionStatsModel::toCsv() const
+{
+    QByteArray csv;
+    for (int column = 0; column < s_columnCount; ++column) {
+        if (column > 0) {
+            csv += ',';
+        }
+        csv += s_csvColumns[column];
+    }
+    csv += '\n';
+    for (const auto &stats : m_samples) {
+        for (int column = 0; column < s_columnCount; ++column) {
+            if (column > 0) {
+                csv += ',';
+            }
+            if (column == 0) {
+                csv += stats.timestamp.toUTC().toString(Qt::ISODateWithMs).toLatin1();
+            } else {
+                csv += escapeCsv(value(stats, column).toString());
+            }
+        }
+        csv += '\n';
+    }
+    return csv;
+}
@@ -0,0 +1,59 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CORE_TORRENT_SESSION_STATS_MODEL_H
+#define CORE_TORRENT_SESSION_STATS_MODEL_H
+
+#include <Core/TorrentMessage>
+
+#include <QtCore/QAbstractTableModel>
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <QtCore/QStringList>
+
+class TorrentSessionStatsModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit TorrentSessionStatsModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void retranslateUi();
+
+    int capacity() const;
+    void setCapacity(int capacity);
+
+    TorrentSessionStats at(int row) const;
+
+    void append(const TorrentSessionStats &stats);
+    void clear();
+
+    QByteArray toCsv() const;
+
+private:
+    QList<TorrentSessionStats> m_samples = {};
+    QStringList m_headers = {};
+    int m_capacity;
+
+    void removeOldest(int count);
+};
+
+#endif // CORE_TORRENT_SESSION_STATS_MODEL_H
@@ -0,0 +1,431 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "torrentstreamserver.h"
+
+#include <Constants>
+#include <Core/Torrent>
+#include <Core/TorrentBaseContext>
+
+#include <QtCore/QDebug>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QMimeDatabase>
+#include <QtCore/QUuid>
+#include <QtNetwork/QHostAddress>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+
+/*!
+ * \class TorrentStreamServer
+ *
+ * The class TorrentStreamServer serves the files of the torrents over HTTP,
+ * on the loopback interface, while they are being downloaded: a media player
+ * can open url() and start playing within seconds.
+ *
+ * Each torrent gets a random token in its URL, so that the other local
+ * processes can't enumerate the files.
+ *
+ * Range requests are supported, so the player can seek. The pieces that
+ * follow the requested position are prioritized with
+ * TorrentBaseContext::setStreamingPosition().
+ *
+ * When the requested bytes are not downloaded yet, the response waits:
+ * it's resumed each time the torrent changes.
+ */
+
+TorrentStreamServer::TorrentStreamServer(QObject *parent) : QObject(parent)
+  , m_server(new QTcpServer(this))
+{
+    connect(m_server, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+}
+
+TorrentStreamServer::~TorrentStreamServer()
+{
+    clear();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+TorrentBaseContext* TorrentStreamServer::torrentContext() const
+{
+    return m_context;
+}
+
+void TorrentStreamServer::setTorrentContext(TorrentBaseContext *context)
+{
+    m_context = context;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+bool TorrentStreamServer::isListening() const
+{
+    return m_server->isListening();
+}
+
+quint16 TorrentStreamServer::port() const
+{
+    return m_server->serverPort();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \brief Returns the URL of the file at \a fileIndex in the given \a torrent.
+ * The server starts listening if needed.
+ * Returns an invalid URL if the file doesn't exist or the server can't listen.
+ */
+QUrl TorrentStreamServer::url(Torrent *torrent, int fileIndex)
+{
+    if (!torrent) {
+        return {};
+    }
+    const auto files = torrent->metaInfo().initialMetaInfo.files;
+    if (fileIndex < 0 || fileIndex >= files.count()) {
+        return {};
+    }
+    if (!listen()) {
+        return {};
+    }
+    auto token = m_tokens.value(torrent);
+    if (token.isEmpty()) {
+        token = QUuid::createUuid().toString(QUuid::Id128);
+        m_tokens.insert(torrent, token);
+        m_torrents.insert(token, torrent);
+        connect(torrent, SIGNAL(changed()), this, SLOT(onTorrentChanged()));
+        connect(torrent, SIGNAL(destroyed(QObject*)), this, SLOT(onTorrentDestroyed(QObject*)));
+    }
+    QUrl url;
+    url.setScheme(QLatin1String("http"));
+    url.setHost(QHostAddress(QHostAddress::LocalHost).toString());
+    url.setPort(port());
+    url.setPath(QString("/%0/%1/%2").arg(token, QString::number(fileIndex), files.at(fileIndex).fileName));
+    return url;
+}
+
+/*!
+ * \brief Revokes the URLs of the given \a torrent, and closes its connections.
+ */
+void TorrentStreamServer::remove(Torrent *torrent)
+{
+    if (!torrent || !m_tokens.contains(torrent)) {
+        return;
+    }
+    disconnect(torrent, nullptr, this, nullptr);
+    m_torrents.remove(m_tokens.take(torrent));
+
+    const auto sockets = m_clients.keys();
+    for (auto socket : sockets) {
+        if (m_clients.value(socket).torrent == torrent) {
+            socket->abort();
+        }
+    }
+}
+
+void TorrentStreamServer::clear()
+{
+    for (auto it = m_tokens.constBegin(); it != m_tokens.constEnd(); ++it) {
+        disconnect(it.key(), nullptr, this, nullptr);
+    }
+    m_tokens.clear();
+    m_torrents.clear();
+
+    const auto sockets = m_clients.keys();
+    for (auto socket : sockets) {
+        socket->abort();
+    }
+    m_clients.clear();
+    m_server->close();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \brief Parses the \a value of a HTTP Range header (RFC 7233) for a file
+ * of the given \a size: "bytes=first-last", "bytes=first-" or "bytes=-suffix".
+ * Returns false if the range is invalid or can't be satisfied.
+ * \remark Multiple ranges are not supported.
+ */
+bool TorrentStreamServer::parseRange(const QByteArray &value, qint64 size, qint64 &first, qint64 &last)
+{
+    auto spec = value.trimmed();
+    if (size <= 0 || !spec.startsWith("bytes=")) {
+        return false;
+    }
+    spec = spec.mid(6);
+    if (spec.contains(',')) {
+        return false;
+    }
+    auto dash = spec.indexOf('-');
+    if (dash < 0) {
+        return false;
+    }
+    auto firstBytes = spec.left(dash).trimmed();
+    auto lastBytes = spec.mid(dash + 1).trimmed();
+    bool ok = false;
+    if (firstBytes.isEmpty()) {
+        auto suffix = lastBytes.toLongLong(&ok);
+        if (!ok || suffix <= 0) {
+            return false;
+        }
+        first = qMax<qint64>(0, size - suffix);
+        last = size - 1;
+        return true;
+    }
+    auto from = firstBytes.toLongLong(&ok);
+    if (!ok || from < 0 || from >= size) {
+        return false;
+    }
+    auto to = size - 1;
+    if (!lastBytes.isEmpty()) {
+        to = lastBytes.toLongLong(&ok);
+        if (!ok || to < from) {
+            return false;
+        }
+        to = qMin(to, size - 1);
+    }
+    first = from;
+    last = to;
+    return true;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+bool TorrentStreamServer::listen()
+{
+    if (m_server->isListening()) {
+        return true;
+    }
+    if (!m_server->listen(QHostAddress::LocalHost, 0)) {
+        qWarning() << "Can't start the stream server:" << m_server->errorString();
+        return false;
+    }
+    return true;
+}
+
+void TorrentStreamServer::onNewConnection()
+{
+    while (m_server->hasPendingConnections()) {
+        auto socket = m_server->nextPendingConnection();
+        m_clients.insert(socket, Client());
+        connect(socket, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+        connect(socket, SIGNAL(bytesWritten(qint64)), this, SLOT(onBytesWritten()));
+        connect(socket, SIGNAL(disconnected()), this, SLOT(onDisconnected()));
+    }
+}
+
+void TorrentStreamServer::onReadyRead()
+{
+    auto socket = qobject_cast<QTcpSocket*>(sender());
+    auto it = m_clients.find(socket);
+    if (it == m_clients.end()) {
+        return;
+    }
+    if (it->isStreaming) {
+        socket->readAll(); // One request per connection
+        return;
+    }
+    it->request.append(socket->readAll());
+    if (it->request.contains("\r\n\r\n")) {
+        handleRequest(socket, it.value());
+    } else if (it->request.size() > TORRENT_STREAMING_MAX_HEADER_BYTES) {
+        sendError(socket, 431, "Request Header Fields Too Large");
+    }
+}
+
+void TorrentStreamServer::onBytesWritten()
+{
+    pump(qobject_cast<QTcpSocket*>(sender()));
+}
+
+void TorrentStreamServer::onDisconnected()
+{
+    auto socket = qobject_cast<QTcpSocket*>(sender());
+    m_clients.remove(socket);
+    socket->deleteLater();
+}
+
+void TorrentStreamServer::onTorrentChanged()
+{
+    auto torrent = qobject_cast<Torrent*>(sender());
+    const auto sockets = m_clients.keys();
+    for (auto socket : sockets) {
+        if (m_clients.value(socket).torrent == torrent) {
+            pump(socket);
+        }
+    }
+}
+
+void TorrentStreamServer::onTorrentDestroyed(QObject *object)
+{
+    // Pending responses are closed by pump(), since their torrent is null
+    m_torrents.remove(m_tokens.take(static_cast<Torrent*>(object)));
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void TorrentStreamServer::handleRequest(QTcpSocket *socket, Client &client)
+{
+    auto header = client.request.left(client.request.indexOf("\r\n\r\n"));
+    auto lines = header.split('\n');
+    auto requestLine = lines.value(0).trimmed().split(' ');
+    if (requestLine.count() != 3) {
+        sendError(socket, 400, "Bad Request");
+        return;
+    }
+    auto method = requestLine.at(0);
+    if (method != "GET" && method != "HEAD") {
+        sendError(socket, 405, "Method Not Allowed", "Allow: GET, HEAD\r\n");
+        return;
+    }
+    auto path = QUrl::fromPercentEncoding(requestLine.at(1)).split('/', Qt::SkipEmptyParts);
+    Torrent *torrent = path.count() >= 2 ? m_torrents.value(path.at(0)).data() : nullptr;
+    bool ok = false;
+    auto fileIndex = path.value(1).toInt(&ok);
+    if (!torrent || !ok) {
+        sendError(socket, 404, "Not Found");
+        return;
+    }
+    const auto files = torrent->metaInfo().initialMetaInfo.files;
+    if (fileIndex < 0 || fileIndex >= files.count()) {
+        sendError(socket, 404, "Not Found");
+        return;
+    }
+    const auto &fileMetaInfo = files.at(fileIndex);
+    auto size = static_cast<qint64>(fileMetaInfo.bytesTotal);
+
+    QByteArray range;
+    for (const auto &line : lines.mid(1)) {
+        auto colon = line.indexOf(':');
+        if (colon > 0 && line.left(colon).trimmed().toLower() == "range") {
+            range = line.mid(colon + 1).trimmed();
+        }
+    }
+    qint64 first = 0;
+    qint64 last = size - 1;
+    auto isPartial = !range.isEmpty();
+    if (isPartial && !parseRange(range, size, first, last)) {
+        sendError(socket, 416, "Range Not Satisfiable",
+                  "Content-Range: bytes */" + QByteArray::number(size) + "\r\n");
+        return;
+    }
+
+    auto localFileName = QDir(torrent->localFilePath()).filePath(fileMetaInfo.filePath);
+    auto mimeType = QMimeDatabase().mimeTypeForFile(localFileName, QMimeDatabase::MatchExtension);
+
+    QByteArray response;
+    response += isPartial ? "HTTP/1.1 206 Partial Content\r\n" : "HTTP/1.1 200 OK\r\n";
+    response += "Content-Type: " + mimeType.name().toLatin1() + "\r\n";
+    response += "Content-Length: " + QByteArray::number(last - first + 1) + "\r\n";
+    if (isPartial) {
+        response += "Content-Range: bytes " + QByteArray::number(first)
+                + "-" + QByteArray::number(last)
+                + "/" + QByteArray::number(size) + "\r\n";
+    }
+    response += "Accept-Ranges: bytes\r\n";
+    response += "Connection: close\r\n";
+    response += "\r\n";
+    socket->write(response);
+
+    client.request.clear();
+    client.isStreaming = true;
+    if (method == "HEAD" || first > last) {
+        socket->disconnectFromHost();
+        return;
+    }
+    client.torrent = torrent;
+    client.fileIndex = fileIndex;
+    client.position = first;
+    client.end = last + 1;
+    client.file = new QFile(localFileName, socket);
+    prioritize(client, first);
+    pump(socket);
+}
+
+void TorrentStreamServer::sendError(QTcpSocket *socket, int statusCode,
+                                    const QByteArray &reason, const QByteArray &extraHeaders)
+{
+    QByteArray response;
+    response += "HTTP/1.1 " + QByteArray::number(statusCode) + " " + reason + "\r\n";
+    response += extraHeaders;
+    response += "Content-Length: 0\r\n";
+    response += "Connection: close\r\n";
+    response += "\r\n";
+    socket->write(response);
+    socket->disconnectFromHost();
+}
+
+/*!
+ * \brief Sends the downloaded bytes that follow the client position,
+ * without buffering more than a couple of chunks in the socket.
+ */
+void TorrentStreamServer::pump(QTcpSocket *socket)
+{
+    auto it = m_clients.find(socket);
+    if (it == m_clients.end() || !it->isStreaming || !it->file) {
+        return;
+    }
+    auto &client = it.value();
+    if (!client.torrent) {
+        socket->disconnectFromHost(); // Torrent removed
+        return;
+    }
+    while (client.position < client.end
+           && socket->bytesToWrite() < 2 * TORRENT_STREAMING_CHUNK_BYTES) {
+
+        auto available = client.torrent->availableBytes(client.fileIndex, client.position);
+        if (available <= 0) {
+            prioritize(client, client.position);
+            return; // Resumed by onTorrentChanged()
+        }
+        if (!client.file->isOpen() && !client.file->open(QIODevice::ReadOnly)) {
+            return; // Resumed by onTorrentChanged()
+        }
+        auto length = qMin(qMin(available, client.end - client.position), TORRENT_STREAMING_CHUNK_BYTES);
+        if (!client.file->seek(client.position)) {
+            return;
+        }
+        auto data = client.file->read(length);
+        if (data.isEmpty()) {
+            return; // Not flushed to the disk yet
+        }
+        socket->write(data);
+        client.position += data.size();
+
+        if (client.position >= client.prioritizedPosition + TORRENT_STREAMING_WINDOW_BYTES / 2) {
+            prioritize(client, client.position);
+        }
+    }
+    if (client.position >= client.end) {
+        socket->disconnectFromHost(); // Closed once the pending bytes are written
+    }
+}
+
+/*!
+ * \brief Moves the deadline window of the torrent to the given \a position,
+ * unless it's already there.
+ */
+void TorrentStreamServer::prioritize(Client &client, qint64 position)
+{
+    if (client.prioritizedPosition == position) {
+        return;
+    }
+    client.prioritizedPosition = position;
+    if (m_context && client.torrent) {
+        m_context->setStreamingPosition(client.torrent, client.fileIndex, position);
+    }
+}
@@ -0,0 +1,89 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CORE_TORRENT_STREAM_SERVER_H
+#define CORE_TORRENT_STREAM_SERVER_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+#include <QtCore/QString>
+#include <QtCore/QUrl>
+
+class Torrent;
+class TorrentBaseContext;
+
+class QFile;
+class QTcpServer;
+class QTcpSocket;
+
+class TorrentStreamServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TorrentStreamServer(QObject *parent = nullptr);
+    ~TorrentStreamServer() override;
+
+    TorrentBaseContext* torrentContext() const;
+    void setTorrentContext(TorrentBaseContext *context);
+
+    bool isListening() const;
+    quint16 port() const;
+
+    QUrl url(Torrent *torrent, int fileIndex);
+    void remove(Torrent *torrent);
+    void clear();
+
+    static bool parseRange(const QByteArray &value, qint64 size, qint64 &first, qint64 &last);
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+    void onBytesWritten();
+    void onDisconnected();
+    void onTorrentChanged();
+    void onTorrentDestroyed(QObject *object);
+
+private:
+    struct Client
+    {
+        QByteArray request = {};
+        QPointer<Torrent> torrent = {};
+        int fileIndex = -1;
+        QFile *file = nullptr; // owned by the socket
+        qint64 position = 0;   // next byte to send, in the file
+        qint64 end = 0;        // last byte to send, plus one
+        qint64 prioritizedPosition = -1;
+        bool isStreaming = false;
+    };
+
+    QTcpServer *m_server = nullptr;
+    TorrentBaseContext *m_context = nullptr;
+    QHash<QString, QPointer<Torrent>> m_torrents = {}; // by token
+    QHash<Torrent*, QString> m_tokens = {};
+    QHash<QTcpSocket*, Client> m_clients = {};
+
+    bool listen();
+    void handleRequest(QTcpSocket *socket, Client &client);
+    void sendError(QTcpSocket *socket, int statusCode, const QByteArray &reason,
+                   const QByteArray &extraHeaders = {});
+    void pump(QTcpSocket *socket);
+    void prioritize(Client &client, qint64 position);
+};
+
+#endif // CORE_TORRENT_STREAM_SERVER_H
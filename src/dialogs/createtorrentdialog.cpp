@@ -0,0 +1,272 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "createtorrentdialog.h"
+#include "ui_createtorrentdialog.h"
+
+#include <Constants>
+#include <Core/DownloadManager>
+#include <Core/DownloadTorrentItem>
+#include <Core/Format>
+#include <Core/ResourceItem>
+#include <Core/Torrent>
+#include <Core/TorrentCreator>
+#include <Core/TorrentMessage>
+#include <Widgets/PathWidget>
+
+#include <QtCore/QDebug>
+#include <QtCore/QDir>
+#include <QtCore/QDirIterator>
+#include <QtCore/QFileInfo>
+#include <QtWidgets/QFileDialog>
+#include <QtWidgets/QMessageBox>
+
+/*!
+ * \class CreateTorrentDialog
+ * \brief Creates a .torrent file from local files, and optionally
+ * starts seeding it right away, without checking the files again.
+ */
+CreateTorrentDialog::CreateTorrentDialog(DownloadManager *downloadManager, QWidget *parent)
+    : QDialog(parent)
+    , ui(new Ui::CreateTorrentDialog)
+    , m_downloadManager(downloadManager)
+    , m_creator(new TorrentCreator(this))
+{
+    ui->setupUi(this);
+
+    setWindowTitle(QString("%0 - %1").arg(STR_APPLICATION_NAME, tr("Create Torrent")));
+
+    ui->sourcePathWidget->setPathType(PathWidget::Directory);
+
+    ui->modeComboBox->addItem(tr("Hybrid (v1 and v2)"), int(TorrentCreator::Mode::Hybrid));
+    ui->modeComboBox->addItem(tr("v1 only"), int(TorrentCreator::Mode::V1));
+    ui->modeComboBox->addItem(tr("v2 only"), int(TorrentCreator::Mode::V2));
+
+    ui->pieceSizeComboBox->addItem(tr("Auto"), 0);
+    for (int size = 16 * 1024; size <= 16 * 1024 * 1024; size *= 2) {
+        ui->pieceSizeComboBox->addItem(Format::fileSizeToString(size), size);
+    }
+
+    connect(ui->sourcePathWidget, &PathWidget::currentPathChanged, this, &CreateTorrentDialog::onSourceChanged);
+    connect(ui->singleFileCheckBox, &QCheckBox::toggled, this, &CreateTorrentDialog::onSingleFileToggled);
+    connect(ui->torrentFileBrowseButton, &QToolButton::released, this, &CreateTorrentDialog::onTorrentFileBrowseButtonReleased);
+    connect(ui->createButton, &QPushButton::released, this, &CreateTorrentDialog::onCreateButtonReleased);
+    connect(ui->cancelButton, &QPushButton::released, this, &CreateTorrentDialog::reject);
+
+    connect(m_creator, &TorrentCreator::progress, this, &CreateTorrentDialog::onProgress);
+    connect(m_creator, &TorrentCreator::finished, this, &CreateTorrentDialog::onFinished);
+}
+
+CreateTorrentDialog::~CreateTorrentDialog()
+{
+    delete ui;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \brief Cancels the hashing first, if any, and closes the dialog
+ * once the hashing is stopped.
+ */
+void CreateTorrentDialog::reject()
+{
+    if (m_creator->isRunning()) {
+        m_isRejected = true;
+        m_creator->cancel();
+        return;
+    }
+    QDialog::reject();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void CreateTorrentDialog::onSourceChanged(const QString &path)
+{
+    if (path.isEmpty()) {
+        return;
+    }
+    QFileInfo fi(QDir::fromNativeSeparators(path));
+    auto fileName = QString("%0/%1.torrent").arg(fi.absolutePath(), fi.fileName());
+    ui->torrentFileLineEdit->setText(QDir::toNativeSeparators(fileName));
+}
+
+void CreateTorrentDialog::onSingleFileToggled(bool checked)
+{
+    ui->sourcePathWidget->setPathType(checked ? PathWidget::File : PathWidget::Directory);
+}
+
+void CreateTorrentDialog::onTorrentFileBrowseButtonReleased()
+{
+    auto fileName = QFileDialog::getSaveFileName(
+                this, tr("Save Torrent File"),
+                ui->torrentFileLineEdit->text(), tr("Torrent File (*.torrent)"));
+    if (!fileName.isEmpty()) {
+        ui->torrentFileLineEdit->setText(QDir::toNativeSeparators(fileName));
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void CreateTorrentDialog::onCreateButtonReleased()
+{
+    TorrentCreator::Parameters parameters;
+    parameters.sourcePath = QDir::fromNativeSeparators(ui->sourcePathWidget->currentPath());
+    parameters.torrentFileName = QDir::fromNativeSeparators(ui->torrentFileLineEdit->text());
+    parameters.mode = static_cast<TorrentCreator::Mode>(ui->modeComboBox->currentData().toInt());
+    parameters.pieceSize = ui->pieceSizeComboBox->currentData().toInt();
+    parameters.trackers = toLines(ui->trackersTextEdit->toPlainText());
+    parameters.webSeeds = toLines(ui->webSeedsTextEdit->toPlainText());
+    parameters.comment = ui->commentLineEdit->text();
+    parameters.creator = QString("%0 %1").arg(STR_APPLICATION_NAME, STR_APPLICATION_VERSION);
+    parameters.isPrivate = ui->privateCheckBox->isChecked();
+
+    if (!QFileInfo::exists(parameters.sourcePath)) {
+        QMessageBox::warning(this, tr("Error"), tr("Can't find '%0'.").arg(parameters.sourcePath));
+        return;
+    }
+    if (parameters.torrentFileName.isEmpty()) {
+        QMessageBox::warning(this, tr("Error"), tr("The torrent file name is empty."));
+        return;
+    }
+
+    m_totalBytes = totalSize(parameters.sourcePath);
+    m_elapsed.start();
+    ui->progressBar->setValue(0);
+    ui->progressLabel->clear();
+    setRunning(true);
+
+    m_creator->start(parameters);
+}
+
+/*!
+ * \brief Shows the hashing throughput and the remaining time.
+ */
+void CreateTorrentDialog::onProgress(int piecesHashed, int pieceCount)
+{
+    ui->progressBar->setMaximum(pieceCount);
+    ui->progressBar->setValue(piecesHashed);
+
+    if (pieceCount <= 0 || !m_elapsed.isValid()) {
+        return;
+    }
+    auto bytesHashed = qint64(double(m_totalBytes) * piecesHashed / pieceCount);
+    auto msecs = qMax(qint64(1), m_elapsed.elapsed());
+    auto speed = 1000.0 * double(bytesHashed) / double(msecs);
+    auto remaining = speed > 0 ? qint64(double(m_totalBytes - bytesHashed) / speed) : -1;
+
+    ui->progressLabel->setText(
+                tr("%0 of %1 (%2), %3 left").arg(
+                    Format::fileSizeToString(bytesHashed),
+                    Format::fileSizeToString(m_totalBytes),
+                    Format::currentSpeedToString(speed),
+                    Format::timeToString(remaining)));
+}
+
+void CreateTorrentDialog::onFinished(bool success)
+{
+    setRunning(false);
+    m_elapsed.invalidate();
+
+    if (m_isRejected) {
+        QDialog::reject();
+        return;
+    }
+    if (!success) {
+        ui->progressLabel->setText(m_creator->errorString());
+        QMessageBox::warning(this, tr("Error"), m_creator->errorString());
+        return;
+    }
+    if (ui->startSeedingCheckBox->isChecked()) {
+        startSeeding();
+    }
+    QDialog::accept();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void CreateTorrentDialog::setRunning(bool running)
+{
+    ui->sourcePathWidget->setEnabled(!running);
+    ui->singleFileCheckBox->setEnabled(!running);
+    ui->torrentFileLineEdit->setEnabled(!running);
+    ui->torrentFileBrowseButton->setEnabled(!running);
+    ui->modeComboBox->setEnabled(!running);
+    ui->pieceSizeComboBox->setEnabled(!running);
+    ui->trackersTextEdit->setEnabled(!running);
+    ui->webSeedsTextEdit->setEnabled(!running);
+    ui->commentLineEdit->setEnabled(!running);
+    ui->privateCheckBox->setEnabled(!running);
+    ui->startSeedingCheckBox->setEnabled(!running);
+    ui->createButton->setEnabled(!running);
+}
+
+/*!
+ * \brief Adds the new torrent to the queue, in seed mode:
+ * the files were just hashed, so libtorrent doesn't check them again.
+ */
+void CreateTorrentDialog::startSeeding()
+{
+    QFileInfo source(QDir::fromNativeSeparators(ui->sourcePathWidget->currentPath()));
+
+    auto resource = new ResourceItem();
+    resource->setUrl(QDir::fromNativeSeparators(ui->torrentFileLineEdit->text()));
+    resource->setDestination(source.absolutePath());
+    resource->setType(ResourceItem::Type::Torrent);
+
+    auto item = new DownloadTorrentItem(m_downloadManager);
+    item->setResource(resource);
+    item->torrent()->setSeedMode(true);
+
+    QList<TorrentWebSeedMetaInfo> webSeeds;
+    for (const auto &url : toLines(ui->webSeedsTextEdit->toPlainText())) {
+        TorrentWebSeedMetaInfo webSeed;
+        webSeed.url = url;
+        webSeed.type = TorrentWebSeedMetaInfo::UrlSeed;
+        webSeeds.append(webSeed);
+    }
+    item->torrent()->setPendingWebSeeds(webSeeds);
+
+    m_downloadManager->append(QList<IDownloadItem*>() << item, true);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+QStringList CreateTorrentDialog::toLines(const QString &text)
+{
+    QStringList lines;
+    for (const auto &line : text.split('\n', Qt::SkipEmptyParts)) {
+        auto trimmed = line.trimmed();
+        if (!trimmed.isEmpty()) {
+            lines.append(trimmed);
+        }
+    }
+    return lines;
+}
+
+qint64 CreateTorrentDialog::totalSize(const QString &path)
+{
+    QFileInfo fi(path);
+    if (fi.isFile()) {
+        return fi.size();
+    }
+    qint64 size = 0;
+    QDirIterator it(path, QDir::Files | QDir::Hidden | QDir::NoSymLinks, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        size += it.fileInfo().size();
+    }
+    return size;
+}
@@ -0,0 +1,64 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DIALOGS_CREATE_TORRENT_DIALOG_H
+#define DIALOGS_CREATE_TORRENT_DIALOG_H
+
+#include <QtCore/QElapsedTimer>
+#include <QtWidgets/QDialog>
+
+class DownloadManager;
+class TorrentCreator;
+
+namespace Ui {
+class CreateTorrentDialog;
+}
+
+class CreateTorrentDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit CreateTorrentDialog(DownloadManager *downloadManager, QWidget *parent = nullptr);
+    ~CreateTorrentDialog() override;
+
+public slots:
+    void reject() override;
+
+private slots:
+    void onSourceChanged(const QString &path);
+    void onSingleFileToggled(bool checked);
+    void onTorrentFileBrowseButtonReleased();
+    void onCreateButtonReleased();
+    void onProgress(int piecesHashed, int pieceCount);
+    void onFinished(bool success);
+
+private:
+    Ui::CreateTorrentDialog *ui = nullptr;
+    DownloadManager *m_downloadManager = nullptr;
+    TorrentCreator *m_creator = nullptr;
+    QElapsedTimer m_elapsed = {};
+    qint64 m_totalBytes = 0;
+    bool m_isRejected = false;
+
+    void setRunning(bool running);
+    void startSeeding();
+
+    static QStringList toLines(const QString &text);
+    static qint64 totalSize(const QString &path);
+};
+
+#endif // DIALOGS_CREATE_TORRENT_DIALOG_H
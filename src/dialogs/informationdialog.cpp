@@ -19,6 +19,7 @@
 
 #include <Constants>
 #include <Core/DownloadItem>
+#include <Core/DownloadTiming>
 #include <Core/Format>
 #include <Core/IDownloadItem>
 #include <Core/MimeDatabase>
@@ -27,8 +28,12 @@
 #include <Widgets/UrlFormWidget>
 
 #include <QtCore/QDir>
+#include <QtCore/QFile>
 #include <QtCore/QScopedPointer>
 #include <QtCore/QSettings>
+#include <QtCore/QTextStream>
+#include <QtWidgets/QFileDialog>
+#include <QtWidgets/QMessageBox>
 
 InformationDialog::InformationDialog(const QList<IDownloadItem *> &jobs, QWidget *parent)
     : QDialog(parent)
@@ -45,6 +50,7 @@ InformationDialog::InformationDialog(const QList<IDownloadItem *> &jobs, QWidget
     ui->logTextEdit->setLineWrapMode(QPlainTextEdit::NoWrap);
 
     connect(ui->wrapCheckBox, SIGNAL(toggled(bool)), this, SLOT(wrapLog(bool)));
+    connect(ui->exportTimingButton, SIGNAL(released()), this, SLOT(exportTiming()));
 
     initialize(jobs);
     readUiSettings();
@@ -148,9 +154,85 @@ void InformationDialog::initialize(const QList<IDownloadItem *> &items)
         ui->logTextEdit->setTextCursor(cursor);
         ui->logTextEdit->ensureCursorVisible();
     }
+
+    /* Timing */
+    initializeTiming(downloadItem);
+}
+
+void InformationDialog::initializeTiming(const DownloadItem *downloadItem)
+{
+    ui->timingTableWidget->setColumnCount(2);
+    ui->timingTableWidget->setHorizontalHeaderLabels({ tr("Phase"), tr("Duration") });
+    ui->exportTimingButton->setEnabled(false);
+    for (auto item : std::as_const(m_items)) {
+        auto other = dynamic_cast<const DownloadItem*>(item);
+        if (other && !other->timing().isEmpty()) {
+            ui->exportTimingButton->setEnabled(true);
+            break;
+        }
+    }
+
+    if (!downloadItem || downloadItem->timing().isEmpty()) {
+        ui->timingInfoLabel->setText(tr("No timing information: the download has not started yet."));
+        ui->timingTableWidget->setRowCount(0);
+        return;
+    }
+    auto timing = downloadItem->timing();
+    auto info = tr("Host: %0").arg(timing.host());
+    if (timing.isConnectionReused()) {
+        info += QLatin1String(" - ") + tr("connection reused");
+    } else if (timing.isEncrypted()) {
+        info += QLatin1String(" - ") + tr("encrypted connection (Connect includes the TLS handshake)");
+    }
+    ui->timingInfoLabel->setText(info);
+
+    ui->timingTableWidget->setRowCount(DownloadTiming::PhaseCount + 1);
+    for (int i = 0; i < DownloadTiming::PhaseCount; ++i) {
+        auto phase = static_cast<DownloadTiming::Phase>(i);
+        auto text = timing.isMeasured(phase)
+                ? tr("%0 ms").arg(QString::number(timing.duration(phase)))
+                : QString("-");
+        ui->timingTableWidget->setItem(i, 0, new QTableWidgetItem(DownloadTiming::phaseName(phase)));
+        ui->timingTableWidget->setItem(i, 1, new QTableWidgetItem(text));
+    }
+    auto totalText = tr("%0 ms").arg(QString::number(timing.total()));
+    ui->timingTableWidget->setItem(DownloadTiming::PhaseCount, 0, new QTableWidgetItem(tr("Total")));
+    ui->timingTableWidget->setItem(DownloadTiming::PhaseCount, 1, new QTableWidgetItem(totalText));
+    ui->timingTableWidget->resizeColumnToContents(0);
 }
 
 void InformationDialog::wrapLog(bool enabled)
 {
     ui->logTextEdit->setLineWrapMode(enabled ? QPlainTextEdit::WidgetWidth : QPlainTextEdit::NoWrap);
 }
+
+/*!
+ * \brief Exports the timing of all the selected downloads, aggregated by host,
+ * to find the slow hosts.
+ */
+void InformationDialog::exportTiming()
+{
+    QList<DownloadTiming> timings;
+    for (auto item : std::as_const(m_items)) {
+        auto downloadItem = dynamic_cast<const DownloadItem*>(item);
+        if (downloadItem) {
+            timings.append(downloadItem->timing());
+        }
+    }
+    auto path = QFileDialog::getSaveFileName(
+                this, tr("Export Timing"), QDir::currentPath(),
+                tr("CSV file (*.csv);;All files (*.*)"));
+    if (path.isEmpty()) {
+        return;
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+        QMessageBox::warning(this, tr("Error"),
+                             QString("%0\n%1").arg(
+                                 tr("Can't save file %0:").arg(path),
+                                 file.errorString()));
+        return;
+    }
+    QTextStream out(&file);
+    out << DownloadTiming::toCsv(timings);
+}
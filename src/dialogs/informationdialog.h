@@ -20,6 +20,7 @@
 #include <QtCore/QList>
 #include <QtWidgets/QDialog>
 
+class DownloadItem;
 class IDownloadItem;
 
 namespace Ui {
@@ -38,12 +39,14 @@ public slots:
 
 private slots:
     void wrapLog(bool enabled);
+    void exportTiming();
 
 private:
     Ui::InformationDialog *ui = nullptr;
     QList<IDownloadItem *> m_items = {};
 
     void initialize(const QList<IDownloadItem*> &items);
+    void initializeTiming(const DownloadItem *downloadItem);
 
     void readUiSettings();
     void writeUiSettings();
@@ -556,9 +556,14 @@ void PreferenceDialog::read()
     ui->torrentShareFolderCheckBox->setChecked(m_settings->isTorrentShareFolderEnabled());
     ui->torrentShareFolderPathWidget->setCurrentPath(m_settings->shareFolder());
     ui->torrentPeersPlainTextEdit->setPlainText(m_settings->torrentPeers());
+    ui->torrentMaxSimultaneousSpinBox->setValue(m_settings->maxSimultaneousTorrents());
+    ui->torrentRechecksSpinBox->setValue(m_settings->concurrentTorrentRechecks());
+    ui->torrentRecheckBudgetSpinBox->setValue(m_settings->torrentRecheckBudget());
 
     // Tab Advanced
     ui->advancedSettingsWidget->setTorrentSettings(m_settings->torrentSettings());
+    ui->advancedSettingsWidget->setDiskIo(m_settings->torrentDiskIo());
+    ui->advancedSettingsWidget->setDiskBenchmarkPath(m_settings->shareFolder());
 }
 
 void PreferenceDialog::write()
@@ -639,9 +644,13 @@ void PreferenceDialog::write()
     m_settings->setTorrentShareFolderEnabled(ui->torrentShareFolderCheckBox->isChecked());
     m_settings->setShareFolder(ui->torrentShareFolderPathWidget->currentPath());
     m_settings->setTorrentPeers(ui->torrentPeersPlainTextEdit->toPlainText());
+    m_settings->setMaxSimultaneousTorrents(ui->torrentMaxSimultaneousSpinBox->value());
+    m_settings->setConcurrentTorrentRechecks(ui->torrentRechecksSpinBox->value());
+    m_settings->setTorrentRecheckBudget(ui->torrentRecheckBudgetSpinBox->value());
 
     // Tab Advanced
     m_settings->setTorrentSettings(ui->advancedSettingsWidget->torrentSettings());
+    m_settings->setTorrentDiskIo(ui->advancedSettingsWidget->diskIo());
 }
 
 /******************************************************************************
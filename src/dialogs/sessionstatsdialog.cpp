@@ -0,0 +1,103 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sessionstatsdialog.h"
+#include "ui_sessionstatsdialog.h"
+
+#include <Constants>
+#include <Core/TorrentSessionStatsModel>
+
+#include <QtCore/QDebug>
+#include <QtCore/QDir>
+#include <QtCore/QSaveFile>
+#include <QtWidgets/QFileDialog>
+#include <QtWidgets/QMessageBox>
+#include <QtWidgets/QScrollBar>
+
+/*!
+ * \class SessionStatsDialog
+ * \brief Shows the performance counters of the torrent session,
+ * as they're sampled, and exports them to CSV.
+ */
+SessionStatsDialog::SessionStatsDialog(TorrentSessionStatsModel *model, QWidget *parent)
+    : QDialog(parent)
+    , ui(new Ui::SessionStatsDialog)
+    , m_model(model)
+{
+    ui->setupUi(this);
+
+    setWindowTitle(QString("%0 - %1").arg(STR_APPLICATION_NAME, tr("Torrent Session Statistics")));
+
+    ui->tableView->setModel(m_model);
+    ui->tableView->resizeColumnsToContents();
+    ui->tableView->scrollToBottom();
+
+    connect(m_model, &QAbstractItemModel::rowsAboutToBeInserted, this, &SessionStatsDialog::onRowsAboutToBeInserted);
+    connect(m_model, &QAbstractItemModel::rowsInserted, this, &SessionStatsDialog::onRowsInserted);
+
+    connect(ui->exportButton, &QPushButton::released, this, &SessionStatsDialog::onExportButtonReleased);
+    connect(ui->okButton, &QPushButton::released, this, &SessionStatsDialog::onOkButtonReleased);
+}
+
+SessionStatsDialog::~SessionStatsDialog()
+{
+    delete ui;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \brief Follows the new samples, unless the user scrolled up.
+ */
+void SessionStatsDialog::onRowsAboutToBeInserted()
+{
+    auto scrollBar = ui->tableView->verticalScrollBar();
+    m_isFollowingLastRow = scrollBar->value() == scrollBar->maximum();
+}
+
+void SessionStatsDialog::onRowsInserted()
+{
+    if (m_isFollowingLastRow) {
+        ui->tableView->scrollToBottom();
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void SessionStatsDialog::onExportButtonReleased()
+{
+    auto fileName = QFileDialog::getSaveFileName(
+                this, tr("Export Statistics"),
+                QDir::currentPath(), tr("CSV File (*.csv)"));
+    if (fileName.isEmpty()) {
+        return;
+    }
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)
+            || file.write(m_model->toCsv()) < 0
+            || !file.commit()) {
+        qWarning() << tr("Can't save file.");
+        QMessageBox::warning(this, tr("Error"),
+                             QString("%0\n%1").arg(
+                                 tr("Can't save file %0:").arg(fileName),
+                                 file.errorString()));
+    }
+}
+
+void SessionStatsDialog::onOkButtonReleased()
+{
+    QDialog::accept();
+}
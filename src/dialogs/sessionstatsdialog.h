@@ -0,0 +1,48 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DIALOGS_SESSION_STATS_DIALOG_H
+#define DIALOGS_SESSION_STATS_DIALOG_H
+
+#include <QtWidgets/QDialog>
+
+class TorrentSessionStatsModel;
+
+namespace Ui {
+class SessionStatsDialog;
+}
+
+class SessionStatsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit SessionStatsDialog(TorrentSessionStatsModel *model, QWidget *parent = nullptr);
+    ~SessionStatsDialog() override;
+
+private slots:
+    void onRowsAboutToBeInserted();
+    void onRowsInserted();
+    void onExportButtonReleased();
+    void onOkButtonReleased();
+
+private:
+    Ui::SessionStatsDialog *ui = nullptr;
+    TorrentSessionStatsModel *m_model = nullptr;
+    bool m_isFollowingLastRow = true;
+};
+
+#endif // DIALOGS_SESSION_STATS_DIALOG_H
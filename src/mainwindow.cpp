@@ -40,10 +40,12 @@
 #include <Dialogs/AddUrlsDialog>
 #include <Dialogs/BatchRenameDialog>
 #include <Dialogs/CompilerDialog>
+#include <Dialogs/CreateTorrentDialog>
 #include <Dialogs/EditionDialog>
 #include <Dialogs/HomeDialog>
 #include <Dialogs/InformationDialog>
 #include <Dialogs/PreferenceDialog>
+#include <Dialogs/SessionStatsDialog>
 #include <Dialogs/StreamDialog>
 #include <Dialogs/TutorialDialog>
 #include <Dialogs/UpdateDialog>
@@ -57,6 +59,7 @@
 #include <QtCore/QDebug>
 #include <QtCore/QDir>
 #include <QtCore/QFile>
+#include <QtCore/QFileInfo>
 #include <QtCore/QTimer>
 #include <QtCore/QMimeData>
 #include <QtCore/QSettings>
@@ -164,6 +167,11 @@ MainWindow::MainWindow(QWidget *parent): QMainWindow(parent)
 
     readSettings();
 
+    /* The session is created with the stored disk I/O backend and state */
+    torrentContext.init(m_settings->torrentDiskIo(),
+                        QDir(QFileInfo(m_settings->database()).absolutePath())
+                        .filePath("torrent-session.dat"));
+
     refreshTitleAndStatus();
     refreshMenus();
 
@@ -270,6 +278,8 @@ void MainWindow::createActions()
     connect(ui->actionAddTorrent, SIGNAL(triggered()), this, SLOT(addTorrent()));
     connect(ui->actionAddUrls,    SIGNAL(triggered()), this, SLOT(addUrls()));
     // --
+    connect(ui->actionCreateTorrent, SIGNAL(triggered()), this, SLOT(createTorrent()));
+    // --
     connect(ui->actionImportFromFile, SIGNAL(triggered()), this, SLOT(importFromFile()));
     connect(ui->actionExportSelectedToFile, SIGNAL(triggered()), this, SLOT(exportSelectedToFile()));
     // --
@@ -323,6 +333,7 @@ void MainWindow::createActions()
     connect(ui->actionSpeedLimit, SIGNAL(triggered()), this, SLOT(speedLimit()));
     //--
     connect(ui->actionForceStart, SIGNAL(triggered()), this, SLOT(forceStart()));
+    connect(ui->actionForceRecheck, SIGNAL(triggered()), this, SLOT(forceRecheck()));
     //--
     connect(ui->actionPreferences, SIGNAL(triggered()), this, SLOT(showPreferences()));
     //! [4]
@@ -341,6 +352,7 @@ void MainWindow::createActions()
 
     connect(ui->actionAboutCompiler, SIGNAL(triggered()), this, SLOT(aboutCompiler()));
     connect(ui->actionAboutYTDLP, SIGNAL(triggered()), this, SLOT(aboutStream()));
+    connect(ui->actionSessionStats, SIGNAL(triggered()), this, SLOT(showSessionStats()));
     //! [5]
 
     propagateToolTips();
@@ -398,6 +410,7 @@ void MainWindow::createContextMenu()
     advanced->addAction(ui->actionOneFewerSegment);
     advanced->addSeparator();
     advanced->addAction(ui->actionForceStart);
+    advanced->addAction(ui->actionForceRecheck);
     advanced->addSeparator();
     advanced->addAction(ui->actionImportFromFile);
     advanced->addAction(ui->actionExportSelectedToFile);
@@ -507,7 +520,8 @@ void MainWindow::propagateIcons()
         {ui->actionAbout                  , "about"}
         // {ui->actionAboutQt                , ""},
         // {ui->actionAboutCompiler          , ""},
-        // {ui->actionAboutYTDLP             , ""}
+        // {ui->actionAboutYTDLP             , ""},
+        // {ui->actionSessionStats           , ""}
         //! [5]
     };
     Theme::setIcons(this, hash);
@@ -915,6 +929,12 @@ void MainWindow::addTorrent(const QUrl &url)
     dialog.exec();
 }
 
+void MainWindow::createTorrent()
+{
+    CreateTorrentDialog dialog(m_downloadManager, this);
+    dialog.exec();
+}
+
 /******************************************************************************
  ******************************************************************************/
 void MainWindow::addUrls()
@@ -985,6 +1005,16 @@ void MainWindow::forceStart()
     }
 }
 
+void MainWindow::forceRecheck()
+{
+    for (auto item : m_downloadManager->selection()) {
+        auto torrentItem = dynamic_cast<DownloadTorrentItem*>(item);
+        if (torrentItem) {
+            TorrentContext::getInstance().forceRecheck(torrentItem->torrent());
+        }
+    }
+}
+
 void MainWindow::showPreferences()
 {
     if (!this->isVisible()) {
@@ -1031,6 +1061,12 @@ void MainWindow::aboutStream()
     dialog.exec();
 }
 
+void MainWindow::showSessionStats()
+{
+    SessionStatsDialog dialog(TorrentContext::getInstance().sessionStatsModel(), this);
+    dialog.exec();
+}
+
 /******************************************************************************
  ******************************************************************************/
 void MainWindow::onJobAddedOrRemoved(const DownloadRange &/*range*/)
@@ -1231,6 +1267,7 @@ void MainWindow::refreshMenus()
     ui->actionSpeedLimit->setEnabled(hasSelection);
     //--
     ui->actionForceStart->setEnabled(hasSelection);
+    ui->actionForceRecheck->setEnabled(hasSelection);
     //--
     //ui->actionPreferences->setEnabled(hasSelection);
     //! [4]
@@ -106,6 +106,7 @@ public slots:
     void addStream(const QUrl &url);
     void addTorrent();
     void addTorrent(const QUrl &url);
+    void createTorrent();
     void addUrls();
     void addUrls(const QString &text);
     void resume();
@@ -119,6 +120,7 @@ public slots:
     // Options
     void speedLimit();
     void forceStart();
+    void forceRecheck();
     void showPreferences();
 
     // Help
@@ -128,6 +130,7 @@ public slots:
     void about();
     void aboutCompiler();
     void aboutStream();
+    void showSessionStats();
 
 private slots:
     void onJobAddedOrRemoved(const DownloadRange &range);
@@ -17,6 +17,8 @@
 #include "advancedsettingswidget.h"
 #include "ui_advancedsettingswidget.h"
 
+#include <Core/DiskBenchmark>
+#include <Core/Format>
 #include <Core/Theme>
 #include <Core/TorrentContext>
 
@@ -26,6 +28,7 @@
 #include <QtGui/QBrush>
 #include <QtGui/QFont>
 #include <QtWidgets/QCheckBox>
+#include <QtWidgets/QComboBox>
 #include <QtWidgets/QLineEdit>
 #include <QtWidgets/QMenu>
 #include <QtWidgets/QPushButton>
@@ -36,12 +39,19 @@
 
 AdvancedSettingsWidget::AdvancedSettingsWidget(QWidget *parent) : QWidget(parent)
   , ui(new Ui::AdvancedSettingsWidget)
+  , m_diskBenchmark(new DiskBenchmark(this))
 {
     ui->setupUi(this);
 
     connect(ui->presetDefaultButton, &QPushButton::released, this, &AdvancedSettingsWidget::setPresetDefault);
     connect(ui->presetMinCacheButton, &QPushButton::released, this, &AdvancedSettingsWidget::setPresetMinCache);
     connect(ui->presetHighPerfButton, &QPushButton::released, this, &AdvancedSettingsWidget::setPresetHighPerf);
+    connect(ui->presetNvmeButton, &QPushButton::released, this, &AdvancedSettingsWidget::setPresetNvme);
+    connect(ui->presetHddArrayButton, &QPushButton::released, this, &AdvancedSettingsWidget::setPresetHddArray);
+    connect(ui->presetLowRamButton, &QPushButton::released, this, &AdvancedSettingsWidget::setPresetLowRam);
+
+    connect(ui->diskBenchmarkButton, &QPushButton::released, this, &AdvancedSettingsWidget::startDiskBenchmark);
+    connect(m_diskBenchmark, &DiskBenchmark::finished, this, &AdvancedSettingsWidget::onDiskBenchmarkFinished);
 
     connect(ui->searchLineEdit, &QLineEdit::textChanged, this, &AdvancedSettingsWidget::setFilter);
     connect(ui->searchClearToolButton, &QToolButton::released, ui->searchLineEdit, &QLineEdit::clear);
@@ -251,6 +261,21 @@ void AdvancedSettingsWidget::setPresetHighPerf()
     setPreset(TorrentContext::getInstance().presetHighPerf());
 }
 
+void AdvancedSettingsWidget::setPresetNvme()
+{
+    setPreset(TorrentContext::getInstance().presetNvme());
+}
+
+void AdvancedSettingsWidget::setPresetHddArray()
+{
+    setPreset(TorrentContext::getInstance().presetHddArray());
+}
+
+void AdvancedSettingsWidget::setPresetLowRam()
+{
+    setPreset(TorrentContext::getInstance().presetLowRam());
+}
+
 void AdvancedSettingsWidget::setPreset(const QList<TorrentSettingItem> &params)
 {
     for (auto param : params) {
@@ -262,6 +287,69 @@ void AdvancedSettingsWidget::setPreset(const QList<TorrentSettingItem> &params)
     filter();
 }
 
+/******************************************************************************
+ ******************************************************************************/
+TorrentDiskIo AdvancedSettingsWidget::diskIo() const
+{
+    return static_cast<TorrentDiskIo>(ui->diskIoComboBox->currentIndex());
+}
+
+void AdvancedSettingsWidget::setDiskIo(TorrentDiskIo diskIo)
+{
+    QSignalBlocker blocker(ui->diskIoComboBox);
+    ui->diskIoComboBox->setCurrentIndex(static_cast<int>(diskIo));
+}
+
+/*!
+ * \brief The directory where the disk speed is tested,
+ * i.e. on the disk that receives the torrents.
+ */
+QString AdvancedSettingsWidget::diskBenchmarkPath() const
+{
+    return m_diskBenchmarkPath;
+}
+
+void AdvancedSettingsWidget::setDiskBenchmarkPath(const QString &path)
+{
+    m_diskBenchmarkPath = path;
+}
+
+void AdvancedSettingsWidget::startDiskBenchmark()
+{
+    if (m_diskBenchmark->isRunning()) {
+        return;
+    }
+    ui->diskBenchmarkButton->setEnabled(false);
+    ui->diskBenchmarkLabel->setText(tr("Testing..."));
+    m_diskBenchmark->start(m_diskBenchmarkPath);
+}
+
+void AdvancedSettingsWidget::onDiskBenchmarkFinished()
+{
+    ui->diskBenchmarkButton->setEnabled(true);
+
+    auto result = m_diskBenchmark->result();
+    if (!result.isValid()) {
+        ui->diskBenchmarkLabel->setText(tr("Error: %0").arg(result.errorString));
+        return;
+    }
+    QPushButton *button = nullptr;
+    switch (DiskBenchmark::recommend(result)) {
+    case DiskBenchmark::Recommendation::Nvme:     button = ui->presetNvmeButton; break;
+    case DiskBenchmark::Recommendation::HddArray: button = ui->presetHddArrayButton; break;
+    case DiskBenchmark::Recommendation::Default:
+    default:
+        button = ui->presetDefaultButton;
+        break;
+    }
+    ui->diskBenchmarkLabel->setText(
+                tr("%0, %1 IOPS. Recommended preset: %2").arg(
+                    Format::currentSpeedToString(result.sequentialWriteRate),
+                    QString::number(qRound(result.randomWriteIops)),
+                    button->text()));
+    button->setFocus();
+}
+
 /******************************************************************************
  ******************************************************************************/
 void AdvancedSettingsWidget::populate()
@@ -352,7 +440,10 @@ void AdvancedSettingsWidget::setupPresetToolTip()
     QList<QPair<QString, QString>> presets = {
         { tr("Default")              , tr("Settings optimized for a regular bittorrent client running on a desktop system.") },
         { tr("Minimize Memory Usage"), tr("Settings intended for embedded devices. It will significantly reduce memory usage.") },
-        { tr("High Performance Seed"), tr("Settings optimized for a seed box, serving many peers and that doesn't do any downloading.") }
+        { tr("High Performance Seed"), tr("Settings optimized for a seed box, serving many peers and that doesn't do any downloading.") },
+        { tr("NVMe SSD")             , tr("Settings for fast solid-state drives: many concurrent disk jobs and multi-threaded hashing.") },
+        { tr("HDD Array")            , tr("Settings for rotating disks: few concurrent disk jobs and a large write queue, to limit the seeks.") },
+        { tr("Low RAM")              , tr("Settings for desktop machines with little memory: small disk queue and send buffers.") }
     };
     QString tooltip;
     tooltip += "<html><head/><body>";
@@ -19,8 +19,10 @@
 
 #include <QtWidgets/QWidget>
 
+#include <Core/Settings>
 #include <Core/TorrentContext>
 
+class DiskBenchmark;
 class QTreeWidgetItem;
 
 namespace Ui {
@@ -47,6 +49,12 @@ public:
     QVector<int> bandwidthSettings() const;
     void setBandwidthSettings(const QVector<int> &settings);
 
+    TorrentDiskIo diskIo() const;
+    void setDiskIo(TorrentDiskIo diskIo);
+
+    QString diskBenchmarkPath() const;
+    void setDiskBenchmarkPath(const QString &path);
+
 signals:
     void changed();
 
@@ -57,6 +65,12 @@ private slots:
     void setPresetDefault();
     void setPresetMinCache();
     void setPresetHighPerf();
+    void setPresetNvme();
+    void setPresetHddArray();
+    void setPresetLowRam();
+
+    void startDiskBenchmark();
+    void onDiskBenchmarkFinished();
 
     void setFilter(const QString &str);
     void showModifiedOnly(int state);
@@ -69,6 +83,8 @@ private slots:
 
 private:
     Ui::AdvancedSettingsWidget *ui = nullptr;
+    DiskBenchmark *m_diskBenchmark = nullptr;
+    QString m_diskBenchmarkPath = {};
 
     void restylizeUi();
 
@@ -14,6 +14,7 @@
  * License along with this program; If not, see <http://www.gnu.org/licenses/>.
  */
 
+
 #include "torrentpiecemap.h"
 #include "ui_torrentpiecemap.h"
 
@@ -24,8 +25,13 @@
 #include <QtCore/QtMath>
 #include <QtGui/QPainter>
 #include <QtGui/QPaintEvent>
-#include <QtWidgets/QGraphicsScene>
-#include <QtWidgets/QGraphicsItem>
+#include <QtGui/QWheelEvent>
+#include <QtWidgets/QApplication>
+#include <QtWidgets/QScrollBar>
+
+#include <array>
+#include <cstring> // std::memcmp
+#include <utility> // std::exchange
 
 #define ENABLE_MONITORING false
 
@@ -34,7 +40,32 @@
 #include <QtCore/QElapsedTimer>
 #endif
 
-static QColor color(TorrentPieceItem::Status status)
+/*!
+ * \brief Number of pieces compared at once when the map is updated.
+ */
+static constexpr qsizetype s_piecesPerWord = 64;
+
+/*!
+ * \brief Approximative height of a rendered block of rows, in pixels.
+ */
+static constexpr int s_blockHeight = 256;
+
+/*!
+ * \brief Maximum number of pieces displayed as detailed tiles by default.
+ */
+static constexpr qsizetype s_maxDetailedPieces = 4096;
+
+/*!
+ * \brief Size of the cells, for each level of detail.
+ *
+ * Level 0 is the detailed tile, with the availability and the priority.
+ * The last level aggregates several pieces per pixel, so that the whole
+ * torrent fits in the viewport.
+ */
+static constexpr std::array<int, 6> s_cellSizes = { 0, 8, 4, 2, 1, 1 };
+static constexpr int s_fitLevel = static_cast<int>(s_cellSizes.size()) - 1;
+
+static QColor color(TorrentPieceView::Status status)
 {
     auto palette = qApp->palette();
     auto bgColor = palette.color(QPalette::Active, QPalette::Window);
@@ -46,15 +77,60 @@ static QColor color(TorrentPieceItem::Status status)
     auto color4 = isDarkMode ? s_darkPurple : s_purple;
 
     switch (status) {
-    case TorrentPieceItem::Status::NotAvailable:   return color1;
-    case TorrentPieceItem::Status::Available:      return color2;
-    case TorrentPieceItem::Status::Downloaded:     return color3;
-    case TorrentPieceItem::Status::Verified:       return color4;
+    case TorrentPieceView::Status::NotAvailable:   return color1;
+    case TorrentPieceView::Status::Available:      return color2;
+    case TorrentPieceView::Status::Downloaded:     return color3;
+    case TorrentPieceView::Status::Verified:       return color4;
     }
     Q_UNREACHABLE();
 }
 
-static void colorize(QWidget *widget, TorrentPieceItem::Status status)
+/*!
+ * \brief Returns true if the bits in range [first, last) differ.
+ *
+ * The bits are compared byte by byte, from the internal buffers.
+ */
+static bool hasChanged(const QBitArray &before, const QBitArray &after,
+                       qsizetype first, qsizetype last)
+{
+    if (before.size() != after.size()) {
+        return true;
+    }
+    auto from = qMin(first, after.size()) / 8;
+    auto to = (qMin(last, after.size()) + 7) / 8;
+    if (from >= to) {
+        return false;
+    }
+    return std::memcmp(before.bits() + from, after.bits() + from, static_cast<size_t>(to - from)) != 0;
+}
+
+template <typename T>
+static bool hasChanged(const QVector<T> &before, const QVector<T> &after,
+                       qsizetype first, qsizetype last)
+{
+    if (before.size() != after.size()) {
+        return true;
+    }
+    auto end = qMin(last, after.size());
+    for (auto i = first; i < end; ++i) {
+        if (before.at(i) != after.at(i)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool hasChanged(const TorrentPieceData &before, const TorrentPieceData &after,
+                       qsizetype first, qsizetype last)
+{
+    return hasChanged(before.verifiedPieces, after.verifiedPieces, first, last)
+            || hasChanged(before.downloadedPieces, after.downloadedPieces, first, last)
+            || hasChanged(before.availablePieces, after.availablePieces, first, last)
+            || hasChanged(before.pieceAvailability, after.pieceAvailability, first, last)
+            || hasChanged(before.piecePriority, after.piecePriority, first, last);
+}
+
+static void colorize(QWidget *widget, TorrentPieceView::Status status)
 {
     auto _color = color(status);
     auto pal = widget->palette();
@@ -77,51 +153,21 @@ static QString decorate(int count, TorrentFileInfo::Priority priority)
 
 TorrentPieceMap::TorrentPieceMap(QWidget *parent) : QWidget(parent)
   , ui(new Ui::TorrentPieceMap)
-  , m_scene(new QGraphicsScene(this))
   , m_workerThread(new TorrentPieceMapWorker(this))
-  , m_tileFont(font())
 {
     ui->setupUi(this);
 
-    colorize(ui->boxNotAvailable, TorrentPieceItem::Status::NotAvailable);
-    colorize(ui->boxAvailable,    TorrentPieceItem::Status::Available);
-    colorize(ui->boxDownloaded,   TorrentPieceItem::Status::Downloaded);
-    colorize(ui->boxVerified,     TorrentPieceItem::Status::Verified);
+    colorize(ui->boxNotAvailable, TorrentPieceView::Status::NotAvailable);
+    colorize(ui->boxAvailable,    TorrentPieceView::Status::Available);
+    colorize(ui->boxDownloaded,   TorrentPieceView::Status::Downloaded);
+    colorize(ui->boxVerified,     TorrentPieceView::Status::Verified);
 
     ui->priorityLabel->setText(
         tr("Priority: %0=high %1=normal %2=low %3=ignore").arg(
             QString("³"), QString("²"), QString("¹"), QString("°")));
 
-    /* Calculate metrics */
-
-    // const int pointSize = m_tileFont.pointSize();
-    // m_tileFont.setPointSize(pointSize - 1);
-
     qRegisterMetaType<TorrentPieceData>("TorrentPieceData");
 
-    QFontMetrics fm(m_tileFont);
-    m_tileWidth = fm.horizontalAdvance(decorate(999, TorrentFileInfo::Low));
-    m_tileHeight = fm.height() + 2 * m_tilePadding;
-    m_tileWidth += 2 * m_tilePadding;
-
-    /* Graphics Scene */
-    m_rootItem = m_scene->addRect(QRectF(0, 0, 0, 0));
-    m_rootItem->setFlags(QGraphicsItem::ItemHasNoContents);
-    m_scene->setBackgroundBrush(QBrush(s_darkPurple));
-
-    /* Indexing is efficient for static scenes */
-    /* But here items will move around, so disable it. */
-    m_scene->setItemIndexMethod(QGraphicsScene::NoIndex);
-
-    /* Graphics View */
-    ui->graphicsView->setScene(m_scene);
-    ui->graphicsView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    ui->graphicsView->setRenderHint(QPainter::TextAntialiasing);
-    ui->graphicsView->setViewportUpdateMode(QGraphicsView::BoundingRectViewportUpdate);
-
-    /* Cache pre-rendered content in a pixmap, which is then drawn onto the viewport */
-    ui->graphicsView->setCacheMode(QGraphicsView::CacheBackground);
-
     /* Worker thread */
     connect(m_workerThread, &TorrentPieceMapWorker::resultReady, this, &TorrentPieceMap::handleResults);
 
@@ -162,7 +208,6 @@ void TorrentPieceMap::setTorrent(Torrent *torrent)
  ******************************************************************************/
 void TorrentPieceMap::showEvent(QShowEvent * /*event*/)
 {
-    adjustScene();
     m_workerThread->setUseful(true);
 }
 
@@ -172,11 +217,6 @@ void TorrentPieceMap::hideEvent(QHideEvent * /*event*/)
     m_workerThread->setUseful(false);
 }
 
-void TorrentPieceMap::resizeEvent(QResizeEvent * /*event*/)
-{
-    adjustScene();
-}
-
 /******************************************************************************
  ******************************************************************************/
 bool TorrentPieceMapWorker::isUseful()
@@ -272,7 +312,7 @@ void TorrentPieceMapWorker::run()
  ******************************************************************************/
 void TorrentPieceMap::handleResults(const TorrentPieceData &pieceData)
 {
-    setPieceData(pieceData);
+    ui->pieceView->setPieceData(pieceData);
 }
 
 void TorrentPieceMap::updateWidget()
@@ -291,180 +331,386 @@ void TorrentPieceMap::updateWidget()
         m_workerThread->doWork(pieceData, peers);
 
     } else {
-        clearScene();
+        ui->pieceView->clear();
     }
 }
 
-void TorrentPieceMap::setPieceData(const TorrentPieceData &pieceData)
+/******************************************************************************
+ ******************************************************************************/
+void TorrentPieceMap::changeEvent(QEvent *event)
 {
-    if (pieceData.size != m_items.count()) {
-        clearScene();
-        populateScene(pieceData);
-        adjustScene();
+    if (event->type() == QEvent::LanguageChange) {
+        ui->retranslateUi(this);
+        retranslateUi();
     }
-    updateScene(pieceData);
+    QWidget::changeEvent(event);
 }
 
 /******************************************************************************
  ******************************************************************************/
-void TorrentPieceMap::clearScene()
+void TorrentPieceMap::onChanged()
 {
-    for (auto item : m_items) {
-        m_scene->removeItem(item);
-    }
-    m_items.clear();
+    updateWidget();
 }
 
-void TorrentPieceMap::populateScene(const TorrentPieceData &pieceData)
+void TorrentPieceMap::resetUi()
 {
-    for (int i = 0; i < pieceData.size; ++i) {
-        auto item = new TorrentPieceItem(
-                    m_tileWidth, m_tileHeight,
-                    m_tilePadding, m_tileFont,
-                    m_rootItem);
+    updateWidget();
+}
 
-        auto flags = item->flags();
-        flags.setFlag(QGraphicsItem::ItemIsMovable, false);
-        flags.setFlag(QGraphicsItem::ItemIsSelectable, false);
-        flags.setFlag(QGraphicsItem::ItemIsFocusable, false);
-        flags.setFlag(QGraphicsItem::ItemSendsGeometryChanges, false);
-        flags.setFlag(QGraphicsItem::ItemSendsScenePositionChanges, false);
-        item->setFlags(flags);
-        m_items.append(item);
-    }
+void TorrentPieceMap::retranslateUi()
+{
+    // Nothing
 }
 
 /******************************************************************************
  ******************************************************************************/
 /*!
- * Items are moved around, to fill the width of the viewport.
+ * \class TorrentPieceView
+ *
+ * The TorrentPieceView paints the pieces of the torrent as a grid of cells.
+ *
+ * The grid is rendered in blocks of rows, each one cached in a QImage.
+ * Only the visible blocks are rendered, and a block is rendered again
+ * only when the state of one of its pieces changes.
+ *
+ * The level of detail goes from the detailed tiles (with the availability
+ * and the priority of the piece) to square cells of a few pixels.
+ * At the last level, a cell of 1 pixel aggregates several pieces:
+ * its color is the mix of the colors of the pieces.
  */
-void TorrentPieceMap::adjustScene()
-{
-    auto viewportSize = ui->graphicsView->viewport()->size();
-    qreal maxWidth = static_cast<qreal>(viewportSize.width());
-    qreal width = m_tileWidth + 2 * m_tilePadding;
-    qreal height = m_tileHeight + 2 * m_tilePadding;
-    qreal x = 0;
-    qreal y = 0;
-    for (auto item : m_items) {
-        if (x + width >= maxWidth) {
-            x = 0;
-            y += height;
+TorrentPieceView::TorrentPieceView(QWidget *parent) : QAbstractScrollArea(parent)
+{
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    viewport()->setAttribute(Qt::WA_OpaquePaintEvent);
+    updateTileSize();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void TorrentPieceView::setPieceData(const TorrentPieceData &pieceData)
+{
+    auto previous = std::exchange(m_pieceData, pieceData);
+    if (previous.size != m_pieceData.size) {
+        relayout();
+        return;
+    }
+    auto size = static_cast<qsizetype>(m_pieceData.size);
+    for (qsizetype first = 0; first < size; first += s_piecesPerWord) {
+        auto last = qMin(first + s_piecesPerWord, size);
+        if (hasChanged(previous, m_pieceData, first, last)) {
+            invalidatePieces(first, last);
         }
-        item->setPos(x, y);
-        x += width;
     }
-    const QRectF viewportRect(QPointF(0, 0), viewportSize);
-    auto rect = m_scene->itemsBoundingRect().united(viewportRect);
-    m_scene->setSceneRect(rect);
+}
+
+void TorrentPieceView::clear()
+{
+    setPieceData({});
 }
 
 /******************************************************************************
  ******************************************************************************/
-void TorrentPieceMap::updateScene(const TorrentPieceData &pieceData)
+int TorrentPieceView::levelOfDetail() const
 {
-    Q_ASSERT(pieceData.size == m_items.count());
-    auto size = pieceData.size;
-    for (auto i = 0; i < size; ++i) {
-        auto item = m_items.at(i);
+    return m_level;
+}
 
-        if (i < pieceData.pieceAvailability.size()) {
-            item->setAvailability(pieceData.pieceAvailability.at(i));
-        }
+void TorrentPieceView::setLevelOfDetail(int level)
+{
+    m_isAutoLevel = false;
+    level = qBound(0, level, s_fitLevel);
+    if (m_level != level) {
+        m_level = level;
+        relayout();
+    }
+}
 
-        if (i < pieceData.piecePriority.size()) {
-            item->setPriority(pieceData.piecePriority.at(i));
-        }
+int TorrentPieceView::piecesPerCell() const
+{
+    return static_cast<int>(m_piecesPerCell);
+}
 
-        TorrentPieceItem::Status status = TorrentPieceItem::Status::NotAvailable;
-        if (i < pieceData.verifiedPieces.size() && pieceData.verifiedPieces.at(i)) {
-            status = TorrentPieceItem::Status::Verified;
+void TorrentPieceView::zoomIn()
+{
+    setLevelOfDetail(m_level - 1);
+}
 
-        } else if (i < pieceData.downloadedPieces.size() && pieceData.downloadedPieces.at(i)) {
-            status = TorrentPieceItem::Status::Downloaded;
+void TorrentPieceView::zoomOut()
+{
+    setLevelOfDetail(m_level + 1);
+}
 
-        } else if (i < pieceData.availablePieces.size() && pieceData.availablePieces.at(i)) {
-            status = TorrentPieceItem::Status::Available;
-        }
-        item->setStatus(status);
+/******************************************************************************
+ ******************************************************************************/
+void TorrentPieceView::changeEvent(QEvent *event)
+{
+    if (event->type() == QEvent::FontChange) {
+        updateTileSize();
+        relayout();
 
-        item->update();
+    } else if (event->type() == QEvent::PaletteChange
+               || event->type() == QEvent::StyleChange) {
+        invalidate();
     }
+    QAbstractScrollArea::changeEvent(event);
 }
 
-/******************************************************************************
- ******************************************************************************/
-void TorrentPieceMap::changeEvent(QEvent *event)
+void TorrentPieceView::paintEvent(QPaintEvent *event)
 {
-    if (event->type() == QEvent::LanguageChange) {
-        ui->retranslateUi(this);
-        retranslateUi();
+    QPainter painter(viewport());
+    painter.fillRect(event->rect(), s_darkPurple);
+
+    if (m_cellCount <= 0) {
+        m_blocks.clear();
+        return;
+    }
+    auto top = verticalScrollBar()->value();
+    auto blockHeight = m_blockRows * m_cellHeight;
+    auto blockCount = (m_rows + m_blockRows - 1) / m_blockRows;
+
+    auto firstBlock = qMax(0, (top + event->rect().top()) / blockHeight);
+    auto lastBlock = qMin(blockCount - 1, (top + event->rect().bottom()) / blockHeight);
+    for (auto i = firstBlock; i <= lastBlock; ++i) {
+        painter.drawImage(0, i * blockHeight - top, block(i));
+    }
+
+    /* Release the blocks that are far from the viewport */
+    auto firstVisible = top / blockHeight - 1;
+    auto lastVisible = (top + viewport()->height()) / blockHeight + 1;
+    for (auto it = m_blocks.begin(); it != m_blocks.end(); ) {
+        if (it.key() < firstVisible || it.key() > lastVisible) {
+            it = m_blocks.erase(it);
+        } else {
+            ++it;
+        }
     }
-    QWidget::changeEvent(event);
 }
 
-/******************************************************************************
- ******************************************************************************/
-void TorrentPieceMap::onChanged()
+void TorrentPieceView::resizeEvent(QResizeEvent *event)
 {
-    updateWidget();
+    QAbstractScrollArea::resizeEvent(event);
+    relayout();
 }
 
-void TorrentPieceMap::resetUi()
+void TorrentPieceView::scrollContentsBy(int /*dx*/, int /*dy*/)
 {
-    updateWidget();
+    viewport()->update();
 }
 
-void TorrentPieceMap::retranslateUi()
+void TorrentPieceView::wheelEvent(QWheelEvent *event)
 {
-    // Nothing
+    if (event->modifiers() & Qt::ControlModifier) {
+        auto delta = event->angleDelta().y();
+        if (delta > 0) {
+            zoomIn();
+        } else if (delta < 0) {
+            zoomOut();
+        }
+        event->accept();
+        return;
+    }
+    QAbstractScrollArea::wheelEvent(event);
 }
 
 /******************************************************************************
  ******************************************************************************/
-TorrentPieceItem::TorrentPieceItem(qreal width, qreal height, qreal padding,
-                                   const QFont &font, QGraphicsItem *parent)
-    : QGraphicsItem(parent)
-    , m_font(font)
-    , m_width(width)
-    , m_height(height)
-    , m_padding(padding)
+inline bool TorrentPieceView::isDetailed() const
+{
+    return m_level == 0;
+}
+
+/*!
+ * \brief Returns the most detailed level that doesn't need scrolling.
+ *
+ * Small torrents keep the detailed tiles, even if they need scrolling.
+ */
+int TorrentPieceView::autoLevel() const
 {
+    auto size = static_cast<qsizetype>(m_pieceData.size);
+    if (size <= s_maxDetailedPieces) {
+        return 0;
+    }
+    auto width = qMax(1, viewport()->width());
+    auto height = qMax(1, viewport()->height());
+    for (auto level = 1; level < s_fitLevel; ++level) {
+        auto cellSize = s_cellSizes.at(static_cast<std::size_t>(level));
+        auto columns = static_cast<qsizetype>(qMax(1, width / cellSize));
+        auto rows = static_cast<qsizetype>(height / cellSize);
+        if (size <= columns * rows) {
+            return level;
+        }
+    }
+    return s_fitLevel;
 }
 
-void TorrentPieceItem::setAvailability(int availability)
+void TorrentPieceView::updateTileSize()
 {
-    m_availability = availability;
+    QFontMetrics fm(font());
+    const int padding = 1;
+    auto width = fm.horizontalAdvance(decorate(999, TorrentFileInfo::Low)) + 2 * padding;
+    auto height = fm.height() + 2 * padding;
+    m_tileSize = QSize(width + 2 * padding, height + 2 * padding);
+}
+
+/*!
+ * \brief Computes the grid of cells, and discards the rendered blocks.
+ */
+void TorrentPieceView::relayout()
+{
+    if (m_isAutoLevel) {
+        m_level = autoLevel();
+    }
+    auto size = static_cast<qsizetype>(m_pieceData.size);
+    auto width = qMax(1, viewport()->width());
+    auto height = qMax(1, viewport()->height());
+
+    if (isDetailed()) {
+        m_cellWidth = m_tileSize.width();
+        m_cellHeight = m_tileSize.height();
+    } else {
+        m_cellWidth = s_cellSizes.at(static_cast<std::size_t>(m_level));
+        m_cellHeight = m_cellWidth;
+    }
+    m_columns = qMax(1, width / m_cellWidth);
+    m_piecesPerCell = 1;
+    if (m_level == s_fitLevel) {
+        auto cells = static_cast<qsizetype>(m_columns) * (height / m_cellHeight);
+        m_piecesPerCell = qMax<qsizetype>(1, (size + cells - 1) / qMax<qsizetype>(1, cells));
+    }
+    m_cellCount = (size + m_piecesPerCell - 1) / m_piecesPerCell;
+    m_rows = static_cast<int>((m_cellCount + m_columns - 1) / m_columns);
+    m_blockRows = qMax(1, s_blockHeight / m_cellHeight);
+
+    auto contentHeight = m_rows * m_cellHeight;
+    verticalScrollBar()->setRange(0, qMax(0, contentHeight - height));
+    verticalScrollBar()->setPageStep(height);
+    verticalScrollBar()->setSingleStep(m_cellHeight);
+
+    invalidate();
 }
 
-void TorrentPieceItem::setPriority(TorrentFileInfo::Priority priority)
+void TorrentPieceView::invalidate()
 {
-    m_priority = priority;
+    m_blocks.clear();
+    viewport()->update();
 }
 
-void TorrentPieceItem::setStatus(Status status)
+/*!
+ * \brief Discards the blocks that contain the pieces in range [first, last).
+ */
+void TorrentPieceView::invalidatePieces(qsizetype first, qsizetype last)
 {
-    m_status = status;
+    if (first >= last) {
+        return;
+    }
+    auto firstRow = (first / m_piecesPerCell) / m_columns;
+    auto lastRow = ((last - 1) / m_piecesPerCell) / m_columns;
+    auto firstBlock = static_cast<int>(firstRow / m_blockRows);
+    auto lastBlock = static_cast<int>(lastRow / m_blockRows);
+    for (auto i = firstBlock; i <= lastBlock; ++i) {
+        if (m_blocks.remove(i)) {
+            viewport()->update(blockRect(i));
+        }
+    }
 }
 
-QRectF TorrentPieceItem::boundingRect() const
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \brief Returns the area of the given \a block, in viewport coordinates.
+ */
+QRect TorrentPieceView::blockRect(int index) const
 {
-    return {0, 0, m_width + 2* m_padding, m_height + 2* m_padding};
+    auto blockHeight = m_blockRows * m_cellHeight;
+    auto y = index * blockHeight - verticalScrollBar()->value();
+    return QRect(0, y, viewport()->width(), blockHeight);
 }
 
-QPainterPath TorrentPieceItem::shape() const
+const QImage &TorrentPieceView::block(int index)
 {
-    QPainterPath path;
-    path.addRect(m_padding, m_padding, m_width, m_height);
-    return path;
+    auto it = m_blocks.find(index);
+    if (it == m_blocks.end()) {
+        it = m_blocks.insert(index, renderBlock(index));
+    }
+    return it.value();
+}
+
+QImage TorrentPieceView::renderBlock(int index) const
+{
+    auto dpr = devicePixelRatioF();
+    QSize imageSize(m_columns * m_cellWidth, m_blockRows * m_cellHeight);
+    QImage image(imageSize * dpr, QImage::Format_RGB32);
+    image.setDevicePixelRatio(dpr);
+    image.fill(s_darkPurple);
+
+    const std::array<QColor, 4> colors = {
+        color(Status::NotAvailable),
+        color(Status::Available),
+        color(Status::Downloaded),
+        color(Status::Verified)
+    };
+
+    QPainter painter(&image);
+    painter.setFont(font());
+    painter.setRenderHint(QPainter::TextAntialiasing);
+
+    const int padding = isDetailed() || m_cellWidth >= 4 ? 1 : 0;
+    auto firstCell = static_cast<qsizetype>(index) * m_blockRows * m_columns;
+    auto lastCell = qMin(firstCell + static_cast<qsizetype>(m_blockRows) * m_columns, m_cellCount);
+    auto pieceCount = static_cast<qsizetype>(m_pieceData.size);
+
+    for (auto cell = firstCell; cell < lastCell; ++cell) {
+        auto offset = cell - firstCell;
+        auto x = static_cast<int>(offset % m_columns) * m_cellWidth;
+        auto y = static_cast<int>(offset / m_columns) * m_cellHeight;
+        QRect rect(x + padding, y + padding, m_cellWidth - 2 * padding, m_cellHeight - 2 * padding);
+
+        auto first = cell * m_piecesPerCell;
+        auto last = qMin(first + m_piecesPerCell, pieceCount);
+
+        if (m_piecesPerCell == 1) {
+            painter.fillRect(rect, colors.at(static_cast<std::size_t>(status(first))));
+
+        } else {
+            /* Level of detail: mix the colors of the aggregated pieces */
+            std::array<qsizetype, 4> counts = {};
+            for (auto i = first; i < last; ++i) {
+                counts[static_cast<std::size_t>(status(i))]++;
+            }
+            float r = 0, g = 0, b = 0;
+            for (std::size_t s = 0; s < counts.size(); ++s) {
+                auto count = static_cast<float>(counts.at(s));
+                r += colors.at(s).redF() * count;
+                g += colors.at(s).greenF() * count;
+                b += colors.at(s).blueF() * count;
+            }
+            auto total = static_cast<float>(qMax<qsizetype>(1, last - first));
+            painter.fillRect(rect, QColor::fromRgbF(r / total, g / total, b / total));
+        }
+
+        if (isDetailed()) {
+            auto availability = first < m_pieceData.pieceAvailability.size()
+                    ? m_pieceData.pieceAvailability.at(first) : 0;
+            auto priority = first < m_pieceData.piecePriority.size()
+                    ? m_pieceData.piecePriority.at(first) : TorrentFileInfo::Normal;
+            painter.drawText(rect, Qt::AlignCenter, decorate(availability, priority));
+        }
+    }
+    return image;
 }
 
-void TorrentPieceItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
+inline TorrentPieceView::Status TorrentPieceView::status(qsizetype index) const
 {
-    QRectF tileRect = QRectF(m_padding, m_padding, m_width, m_height);
-    QColor tileColor = color(m_status);
-    painter->fillRect(tileRect, tileColor);
-    painter->setFont(m_font);
-    painter->drawText(tileRect, Qt::AlignCenter, decorate(m_availability, m_priority));
+    if (index < m_pieceData.verifiedPieces.size() && m_pieceData.verifiedPieces.testBit(index)) {
+        return Status::Verified;
+    }
+    if (index < m_pieceData.downloadedPieces.size() && m_pieceData.downloadedPieces.testBit(index)) {
+        return Status::Downloaded;
+    }
+    if (index < m_pieceData.availablePieces.size() && m_pieceData.availablePieces.testBit(index)) {
+        return Status::Available;
+    }
+    return Status::NotAvailable;
 }
@@ -18,22 +18,21 @@
 #define WIDGETS_TORRENT_PIECE_MAP_H
 
 #include <QtCore/QBitArray>
+#include <QtCore/QHash>
 #include <QtCore/QReadWriteLock>
 #include <QtCore/QThread>
+#include <QtGui/QImage>
+#include <QtWidgets/QAbstractScrollArea>
 #include <QtWidgets/QWidget>
-#include <QtWidgets/QGraphicsItem>
 
 #include <Core/Torrent>
 
-class QGraphicsScene;
-
 namespace Ui {
 class TorrentPieceMap;
 }
 
 class Torrent;
 class TorrentPieceMapWorker;
-class TorrentPieceItem;
 
 struct TorrentPieceData
 {
@@ -62,7 +61,6 @@ public:
 protected:
     void showEvent(QShowEvent *event) override;
     void hideEvent(QHideEvent *event) override;
-    void resizeEvent(QResizeEvent *event) override;
 
 protected slots:
     void changeEvent(QEvent *event) override;
@@ -74,27 +72,12 @@ private slots:
 private:
     Ui::TorrentPieceMap *ui = nullptr;
     Torrent *m_torrent = nullptr;
-    QGraphicsScene *m_scene = nullptr;
-    QGraphicsRectItem *m_rootItem = nullptr;
-    QList<TorrentPieceItem *> m_items = {};
-
     TorrentPieceMapWorker *m_workerThread = nullptr;
 
-    QFont m_tileFont = {};
-    qreal m_tileHeight = 0;
-    qreal m_tileWidth = 0;
-    qreal m_tilePadding = 1;
-
     void resetUi();
     void retranslateUi();
 
-    void setPieceData(const TorrentPieceData &pieceData);
-
     void updateWidget();
-    void clearScene();
-    void populateScene(const TorrentPieceData &pieceData);
-    void adjustScene();
-    void updateScene(const TorrentPieceData &pieceData);
 };
 
 /******************************************************************************
@@ -130,8 +113,9 @@ private:
 
 /******************************************************************************
  ******************************************************************************/
-class TorrentPieceItem : public QGraphicsItem
+class TorrentPieceView : public QAbstractScrollArea
 {
+    Q_OBJECT
 public:
     enum class Status {
         NotAvailable,
@@ -140,27 +124,57 @@ public:
         Verified
     };
 
-    explicit TorrentPieceItem(
-        qreal width, qreal height, qreal padding,
-        const QFont &font, QGraphicsItem *parent = nullptr);
+    explicit TorrentPieceView(QWidget *parent = nullptr);
 
-    void setAvailability(int availability);
-    void setPriority(TorrentFileInfo::Priority priority);
+    void setPieceData(const TorrentPieceData &pieceData);
+    void clear();
 
-    void setStatus(Status status);
+    int levelOfDetail() const;
+    void setLevelOfDetail(int level);
 
-    QRectF boundingRect() const override;
-    QPainterPath shape() const override;
-    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+    int piecesPerCell() const;
+
+public slots:
+    void zoomIn();
+    void zoomOut();
+
+protected:
+    void changeEvent(QEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+    void wheelEvent(QWheelEvent *event) override;
 
 private:
-    QFont m_font = {};
-    qreal m_width = 0;
-    qreal m_height = 0;
-    qreal m_padding = 0;
-    int m_availability = 0;
-    TorrentFileInfo::Priority m_priority = TorrentFileInfo::Normal;
-    Status m_status = Status::NotAvailable;
+    TorrentPieceData m_pieceData = {};
+
+    QSize m_tileSize = {};
+    int m_level = 0;
+    bool m_isAutoLevel = true;
+
+    /* Layout */
+    int m_cellWidth = 1;
+    int m_cellHeight = 1;
+    qsizetype m_piecesPerCell = 1;
+    qsizetype m_cellCount = 0;
+    int m_columns = 1;
+    int m_rows = 0;
+    int m_blockRows = 1;
+
+    /* Rendered blocks of rows, indexed by block */
+    QHash<int, QImage> m_blocks = {};
+
+    bool isDetailed() const;
+    int autoLevel() const;
+    void updateTileSize();
+    void relayout();
+    void invalidate();
+    void invalidatePieces(qsizetype first, qsizetype last);
+
+    QRect blockRect(int index) const;
+    const QImage &block(int index);
+    QImage renderBlock(int index) const;
+    Status status(qsizetype index) const;
 };
 
 #endif // WIDGETS_TORRENT_PIECE_MAP_H
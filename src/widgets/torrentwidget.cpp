@@ -288,6 +288,9 @@ TorrentWidget::TorrentWidget(QWidget *parent) : QWidget(parent)
 
 TorrentWidget::~TorrentWidget()
 {
+    if (m_torrentContext && m_torrent) {
+        m_torrentContext->unsubscribe(m_torrent);
+    }
     delete ui;
 }
 
@@ -300,14 +303,20 @@ TorrentBaseContext *TorrentWidget::torrentContext() const
 
 void TorrentWidget::setTorrentContext(TorrentBaseContext *torrentContext)
 {
+    if (m_torrentContext && m_torrent) {
+        m_torrentContext->unsubscribe(m_torrent);
+    }
     m_torrentContext = torrentContext;
+    if (m_torrentContext && m_torrent) {
+        m_torrentContext->subscribe(m_torrent);
+    }
 }
 
 /******************************************************************************
  ******************************************************************************/
 void TorrentWidget::clear()
 {
-    m_torrent = nullptr;
+    setTorrent(nullptr);
     resetUi();
 }
 
@@ -331,10 +340,16 @@ void TorrentWidget::setTorrent(Torrent *torrent)
     }
     if (m_torrent) {
         disconnect(m_torrent, &Torrent::changed, this, &TorrentWidget::onChanged);
+        if (m_torrentContext) {
+            m_torrentContext->unsubscribe(m_torrent);
+        }
     }
     m_torrent = torrent;
     if (m_torrent) {
         connect(m_torrent, &Torrent::changed, this, &TorrentWidget::onChanged);
+        if (m_torrentContext) {
+            m_torrentContext->subscribe(m_torrent); // full detail while displayed
+        }
     }
     resetUi();
 }
@@ -874,6 +889,18 @@ void TorrentWidget::updateTorrentPage()
 
     auto shareRatio = text(QString("0.000"));
     auto status = text(m_torrent ? m_torrent->status() : ""_L1);
+    auto remainingTime = ti.remaingTime;
+
+    auto recheck = m_torrent->recheckInfo();
+    if (recheck.state == TorrentRecheckInfo::Queued) {
+        status = tr("Waiting for recheck");
+    } else if (recheck.state == TorrentRecheckInfo::Checking) {
+        status = tr("Rechecking %0 of %1 at %2").arg(
+                    Format::fileSizeToString(recheck.bytesChecked),
+                    Format::fileSizeToString(recheck.bytesTotal),
+                    Format::currentSpeedToString(recheck.speed));
+        remainingTime = recheck.remainingTime();
+    }
 
     auto pieces = tr("%0 x %1").arg(
                 text(mi.initialMetaInfo.pieceCount),
@@ -882,7 +909,7 @@ void TorrentWidget::updateTorrentPage()
 
     // GroupBox Transfer
     ui->timeElapsedLineEdit->setText(   Format::timeToString(ti.elapsedTime));
-    ui->timeRemainingLineEdit->setText( Format::timeToString(ti.remaingTime));
+    ui->timeRemainingLineEdit->setText( Format::timeToString(remainingTime));
     ui->wastedLineEdit->setText(        wasted);
 
     ui->downloadedLineEdit->setText(    downloaded);
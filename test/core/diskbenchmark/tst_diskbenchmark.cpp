@@ -0,0 +1,123 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Core/DiskBenchmark>
+
+#include <QtCore/QDebug>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QSignalSpy>
+#include <QtTest/QtTest>
+
+Q_DECLARE_METATYPE(DiskBenchmark::Recommendation)
+
+class tst_DiskBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void measure();
+    void measure_invalidPath();
+    void start();
+
+    void recommend_data();
+    void recommend();
+};
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_DiskBenchmark::measure()
+{
+    // Given
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    // When
+    auto actual = DiskBenchmark::measure(dir.path(), 1024 * 1024, 4);
+
+    // Then
+    QVERIFY(actual.isValid());
+    QVERIFY(actual.sequentialWriteRate > 0);
+    QVERIFY(actual.randomWriteIops > 0);
+    QVERIFY(QDir(dir.path()).isEmpty()); // temporary file removed
+}
+
+void tst_DiskBenchmark::measure_invalidPath()
+{
+    // Given
+    QTemporaryDir dir;
+    auto path = QDir(dir.path()).filePath("missing/directory");
+
+    // When
+    auto actual = DiskBenchmark::measure(path, 1024 * 1024, 4);
+
+    // Then
+    QVERIFY(!actual.isValid());
+    QVERIFY(!actual.errorString.isEmpty());
+    QCOMPARE(DiskBenchmark::recommend(actual), DiskBenchmark::Recommendation::Default);
+}
+
+void tst_DiskBenchmark::start()
+{
+    // Given
+    QTemporaryDir dir;
+    DiskBenchmark target(this);
+    QSignalSpy spyFinished(&target, SIGNAL(finished()));
+
+    // When
+    target.start(dir.path());
+
+    // Then
+    QVERIFY(target.isRunning());
+    QVERIFY(spyFinished.wait(30000));
+    QVERIFY(!target.isRunning());
+    QVERIFY(target.result().isValid());
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_DiskBenchmark::recommend_data()
+{
+    QTest::addColumn<qint64>("sequentialWriteRate");
+    QTest::addColumn<qreal>("randomWriteIops");
+    QTest::addColumn<DiskBenchmark::Recommendation>("expected");
+
+    QTest::newRow("nvme") << qint64(2000000000) << qreal(8000) << DiskBenchmark::Recommendation::Nvme;
+    QTest::newRow("sata ssd") << qint64(500000000) << qreal(3000) << DiskBenchmark::Recommendation::Default;
+    QTest::newRow("fast but slow flush") << qint64(2000000000) << qreal(500) << DiskBenchmark::Recommendation::Default;
+    QTest::newRow("hdd") << qint64(150000000) << qreal(80) << DiskBenchmark::Recommendation::HddArray;
+    QTest::newRow("hdd array") << qint64(900000000) << qreal(120) << DiskBenchmark::Recommendation::HddArray;
+}
+
+void tst_DiskBenchmark::recommend()
+{
+    QFETCH(qint64, sequentialWriteRate);
+    QFETCH(qreal, randomWriteIops);
+    QFETCH(DiskBenchmark::Recommendation, expected);
+
+    DiskBenchmark::Result result;
+    result.sequentialWriteRate = sequentialWriteRate;
+    result.randomWriteIops = randomWriteIops;
+
+    auto actual = DiskBenchmark::recommend(result);
+
+    QCOMPARE(actual, expected);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+QTEST_MAIN(tst_DiskBenchmark)
+
+#include "tst_diskbenchmark.moc"
@@ -0,0 +1,482 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Core/DownloadManager>
+#include <Core/DownloadItem>
+#include <Core/ResourceItem>
+#include <Core/RetryPolicy>
+
+#include "../../utils/httptestserver.h"
+
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+#include <QtTest/QSignalSpy>
+#include <QtTest/QtTest>
+
+#include <atomic>
+#include <ctime>
+#include <cstdlib>
+#include <new>
+
+using namespace std::chrono_literals;
+
+Q_DECLARE_OPAQUE_POINTER(IDownloadItem*)
+Q_DECLARE_METATYPE(IDownloadItem::State)
+
+/******************************************************************************
+ ******************************************************************************/
+/*
+ * Count the heap allocations of the whole process (all threads).
+ */
+static std::atomic<qint64> s_allocationCount = 0;
+
+void* operator new(std::size_t size)
+{
+    s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (auto ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*
+ * Measure how long the main (GUI) thread is blocked:
+ * a timer that should tick every few milliseconds
+ * records the delay of each tick.
+ */
+class StallMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr qint64 INTERVAL_MSEC = 5;
+    static constexpr qint64 THRESHOLD_MSEC = 4 * INTERVAL_MSEC;
+
+    explicit StallMonitor(QObject *parent = nullptr) : QObject(parent)
+    {
+        m_timer.setTimerType(Qt::PreciseTimer);
+        m_timer.setInterval(INTERVAL_MSEC);
+        connect(&m_timer, SIGNAL(timeout()), this, SLOT(onTimeout()));
+    }
+
+    void start() { m_clock.start(); m_timer.start(); }
+    void stop() { m_timer.stop(); }
+
+    qint64 maxStall() const { return m_maxStall; }
+    qint64 totalStall() const { return m_totalStall; }
+
+private slots:
+    void onTimeout()
+    {
+        auto stall = m_clock.restart() - INTERVAL_MSEC;
+        m_maxStall = qMax(m_maxStall, stall);
+        if (stall > THRESHOLD_MSEC) {
+            m_totalStall += stall;
+        }
+    }
+
+private:
+    QTimer m_timer = {};
+    QElapsedTimer m_clock = {};
+    qint64 m_maxStall = 0;
+    qint64 m_totalStall = 0;
+};
+
+/******************************************************************************
+ ******************************************************************************/
+class tst_DownloadBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {
+        qRegisterMetaType<IDownloadItem*>("IDownloadItem*");
+    }
+
+    void transfer_data();
+    void transfer();
+
+    void connectionReuse_data();
+    void connectionReuse();
+
+    void resume_afterFailure();
+    void resume_afterErrorPage();
+    void retry_stopDuringBackoff_data();
+    void retry_stopDuringBackoff();
+
+private:
+    HttpTestServer* startServer(QThread &thread, HttpTestServer *server);
+    DownloadItem* createJob(DownloadManager *downloadManager,
+                            const QUrl &url, const QString &destination);
+};
+
+/******************************************************************************
+ ******************************************************************************/
+/*
+ * The server runs in its own thread, so that its work
+ * is not counted as a stall of the main thread.
+ */
+HttpTestServer* tst_DownloadBenchmark::startServer(QThread &thread, HttpTestServer *server)
+{
+    server->moveToThread(&thread);
+    connect(&thread, SIGNAL(finished()), server, SLOT(deleteLater()));
+    thread.start();
+    auto listening = false;
+    QMetaObject::invokeMethod(server, [server, &listening] {
+        listening = server->listen(QHostAddress::LocalHost);
+    }, Qt::BlockingQueuedConnection);
+    return listening ? server : nullptr;
+}
+
+DownloadItem* tst_DownloadBenchmark::createJob(
+        DownloadManager *downloadManager, const QUrl &url, const QString &destination)
+{
+    auto resource = new ResourceItem();
+    resource->setUrl(url.toString());
+    resource->setDestination(destination);
+    resource->setMask("*name*.*ext*");
+    auto item = new DownloadItem(downloadManager);
+    item->setResource(resource);
+    return item;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_DownloadBenchmark::transfer_data()
+{
+    QTest::addColumn<int>("fileCount");
+    QTest::addColumn<qint64>("contentSize");
+    QTest::addColumn<bool>("chunked");
+    QTest::addColumn<qint64>("latency");
+    QTest::addColumn<qint64>("bandwidth");
+
+    QTest::newRow("1 x 64 MB") << 1 << qint64(64 * 1024 * 1024) << false << qint64(0) << qint64(0);
+    QTest::newRow("1 x 64 MB chunked") << 1 << qint64(64 * 1024 * 1024) << true << qint64(0) << qint64(0);
+    QTest::newRow("16 x 4 MB") << 16 << qint64(4 * 1024 * 1024) << false << qint64(0) << qint64(0);
+    QTest::newRow("64 x 64 KB, 50 ms latency") << 64 << qint64(64 * 1024) << false << qint64(50) << qint64(0);
+    QTest::newRow("4 x 2 MB, 2 MB/s") << 4 << qint64(2 * 1024 * 1024) << false << qint64(0) << qint64(2 * 1024 * 1024);
+}
+
+void tst_DownloadBenchmark::transfer()
+{
+    QFETCH(int, fileCount);
+    QFETCH(qint64, contentSize);
+    QFETCH(bool, chunked);
+    QFETCH(qint64, latency);
+    QFETCH(qint64, bandwidth);
+
+    // Given
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    auto server = new HttpTestServer();
+    server->setContentSize(contentSize);
+    server->setChunkedEncodingEnabled(chunked);
+    server->setLatency(latency);
+    server->setBandwidth(bandwidth);
+
+    QThread serverThread;
+    QVERIFY(startServer(serverThread, server));
+
+    DownloadManager target;
+    QSignalSpy spyJobFinished(&target, SIGNAL(jobFinished(IDownloadItem*)));
+
+    QList<IDownloadItem*> items;
+    for (int i = 0; i < fileCount; ++i) {
+        auto url = server->url(QString("/file%0.bin").arg(QString::number(i)));
+        items.append(createJob(&target, url, tempDir.path()));
+    }
+
+    StallMonitor monitor;
+    const auto allocationsBefore = s_allocationCount.load();
+    const auto cpuBefore = std::clock(); // process CPU time, including the server thread
+    QElapsedTimer wallClock;
+
+    // When
+    monitor.start();
+    wallClock.start();
+    target.append(items, true);
+
+    QTRY_COMPARE_WITH_TIMEOUT(spyJobFinished.count(), fileCount, 120000);
+
+    const auto elapsed = qMax(qint64(1), wallClock.elapsed());
+    const auto cpuMsec = 1000 * static_cast<qreal>(std::clock() - cpuBefore) / CLOCKS_PER_SEC;
+    const auto allocations = s_allocationCount.load() - allocationsBefore;
+    monitor.stop();
+
+    serverThread.quit();
+    serverThread.wait();
+
+    // Then
+    for (auto item : std::as_const(items)) {
+        auto downloadItem = static_cast<DownloadItem*>(item);
+        QCOMPARE(downloadItem->state(), IDownloadItem::Completed);
+        QFile file(downloadItem->localFullFileName());
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QCOMPARE(file.size(), contentSize);
+        QVERIFY(file.readAll() == HttpTestServer::content(0, contentSize));
+    }
+
+    const auto totalBytes = static_cast<qreal>(contentSize) * fileCount;
+    const auto megabytesPerSecond = totalBytes / (1024 * 1024) / (static_cast<qreal>(elapsed) / 1000);
+    const auto cpuPerGigabyte = cpuMsec / (totalBytes / (1024 * 1024 * 1024));
+
+    qInfo().noquote() << QString(
+        "%0: %1 MB/s, CPU %2 ms/GB, %3 allocations/MB, main thread stall max %4 ms (total %5 ms)")
+        .arg(QTest::currentDataTag(),
+             QString::number(megabytesPerSecond, 'f', 1),
+             QString::number(cpuPerGigabyte, 'f', 0),
+             QString::number(static_cast<qreal>(allocations) / (totalBytes / (1024 * 1024)), 'f', 0),
+             QString::number(monitor.maxStall()),
+             QString::number(monitor.totalStall()));
+
+    QTest::setBenchmarkResult(totalBytes * 1000 / static_cast<qreal>(elapsed), QTest::BytesPerSecond);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*
+ * Download many small files from the same host, with and without
+ * persistent connections: without keep-alive, each file pays
+ * a new TCP connection.
+ */
+void tst_DownloadBenchmark::connectionReuse_data()
+{
+    QTest::addColumn<bool>("keepAlive");
+
+    QTest::newRow("128 x 16 KB, Connection: close") << false;
+    QTest::newRow("128 x 16 KB, Connection: keep-alive") << true;
+}
+
+void tst_DownloadBenchmark::connectionReuse()
+{
+    QFETCH(bool, keepAlive);
+
+    // Given
+    const int fileCount = 128;
+    const qint64 contentSize = 16 * 1024;
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    auto server = new HttpTestServer();
+    server->setContentSize(contentSize);
+    server->setKeepAliveEnabled(keepAlive);
+
+    QThread serverThread;
+    QVERIFY(startServer(serverThread, server));
+
+    DownloadManager target;
+    QSignalSpy spyJobFinished(&target, SIGNAL(jobFinished(IDownloadItem*)));
+
+    QList<IDownloadItem*> items;
+    for (int i = 0; i < fileCount; ++i) {
+        auto url = server->url(QString("/file%0.bin").arg(QString::number(i)));
+        items.append(createJob(&target, url, tempDir.path()));
+    }
+
+    QElapsedTimer wallClock;
+
+    // When
+    wallClock.start();
+    target.append(items, true);
+
+    QTRY_COMPARE_WITH_TIMEOUT(spyJobFinished.count(), fileCount, 120000);
+
+    const auto elapsed = qMax(qint64(1), wallClock.elapsed());
+    auto connectionCount = server->connectionCount();
+    serverThread.quit();
+    serverThread.wait(); // server deleted here
+
+    // Then
+    for (auto item : std::as_const(items)) {
+        QCOMPARE(item->state(), IDownloadItem::Completed);
+    }
+    if (keepAlive) {
+        QVERIFY(connectionCount < fileCount);
+    } else {
+        QCOMPARE(connectionCount, fileCount);
+    }
+
+    qInfo().noquote() << QString("%0: %1 files/s, %2 connections")
+        .arg(QTest::currentDataTag(),
+             QString::number(1000 * static_cast<qreal>(fileCount) / static_cast<qreal>(elapsed), 'f', 1),
+             QString::number(connectionCount));
+
+    QTest::setBenchmarkResult(static_cast<qreal>(elapsed) / fileCount, QTest::WalltimeMilliseconds);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_DownloadBenchmark::resume_afterFailure()
+{
+    // Given
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    const qint64 contentSize = 8 * 1024 * 1024;
+    auto server = new HttpTestServer();
+    server->setContentSize(contentSize);
+    server->setFailures(1, 3 * 1024 * 1024); // closed after 3 MB
+
+    QThread serverThread;
+    QVERIFY(startServer(serverThread, server));
+
+    DownloadManager target;
+    target.retryPolicy()->setBaseDelay(10ms);
+    QSignalSpy spyJobFinished(&target, SIGNAL(jobFinished(IDownloadItem*)));
+
+    auto item = createJob(&target, server->url(), tempDir.path());
+
+    // When
+    target.append({item}, true);
+
+    // Then
+    QTRY_COMPARE_WITH_TIMEOUT(item->state(), IDownloadItem::Completed, 30000);
+
+    auto requestCount = server->requestCount();
+    auto rangeRequestCount = server->rangeRequestCount();
+    serverThread.quit();
+    serverThread.wait(); // server deleted here
+
+    QCOMPARE(requestCount, 2);
+    QCOMPARE(rangeRequestCount, 1); // resumed, not restarted
+
+    QFile file(item->localFullFileName());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.size(), contentSize);
+    QVERIFY(file.readAll() == HttpTestServer::content(0, contentSize));
+}
+
+void tst_DownloadBenchmark::resume_afterErrorPage()
+{
+    // Given
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    const qint64 contentSize = 8 * 1024 * 1024;
+    auto server = new HttpTestServer();
+    server->setContentSize(contentSize);
+    server->setFailures(2, 2 * 1024 * 1024); // 200 and 206, closed after 2 MB each
+    server->setErrorResponse(3, 503); // then 503, then 206 to the end
+
+    QThread serverThread;
+    QVERIFY(startServer(serverThread, server));
+
+    DownloadManager target;
+    target.retryPolicy()->setBaseDelay(10ms);
+
+    auto item = createJob(&target, server->url(), tempDir.path());
+
+    // When
+    target.append({item}, true);
+
+    // Then
+    QTRY_COMPARE_WITH_TIMEOUT(item->state(), IDownloadItem::Completed, 30000);
+
+    auto requestCount = server->requestCount();
+    auto rangeRequestCount = server->rangeRequestCount();
+    serverThread.quit();
+    serverThread.wait(); // server deleted here
+
+    QCOMPARE(requestCount, 4);
+    QCOMPARE(rangeRequestCount, 2); // the error page isn't a range
+
+    /* The error page isn't written, and the range continues the file */
+    QFile file(item->localFullFileName());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.size(), contentSize);
+    QVERIFY(file.readAll() == HttpTestServer::content(0, contentSize));
+}
+
+void tst_DownloadBenchmark::retry_stopDuringBackoff_data()
+{
+    QTest::addColumn<bool>("paused");
+    QTest::addColumn<IDownloadItem::State>("expected");
+
+    QTest::newRow("cancel") << false << IDownloadItem::Stopped;
+    QTest::newRow("pause") << true << IDownloadItem::Paused;
+}
+
+void tst_DownloadBenchmark::retry_stopDuringBackoff()
+{
+    QFETCH(bool, paused);
+    QFETCH(IDownloadItem::State, expected);
+
+    // Given
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    auto server = new HttpTestServer();
+    server->setContentSize(1024);
+    server->setErrorResponse(1, 503);
+
+    QThread serverThread;
+    QVERIFY(startServer(serverThread, server));
+
+    DownloadManager target;
+    target.retryPolicy()->setBaseDelay(1s);
+
+    auto item = createJob(&target, server->url(), tempDir.path());
+    target.append({item}, true);
+
+    QTRY_VERIFY_WITH_TIMEOUT(item->isRetryPending(), 10000);
+    QCOMPARE(item->state(), IDownloadItem::NetworkError);
+    QVERIFY(item->isPausable());
+    QVERIFY(item->isCancelable());
+
+    // When
+    if (paused) {
+        target.pause(item);
+    } else {
+        target.cancel(item);
+    }
+
+    // Then
+    QVERIFY(!item->isRetryPending());
+    QCOMPARE(item->state(), expected);
+
+    QTest::qWait(1500); // longer than the backoff
+    QCOMPARE(item->state(), expected);
+
+    auto requestCount = server->requestCount();
+    serverThread.quit();
+    serverThread.wait(); // server deleted here
+
+    QCOMPARE(requestCount, 1); // not retried
+}
+
+/******************************************************************************
+ ******************************************************************************/
+QTEST_MAIN(tst_DownloadBenchmark)
+
+#include "tst_downloadbenchmark.moc"
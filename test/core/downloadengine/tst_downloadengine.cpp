@@ -36,6 +36,8 @@ private slots:
     void initTestCase();
 
     void append();
+    void startNext_deferred();
+    void startNext_torrentSlots();
 
     void do_not_move();
     void moveCurrentTop();
@@ -97,6 +99,108 @@ void tst_DownloadEngine::append()
     QCOMPARE(item->bytesTotal(), bytesTotal);
 }
 
+/******************************************************************************
+ ******************************************************************************/
+class DeferringDownloadEngine : public DownloadEngine
+{
+public:
+    explicit DeferringDownloadEngine(QObject *parent) : DownloadEngine(parent) {}
+
+    QList<IDownloadItem*> prefetched;
+
+protected:
+    bool isDeferred(IDownloadItem *item) const override
+    {
+        return item->sourceUrl().host() == QLatin1String("deferred.example.com");
+    }
+
+    void prefetch(const QList<IDownloadItem*> &items) override
+    {
+        prefetched = items;
+    }
+};
+
+void tst_DownloadEngine::startNext_deferred()
+{
+    // Given
+    QScopedPointer<DeferringDownloadEngine> target(new DeferringDownloadEngine(this));
+    target->setMaxSimultaneousDownloads(1);
+
+    auto deferred = new FakeDownloadItem(
+                QUrl("http://deferred.example.com/a.png"), QLatin1String("a.png"), 1024, 100, 1000);
+    auto next = new FakeDownloadItem(
+                QUrl("http://www.example.com/b.png"), QLatin1String("b.png"), 1024, 100, 1000);
+    auto last = new FakeDownloadItem(
+                QUrl("http://www.example.com/c.png"), QLatin1String("c.png"), 1024, 100, 1000);
+
+    // When
+    target->append({deferred, next, last}, true);
+
+    // Then
+    QCOMPARE(deferred->state(), IDownloadItem::Idle); // skipped, but still queued
+    QCOMPARE(next->state(), IDownloadItem::Downloading);
+    QCOMPARE(last->state(), IDownloadItem::Idle);
+    QCOMPARE(target->prefetched, QList<IDownloadItem*>({deferred, last}));
+}
+
+/******************************************************************************
+ ******************************************************************************/
+class TorrentDownloadEngine : public DownloadEngine
+{
+public:
+    explicit TorrentDownloadEngine(QObject *parent) : DownloadEngine(parent) {}
+
+    using DownloadEngine::startNext;
+
+    QList<IDownloadItem*> stalled;
+
+protected:
+    bool isTorrent(IDownloadItem *item) const override
+    {
+        return item->sourceUrl().host() == QLatin1String("torrent.example.com");
+    }
+
+    bool isStalled(IDownloadItem *item) const override
+    {
+        return stalled.contains(item);
+    }
+};
+
+void tst_DownloadEngine::startNext_torrentSlots()
+{
+    // Given
+    QScopedPointer<TorrentDownloadEngine> target(new TorrentDownloadEngine(this));
+    target->setMaxSimultaneousDownloads(1);
+    target->setMaxSimultaneousTorrents(1);
+
+    auto torrent1 = new FakeDownloadItem(
+                QUrl("http://torrent.example.com/1"), QLatin1String("1"), 1024, 100, 10000);
+    auto torrent2 = new FakeDownloadItem(
+                QUrl("http://torrent.example.com/2"), QLatin1String("2"), 1024, 100, 10000);
+    auto http1 = new FakeDownloadItem(
+                QUrl("http://www.example.com/a.png"), QLatin1String("a.png"), 1024, 100, 10000);
+    auto http2 = new FakeDownloadItem(
+                QUrl("http://www.example.com/b.png"), QLatin1String("b.png"), 1024, 100, 10000);
+
+    // When
+    target->append({torrent1, torrent2, http1, http2}, true);
+
+    // Then
+    QCOMPARE(torrent1->state(), IDownloadItem::Downloading);
+    QCOMPARE(torrent2->state(), IDownloadItem::Idle);
+    QCOMPARE(http1->state(), IDownloadItem::Downloading); // not delayed by the torrents
+    QCOMPARE(http2->state(), IDownloadItem::Idle);
+
+    // When
+    target->stalled.append(torrent1);
+    target->startNext(nullptr);
+
+    // Then
+    QCOMPARE(torrent1->state(), IDownloadItem::Downloading); // still running
+    QCOMPARE(torrent2->state(), IDownloadItem::Downloading);
+    QCOMPARE(http2->state(), IDownloadItem::Idle);
+}
+
 /******************************************************************************
  ******************************************************************************/
 static void VERIFY_ORDER(const QScopedPointer<DownloadEngine> &engine, QList<int> indexes)
@@ -0,0 +1,102 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Core/DownloadTiming>
+
+#include <QtCore/QDebug>
+#include <QtTest/QtTest>
+
+class tst_DownloadTiming : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void defaults();
+    void total();
+    void toCsv();
+};
+
+/******************************************************************************
+ ******************************************************************************/
+static DownloadTiming createTiming(const QString &host, qint64 ttfb, qint64 transfer)
+{
+    DownloadTiming timing;
+    timing.setHost(host);
+    timing.setDuration(DownloadTiming::Queue, 0);
+    timing.setDuration(DownloadTiming::Ttfb, ttfb);
+    timing.setDuration(DownloadTiming::Transfer, transfer);
+    return timing;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_DownloadTiming::defaults()
+{
+    // Given
+    DownloadTiming target;
+
+    // When, Then
+    QVERIFY(target.isEmpty());
+    QCOMPARE(target.total(), qint64(0));
+    for (int i = 0; i < DownloadTiming::PhaseCount; ++i) {
+        QVERIFY(!target.isMeasured(static_cast<DownloadTiming::Phase>(i)));
+    }
+    QCOMPARE(target.duration(DownloadTiming::PhaseCount), qint64(-1));
+}
+
+void tst_DownloadTiming::total()
+{
+    // Given
+    DownloadTiming target;
+
+    // When
+    target.setDuration(DownloadTiming::Dns, 12);
+    target.setDuration(DownloadTiming::Connect, 30);
+    target.setDuration(DownloadTiming::Ttfb, 100);
+    target.setDuration(DownloadTiming::Commit, -5); // clamped
+
+    // Then
+    QVERIFY(!target.isEmpty());
+    QVERIFY(!target.isMeasured(DownloadTiming::Transfer));
+    QVERIFY(!target.isMeasured(DownloadTiming::Commit));
+    QCOMPARE(target.total(), qint64(142));
+}
+
+void tst_DownloadTiming::toCsv()
+{
+    // Given
+    QList<DownloadTiming> timings = {
+        createTiming("fast.example.com", 10, 100),
+        createTiming("slow.example.com", 2000, 5000),
+        createTiming("slow.example.com", 1000, 3000),
+        DownloadTiming() // not started: ignored
+    };
+
+    // When
+    auto actual = DownloadTiming::toCsv(timings).split('\n', Qt::SkipEmptyParts);
+
+    // Then
+    QCOMPARE(actual.count(), 3);
+    QVERIFY(actual.at(0).startsWith("host,requests,mean_total_ms,queue_mean_ms,queue_max_ms,dns_mean_ms"));
+    QCOMPARE(actual.at(1), QString("slow.example.com,2,5500,0,0,,,,,1500,2000,4000,5000,,"));
+    QCOMPARE(actual.at(2), QString("fast.example.com,1,110,0,0,,,,,10,10,100,100,,"));
+}
+
+/******************************************************************************
+ ******************************************************************************/
+QTEST_APPLESS_MAIN(tst_DownloadTiming)
+
+#include "tst_downloadtiming.moc"
@@ -0,0 +1,123 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Core/HostResolver>
+
+#include <QtCore/QDebug>
+#include <QtTest/QSignalSpy>
+#include <QtTest/QtTest>
+
+using namespace std::chrono_literals;
+
+void hideQDebugMessage(QtMsgType, const QMessageLogContext &, const QString &)
+{
+    /*
+     * Do nothing: just hide QDebug messages,
+     * to diminish visual pollution in the test
+     */
+}
+
+class tst_HostResolver : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {
+        qInstallMessageHandler(hideQDebugMessage);
+    }
+
+    void prefetch_ipAddress();
+    void prefetch_localhost();
+    void prefetch_invalid();
+    void expiry();
+};
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_HostResolver::prefetch_ipAddress()
+{
+    // Given
+    HostResolver target(this);
+    QSignalSpy spyResolved(&target, SIGNAL(resolved(QString,bool)));
+
+    // When
+    target.prefetch("127.0.0.1");
+
+    // Then
+    QCOMPARE(spyResolved.count(), 0); // nothing to resolve
+    QCOMPARE(target.status("127.0.0.1"), HostResolver::Status::Resolved);
+    QCOMPARE(target.addresses("127.0.0.1"), QList<QHostAddress>({QHostAddress::LocalHost}));
+    QVERIFY(!target.isDeferred("127.0.0.1"));
+}
+
+void tst_HostResolver::prefetch_localhost()
+{
+    // Given
+    HostResolver target(this);
+    QSignalSpy spyResolved(&target, SIGNAL(resolved(QString,bool)));
+
+    // When
+    target.prefetch("localhost");
+    target.prefetch("localhost"); // no duplicate lookup
+
+    // Then
+    QCOMPARE(target.status("localhost"), HostResolver::Status::Pending);
+    QVERIFY(spyResolved.wait(5000));
+    QCOMPARE(spyResolved.count(), 1);
+    QCOMPARE(spyResolved.at(0).at(0).toString(), QString("localhost"));
+    QCOMPARE(spyResolved.at(0).at(1).toBool(), true);
+    QCOMPARE(target.status("localhost"), HostResolver::Status::Resolved);
+    QVERIFY(!target.addresses("localhost").isEmpty());
+    QVERIFY(!target.isDeferred("localhost"));
+}
+
+void tst_HostResolver::prefetch_invalid()
+{
+    // Given
+    HostResolver target(this);
+    QSignalSpy spyResolved(&target, SIGNAL(resolved(QString,bool)));
+
+    // When
+    target.prefetch("host.invalid"); // RFC 2606: guaranteed to fail
+
+    // Then
+    QVERIFY(spyResolved.wait(10000));
+    QCOMPARE(spyResolved.at(0).at(1).toBool(), false);
+    QCOMPARE(target.status("host.invalid"), HostResolver::Status::Failed);
+    QVERIFY(target.isDeferred("host.invalid"));
+    QVERIFY(!target.isDeferred("unknown.example.com"));
+}
+
+void tst_HostResolver::expiry()
+{
+    // Given
+    HostResolver target(this);
+    target.setTimeToLive(0s);
+    QSignalSpy spyResolved(&target, SIGNAL(resolved(QString,bool)));
+
+    // When
+    target.prefetch("localhost");
+
+    // Then
+    QVERIFY(spyResolved.wait(5000));
+    QCOMPARE(target.status("localhost"), HostResolver::Status::Unknown);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+QTEST_MAIN(tst_HostResolver)
+
+#include "tst_hostresolver.moc"
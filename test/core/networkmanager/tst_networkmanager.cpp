@@ -0,0 +1,151 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Constants>
+#include <Core/NetworkManager>
+#include <Core/Settings>
+
+#include <QtCore/QDebug>
+#include <QtNetwork/QNetworkRequest>
+#include <QtNetwork/QSslConfiguration>
+#include <QtTest/QtTest>
+
+class tst_NetworkManager : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void request_default();
+    void request_settings();
+    void request_referer();
+    void isProxyEnabled();
+
+    void benchmark_request_fresh();
+    void benchmark_request_shared();
+};
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_NetworkManager::request_default()
+{
+    // Given
+    NetworkManager target(this);
+
+    // When
+    auto actual = target.request(QUrl("https://www.example.com/favicon.ico"));
+
+    // Then
+    QCOMPARE(actual.url(), QUrl("https://www.example.com/favicon.ico"));
+    QCOMPARE(actual.maximumRedirectsAllowed(), MAX_REDIRECTS_ALLOWED);
+    QCOMPARE(actual.attribute(QNetworkRequest::Http2AllowedAttribute).toBool(), false);
+    QCOMPARE(actual.sslConfiguration().testSslOption(QSsl::SslOptionDisableSessionPersistence), false);
+    QCOMPARE(actual.sslConfiguration().testSslOption(QSsl::SslOptionDisableSessionTickets), false);
+}
+
+void tst_NetworkManager::request_settings()
+{
+    // Given
+    Settings settings(this);
+    NetworkManager target(this);
+    target.setSettings(&settings);
+
+    // When
+    settings.setHttp2Enabled(true);
+    settings.setTlsSessionResumptionEnabled(false);
+    auto actual = target.request(QUrl("https://www.example.com/favicon.ico"));
+
+    // Then
+    QCOMPARE(actual.attribute(QNetworkRequest::Http2AllowedAttribute).toBool(), true);
+    QCOMPARE(actual.sslConfiguration().testSslOption(QSsl::SslOptionDisableSessionPersistence), true);
+    QCOMPARE(actual.sslConfiguration().testSslOption(QSsl::SslOptionDisableSessionTickets), true);
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+    QCOMPARE(actual.http1Configuration().numberOfConnectionsPerHost(),
+             qsizetype(DEFAULT_CONNECTIONS_PER_HOST));
+
+    settings.setConnectionsPerHost(12);
+    actual = target.request(QUrl("https://www.example.com/favicon.ico"));
+    QCOMPARE(actual.http1Configuration().numberOfConnectionsPerHost(), qsizetype(12));
+#endif
+}
+
+void tst_NetworkManager::request_referer()
+{
+    // Given
+    NetworkManager target(this);
+
+    // When
+    auto actual = target.request(QUrl("https://www.example.com/a.png"), "https://www.example.com/");
+    auto next = target.request(QUrl("https://www.example.com/b.png"));
+
+    // Then
+    QCOMPARE(actual.rawHeader("Referer"), QByteArray("https://www.example.com/"));
+    QVERIFY(!next.hasRawHeader("Referer")); // the template is not modified
+}
+
+void tst_NetworkManager::isProxyEnabled()
+{
+    // Given
+    Settings settings(this);
+    NetworkManager target(this);
+    QVERIFY(!target.isProxyEnabled());
+    target.setSettings(&settings);
+    QVERIFY(!target.isProxyEnabled());
+
+    // When
+    settings.setProxyType(1); // SOCKS5
+
+    // Then
+    QVERIFY(target.isProxyEnabled());
+
+    settings.setProxyType(0);
+    QVERIFY(!target.isProxyEnabled());
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*
+ * Compare the cost of building a request from scratch
+ * (previous behavior, SSL configuration copied for each request)
+ * with the cost of copying the shared template.
+ */
+void tst_NetworkManager::benchmark_request_fresh()
+{
+    const QUrl url("https://www.example.com/image.png");
+    QBENCHMARK {
+        QNetworkRequest request;
+        request.setUrl(url);
+        request.setHeader(QNetworkRequest::UserAgentHeader, QLatin1String("Mozilla/5.0"));
+        request.setSslConfiguration(QSslConfiguration::defaultConfiguration());
+        request.setMaximumRedirectsAllowed(MAX_REDIRECTS_ALLOWED);
+        request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+    }
+}
+
+void tst_NetworkManager::benchmark_request_shared()
+{
+    NetworkManager target(this);
+    const QUrl url("https://www.example.com/image.png");
+    QBENCHMARK {
+        auto request = target.request(url);
+        Q_UNUSED(request)
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+QTEST_MAIN(tst_NetworkManager)
+
+#include "tst_networkmanager.moc"
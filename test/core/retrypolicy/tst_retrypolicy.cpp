@@ -0,0 +1,230 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Core/RetryPolicy>
+
+#include <QtCore/QDebug>
+#include <QtTest/QSignalSpy>
+#include <QtTest/QtTest>
+
+using namespace std::chrono_literals;
+
+Q_DECLARE_METATYPE(RetryPolicy::ErrorClass)
+
+class tst_RetryPolicy : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void classify_data();
+    void classify();
+
+    void canRetry();
+    void backoff();
+    void nextDelay_retryAfter();
+
+    void parseRetryAfter_data();
+    void parseRetryAfter();
+
+    void circuitBreaker();
+    void circuitBreaker_closed();
+};
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_RetryPolicy::classify_data()
+{
+    QTest::addColumn<QNetworkReply::NetworkError>("error");
+    QTest::addColumn<int>("statusCode");
+    QTest::addColumn<RetryPolicy::ErrorClass>("expected");
+
+    QTest::newRow("timeout") << QNetworkReply::TimeoutError << 0 << RetryPolicy::ErrorClass::Timeout;
+    QTest::newRow("transfer timeout") << QNetworkReply::OperationCanceledError << 0 << RetryPolicy::ErrorClass::Timeout;
+    QTest::newRow("408") << QNetworkReply::UnknownContentError << 408 << RetryPolicy::ErrorClass::Timeout;
+    QTest::newRow("504") << QNetworkReply::UnknownServerError << 504 << RetryPolicy::ErrorClass::Timeout;
+
+    QTest::newRow("500") << QNetworkReply::InternalServerError << 500 << RetryPolicy::ErrorClass::ServerError;
+    QTest::newRow("502") << QNetworkReply::UnknownServerError << 502 << RetryPolicy::ErrorClass::ServerError;
+    QTest::newRow("503") << QNetworkReply::ServiceUnavailableError << 503 << RetryPolicy::ErrorClass::ServerError;
+
+    QTest::newRow("429") << QNetworkReply::UnknownContentError << 429 << RetryPolicy::ErrorClass::TooManyRequests;
+
+    QTest::newRow("reset") << QNetworkReply::RemoteHostClosedError << 0 << RetryPolicy::ErrorClass::ConnectionReset;
+    QTest::newRow("network") << QNetworkReply::TemporaryNetworkFailureError << 0 << RetryPolicy::ErrorClass::ConnectionReset;
+
+    QTest::newRow("404") << QNetworkReply::ContentNotFoundError << 404 << RetryPolicy::ErrorClass::None;
+    QTest::newRow("403") << QNetworkReply::ContentAccessDenied << 403 << RetryPolicy::ErrorClass::None;
+    QTest::newRow("501") << QNetworkReply::OperationNotImplementedError << 501 << RetryPolicy::ErrorClass::None;
+    QTest::newRow("host not found") << QNetworkReply::HostNotFoundError << 0 << RetryPolicy::ErrorClass::None;
+    QTest::newRow("ssl") << QNetworkReply::SslHandshakeFailedError << 0 << RetryPolicy::ErrorClass::None;
+}
+
+void tst_RetryPolicy::classify()
+{
+    QFETCH(QNetworkReply::NetworkError, error);
+    QFETCH(int, statusCode);
+    QFETCH(RetryPolicy::ErrorClass, expected);
+
+    auto actual = RetryPolicy::classify(error, statusCode);
+
+    QCOMPARE(actual, expected);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_RetryPolicy::canRetry()
+{
+    // Given
+    RetryPolicy target;
+    target.setMaxAttempts(3);
+    target.setRetryEnabled(RetryPolicy::ErrorClass::ConnectionReset, false);
+
+    // When, Then
+    QVERIFY(target.canRetry(RetryPolicy::ErrorClass::Timeout, 0));
+    QVERIFY(target.canRetry(RetryPolicy::ErrorClass::Timeout, 2));
+    QVERIFY(!target.canRetry(RetryPolicy::ErrorClass::Timeout, 3));
+    QVERIFY(!target.canRetry(RetryPolicy::ErrorClass::None, 0));
+    QVERIFY(!target.canRetry(RetryPolicy::ErrorClass::ConnectionReset, 0));
+
+    target.setEnabled(false);
+    QVERIFY(!target.canRetry(RetryPolicy::ErrorClass::Timeout, 0));
+}
+
+void tst_RetryPolicy::backoff()
+{
+    // Given
+    RetryPolicy target;
+    target.setBaseDelay(1000ms);
+    target.setMaxDelay(10000ms);
+
+    // When, Then
+    for (int i = 0; i < 100; ++i) {
+        auto delay0 = target.backoff(0);
+        QVERIFY(delay0 >= 500ms && delay0 <= 1000ms);
+
+        auto delay2 = target.backoff(2);
+        QVERIFY(delay2 >= 2000ms && delay2 <= 4000ms);
+
+        auto delay10 = target.backoff(10); // capped
+        QVERIFY(delay10 >= 5000ms && delay10 <= 10000ms);
+    }
+}
+
+void tst_RetryPolicy::nextDelay_retryAfter()
+{
+    // Given
+    RetryPolicy target;
+    target.setBaseDelay(100ms);
+    target.setMaxDelay(60000ms);
+
+    // When
+    auto throttled = target.nextDelay(RetryPolicy::ErrorClass::TooManyRequests, 0, "example.com", 30000ms);
+    auto timeout = target.nextDelay(RetryPolicy::ErrorClass::Timeout, 0, "example.com", 30000ms);
+    auto capped = target.nextDelay(RetryPolicy::ErrorClass::TooManyRequests, 0, "example.com", 3600000ms);
+
+    // Then
+    QCOMPARE(throttled, 30000ms);
+    QVERIFY(timeout <= 100ms); // Retry-After is ignored
+    QCOMPARE(capped, 60000ms);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_RetryPolicy::parseRetryAfter_data()
+{
+    QTest::addColumn<QByteArray>("value");
+    QTest::addColumn<qint64>("expected");
+
+    QTest::newRow("empty") << QByteArray() << qint64(0);
+    QTest::newRow("invalid") << QByteArray("soon") << qint64(0);
+    QTest::newRow("seconds") << QByteArray("120") << qint64(120000);
+    QTest::newRow("seconds spaces") << QByteArray(" 5 ") << qint64(5000);
+    QTest::newRow("negative") << QByteArray("-5") << qint64(0);
+    QTest::newRow("date") << QByteArray("Wed, 21 Oct 2015 07:28:30 GMT") << qint64(30000);
+    QTest::newRow("date past") << QByteArray("Wed, 21 Oct 2015 07:27:00 GMT") << qint64(0);
+}
+
+void tst_RetryPolicy::parseRetryAfter()
+{
+    QFETCH(QByteArray, value);
+    QFETCH(qint64, expected);
+
+    QDateTime now(QDate(2015, 10, 21), QTime(7, 28, 0), QTimeZone::utc());
+
+    auto actual = RetryPolicy::parseRetryAfter(value, now);
+
+    QCOMPARE(actual.count(), expected);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_RetryPolicy::circuitBreaker()
+{
+    // Given
+    RetryPolicy target;
+    target.setCircuitBreakerThreshold(3);
+    target.setCircuitBreakerCooldown(60000ms);
+
+    // When
+    target.recordFailure("a.example.com");
+    target.recordFailure("a.example.com");
+    target.recordFailure("b.example.com");
+
+    // Then
+    QVERIFY(!target.isCircuitOpen("a.example.com"));
+    QVERIFY(!target.isCircuitOpen("b.example.com"));
+
+    // When
+    target.recordFailure("a.example.com");
+
+    // Then
+    QVERIFY(target.isCircuitOpen("a.example.com"));
+    QVERIFY(!target.isCircuitOpen("b.example.com"));
+    QVERIFY(target.nextDelay(RetryPolicy::ErrorClass::Timeout, 0, "a.example.com") > 50000ms);
+
+    // When
+    target.recordSuccess("a.example.com");
+
+    // Then
+    QVERIFY(!target.isCircuitOpen("a.example.com"));
+}
+
+void tst_RetryPolicy::circuitBreaker_closed()
+{
+    // Given
+    RetryPolicy target;
+    target.setCircuitBreakerThreshold(1);
+    target.setCircuitBreakerCooldown(100ms);
+    QSignalSpy spyCircuitClosed(&target, SIGNAL(circuitClosed(QString)));
+
+    // When
+    target.recordFailure("a.example.com");
+
+    // Then
+    QVERIFY(target.isCircuitOpen("a.example.com"));
+    QVERIFY(spyCircuitClosed.wait(5000));
+    QVERIFY(!target.isCircuitOpen("a.example.com"));
+    QCOMPARE(spyCircuitClosed.first().first().toString(), QString("a.example.com"));
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*
+ * QSignalSpy::wait() requires QTEST_MAIN instead of QTEST_APPLESS_MAIN
+ */
+QTEST_MAIN(tst_RetryPolicy)
+
+#include "tst_retrypolicy.moc"
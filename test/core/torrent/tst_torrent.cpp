@@ -0,0 +1,277 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Core/Torrent>
+
+#include <QtCore/QDebug>
+#include <QtTest/QSignalSpy>
+#include <QtTest/QtTest>
+
+class tst_Torrent : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void preferredFilePriorities();
+    void setFilePriority_outOfRange();
+    void setPreferredFilePriorities();
+
+    void fileModel_refreshData();
+    void peerModel_refreshData();
+
+    void status_changesSince();
+    void recheckInfo_update();
+
+private:
+    static TorrentHandleInfo createDetail(qsizetype fileCount);
+    static QList<TorrentPeerInfo> createPeers(qsizetype peerCount);
+    static TorrentMetaInfo createMetaInfo(qsizetype fileCount);
+};
+
+/******************************************************************************
+ ******************************************************************************/
+TorrentHandleInfo tst_Torrent::createDetail(qsizetype fileCount)
+{
+    TorrentHandleInfo detail;
+    for (qsizetype i = 0; i < fileCount; ++i) {
+        detail.files.append(TorrentFileInfo());
+    }
+    return detail;
+}
+
+QList<TorrentPeerInfo> tst_Torrent::createPeers(qsizetype peerCount)
+{
+    QList<TorrentPeerInfo> peers;
+    for (qsizetype i = 0; i < peerCount; ++i) {
+        peers.append(TorrentPeerInfo(EndPoint("10.0.0.1", 6881 + static_cast<int>(i)), "client"));
+    }
+    return peers;
+}
+
+TorrentMetaInfo tst_Torrent::createMetaInfo(qsizetype fileCount)
+{
+    TorrentMetaInfo metaInfo;
+    for (qsizetype i = 0; i < fileCount; ++i) {
+        metaInfo.initialMetaInfo.files.append(TorrentFileMetaInfo());
+    }
+    return metaInfo;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_Torrent::preferredFilePriorities()
+{
+    // Given
+    Torrent target;
+    target.setDetail(createDetail(3), false);
+    QCOMPARE(target.preferredFilePriorities(), QString("NNN"));
+
+    // When
+    target.setFilePriority(1, TorrentFileInfo::High);
+
+    // Then
+    QCOMPARE(target.preferredFilePriorities(), QString("NHN"));
+
+    // When
+    auto detail = target.detail();
+    detail.files[2].priority = TorrentFileInfo::Ignore;
+    target.setDetail(detail, false);
+
+    // Then
+    QCOMPARE(target.preferredFilePriorities(), QString("NH-"));
+}
+
+void tst_Torrent::setFilePriority_outOfRange()
+{
+    // Given
+    Torrent target;
+    target.setDetail(createDetail(2), false);
+
+    // When
+    target.setFilePriority(2, TorrentFileInfo::High);
+    target.setFilePriority(-1, TorrentFileInfo::High);
+
+    // Then
+    QCOMPARE(target.preferredFilePriorities(), QString("NN"));
+    QCOMPARE(target.filePriority(2), TorrentFileInfo::Normal);
+}
+
+void tst_Torrent::setPreferredFilePriorities()
+{
+    // Given
+    Torrent target;
+    target.setDetail(createDetail(4), false);
+    QSignalSpy spyChanged(&target, SIGNAL(changed()));
+
+    // When
+    target.setPreferredFilePriorities("H-L"); // shorter than the file list
+
+    // Then
+    QCOMPARE(spyChanged.count(), 1);
+    QCOMPARE(target.preferredFilePriorities(), QString("H-LN"));
+    QCOMPARE(target.filePriority(1), TorrentFileInfo::Ignore);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_Torrent::fileModel_refreshData()
+{
+    // Given
+    Torrent target;
+    target.setMetaInfo(createMetaInfo(6));
+    target.setDetail(createDetail(6), false);
+    auto model = target.fileModel();
+    QSignalSpy spy(model, SIGNAL(dataChanged(QModelIndex,QModelIndex,QList<int>)));
+
+    // When
+    auto detail = target.detail();
+    detail.files[1].bytesReceived = 100;
+    detail.files[2].bytesReceived = 200;
+    detail.files[4].priority = TorrentFileInfo::Low;
+    target.setDetail(detail, false);
+
+    // Then
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(0).at(0).toModelIndex().row(), 1);
+    QCOMPARE(spy.at(0).at(1).toModelIndex().row(), 2);
+    QCOMPARE(spy.at(1).at(0).toModelIndex().row(), 4);
+    QCOMPARE(spy.at(1).at(1).toModelIndex().row(), 4);
+
+    // When
+    spy.clear();
+    target.setDetail(detail, false);
+
+    // Then
+    QCOMPARE(spy.count(), 0);
+}
+
+void tst_Torrent::peerModel_refreshData()
+{
+    // Given
+    Torrent target;
+    auto detail = target.detail();
+    detail.peers = createPeers(5);
+    target.setDetail(detail, false);
+    auto model = target.peerModel();
+    QCOMPARE(model->rowCount(), 5);
+    QSignalSpy spy(model, SIGNAL(dataChanged(QModelIndex,QModelIndex,QList<int>)));
+
+    // When
+    detail.peers[1].bytesDownloaded = 100;
+    detail.peers[2].bytesDownloaded = 200;
+    detail.peers[4].bytesUploaded = 300;
+    target.setDetail(detail, false);
+
+    // Then
+    QCOMPARE(model->rowCount(), 5);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(0).at(0).toModelIndex(), model->index(1, 3));
+    QCOMPARE(spy.at(0).at(1).toModelIndex(), model->index(2, 3));
+    QCOMPARE(spy.at(1).at(0).toModelIndex(), model->index(4, 4));
+    QCOMPARE(spy.at(1).at(1).toModelIndex(), model->index(4, 4));
+
+    // When
+    spy.clear();
+    target.setDetail(detail, false);
+
+    // Then
+    QCOMPARE(spy.count(), 0);
+
+    // When
+    detail.peers.removeAt(3);
+    target.setDetail(detail, false);
+
+    // Then
+    QCOMPARE(model->rowCount(), 5); // disconnected, but still listed
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toModelIndex(), model->index(3, 0));
+    QCOMPARE(spy.at(0).at(1).toModelIndex(), model->index(3, model->columnCount() - 1));
+    QCOMPARE(model->index(3, 0).data(AbstractTorrentTableModel::ConnectRole).toBool(), false);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_Torrent::status_changesSince()
+{
+    // Given
+    TorrentStatus previous;
+    previous.info.percent = 10;
+    previous.info.downloadedPieces = QBitArray(8, false);
+    previous.detail = createDetail(2);
+    previous.hasDetail = true;
+
+    // When, Then
+    auto target = previous;
+    QCOMPARE(target.changesSince(previous), int(TorrentStatus::NoChange));
+
+    target = previous;
+    target.info.percent = 20;
+    QCOMPARE(target.changesSince(previous), int(TorrentStatus::InfoChanged));
+
+    target = previous;
+    target.info.downloadedPieces.setBit(3);
+    QCOMPARE(target.changesSince(previous), int(TorrentStatus::PiecesChanged));
+
+    target = previous;
+    target.detail.files[1].bytesReceived = 100;
+    QCOMPARE(target.changesSince(previous), int(TorrentStatus::DetailChanged));
+
+    target = previous;
+    target.detail = {};
+    target.hasDetail = false; // unsubscribed: the detail isn't compared
+    QCOMPARE(target.changesSince(previous), int(TorrentStatus::NoChange));
+
+    previous.hasDetail = false;
+    target = previous;
+    target.hasDetail = true; // subscribed again
+    QCOMPARE(target.changesSince(previous), int(TorrentStatus::DetailChanged));
+}
+
+void tst_Torrent::recheckInfo_update()
+{
+    // Given
+    TorrentRecheckInfo target;
+    target.bytesTotal = 1000000;
+
+    // When
+    target.update(25, 500);
+
+    // Then
+    QCOMPARE(target.bytesChecked, qsizetype(250000));
+    QCOMPARE(target.speed, qreal(500000)); // bytes per second
+    QCOMPARE(target.remainingTime(), QTime(0, 0, 2));
+
+    // When
+    target.update(0, 0);
+
+    // Then
+    QCOMPARE(target.bytesChecked, qsizetype(0));
+    QCOMPARE(target.speed, qreal(0));
+    QVERIFY(!target.remainingTime().isValid());
+
+    // When
+    target.update(120, 1000); // clamped
+
+    // Then
+    QCOMPARE(target.bytesChecked, qsizetype(1000000));
+    QCOMPARE(target.remainingTime(), QTime(0, 0, 0));
+}
+
+/******************************************************************************
+ ******************************************************************************/
+QTEST_APPLESS_MAIN(tst_Torrent)
+
+#include "tst_torrent.moc"
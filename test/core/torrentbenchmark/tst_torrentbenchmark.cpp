@@ -0,0 +1,159 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "../../../src/core/torrentcontext_p.h"
+
+#include "libtorrent/add_torrent_params.hpp"
+#include "libtorrent/download_priority.hpp" // lt::dont_download
+#include "libtorrent/session.hpp"
+#include "libtorrent/session_params.hpp"
+#include "libtorrent/settings_pack.hpp"
+#include "libtorrent/torrent_handle.hpp"
+
+#include <QtCore/QDebug>
+#include <QtTest/QtTest>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+/******************************************************************************
+ ******************************************************************************/
+/*
+ * Count the bytes kept on the heap by the whole process (all threads).
+ * Each block starts with its size, so that the freed bytes are subtracted.
+ */
+static std::atomic<qint64> s_liveBytes = 0;
+
+static constexpr std::size_t HEADER_SIZE = alignof(std::max_align_t);
+
+void* operator new(std::size_t size)
+{
+    if (auto ptr = static_cast<char*>(std::malloc(HEADER_SIZE + size))) {
+        *reinterpret_cast<std::size_t*>(ptr) = size;
+        s_liveBytes.fetch_add(static_cast<qint64>(size), std::memory_order_relaxed);
+        return ptr + HEADER_SIZE;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    if (ptr) {
+        auto block = static_cast<char*>(ptr) - HEADER_SIZE;
+        auto size = *reinterpret_cast<std::size_t*>(block);
+        s_liveBytes.fetch_sub(static_cast<qint64>(size), std::memory_order_relaxed);
+        std::free(block);
+    }
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+static const QString s_magnetLink = QString(
+        "magnet:?xt=urn:btih:dd8255ecdc7ca55fb0bbf81323d87062db1f6d1c"
+        "&dn=Big+Buck+Bunny&tr=udp%3A%2F%2Fexplodie.org%3A6969");
+
+class tst_TorrentBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void memoryPerPendingMagnet();
+
+private:
+    static qint64 bytesPerPendingMagnet(int count, bool withPriorities);
+};
+
+/******************************************************************************
+ ******************************************************************************/
+/*
+ * Returns the heap bytes that a session keeps for each magnet link
+ * waiting for its metadata.
+ *
+ * The torrents are paused, and the session only listens on the loopback:
+ * nothing is downloaded, and the metadata never arrives.
+ */
+qint64 tst_TorrentBenchmark::bytesPerPendingMagnet(int count, bool withPriorities)
+{
+    lt::settings_pack pack;
+    pack.set_str(lt::settings_pack::listen_interfaces, "127.0.0.1:0");
+    pack.set_bool(lt::settings_pack::enable_dht, false);
+    pack.set_bool(lt::settings_pack::enable_lsd, false);
+    pack.set_bool(lt::settings_pack::enable_upnp, false);
+    pack.set_bool(lt::settings_pack::enable_natpmp, false);
+    pack.set_int(lt::settings_pack::alert_mask, lt::alert_category_t{});
+    lt::session session(lt::session_params(std::move(pack)));
+
+    std::vector<lt::torrent_handle> handles;
+    handles.reserve(static_cast<std::size_t>(count));
+
+    auto before = s_liveBytes.load();
+    for (auto i = 0; i < count; ++i) {
+        lt::error_code ec;
+        auto p = TorrentUtils::fromMagnetUri(s_magnetLink, ec);
+        if (ec) {
+            return -1;
+        }
+        p.info_hashes.v1[0] = static_cast<std::uint8_t>(i); // one torrent per magnet
+        p.info_hashes.v1[1] = static_cast<std::uint8_t>(i >> 8);
+        p.flags |= lt::torrent_flags::paused;
+        if (withPriorities) {
+            /* Previous behavior: download nothing but the metadata */
+            p.flags &= ~lt::torrent_flags::upload_mode;
+            p.file_priorities.assign(1000000, lt::dont_download);
+        }
+        handles.push_back(session.add_torrent(std::move(p)));
+    }
+    return (s_liveBytes.load() - before) / count;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*
+ * Regression: the session kept more than 1 MB for each magnet link
+ * waiting for its metadata (a vector of 1,000,000 priorities).
+ * The magnet links are now added in upload mode, without priorities.
+ */
+void tst_TorrentBenchmark::memoryPerPendingMagnet()
+{
+    // Given
+    const int count = 50;
+
+    // When
+    auto legacyBytes = bytesPerPendingMagnet(count, true);
+    auto actualBytes = bytesPerPendingMagnet(count, false);
+
+    // Then
+    qInfo() << "Memory kept per pending magnet:" << actualBytes << "bytes,"
+            << "with the priorities:" << legacyBytes << "bytes";
+    QTest::setBenchmarkResult(static_cast<qreal>(actualBytes), QTest::BytesAllocated);
+    QVERIFY(actualBytes > 0);
+    QVERIFY(legacyBytes >= 1000000);
+    QVERIFY(actualBytes < 64 * 1024);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+QTEST_APPLESS_MAIN(tst_TorrentBenchmark)
+
+#include "tst_torrentbenchmark.moc"
@@ -17,13 +17,20 @@
 //#include <Core/TorrentContext>
 #include "../../../src/core/torrentcontext_p.h"
 
+#include "libtorrent/add_torrent_params.hpp"
 #include "libtorrent/bitfield.hpp"      // lt::typed_bitfield
 
 #include <QtCore/QDebug>
 #include <QtTest/QtTest>
 
+#include <map>
+
 using namespace Qt::Literals::StringLiterals;
 
+static const QString s_magnetLink = QString(
+        "magnet:?xt=urn:btih:dd8255ecdc7ca55fb0bbf81323d87062db1f6d1c"
+        "&dn=Big+Buck+Bunny&tr=udp%3A%2F%2Fexplodie.org%3A6969");
+
 class tst_TorrentContext : public QObject
 {
     Q_OBJECT
@@ -31,7 +38,13 @@ class tst_TorrentContext : public QObject
 private slots:
     void toBitArray_data();
     void toBitArray();
+    void toBitArray_map_data();
+    void toBitArray_map();
     void dump_invalid();
+
+    void fromMagnetUri();
+    void setQueueFlags_magnet();
+    void setQueueFlags_torrentFile();
 };
 
 class FriendlyWorkerThread : public WorkerThread
@@ -83,6 +96,15 @@ void tst_TorrentContext::toBitArray_data()
     QTest::newRow("data12") << QStringToQBitArray(QString("11100011011"));
     QTest::newRow("data13") << QStringToQBitArray(QString("00101100111"));
     QTest::newRow("data14") << QStringToQBitArray(QString("01000010111"));
+
+    QTest::newRow("word") << QStringToQBitArray(QString("10000000000000000000000000000001"));
+    QTest::newRow("word+1") << QStringToQBitArray(QString("100000000000000000000000000000011"));
+
+    QString large;
+    for (auto i = 0; i < 1000; ++i) {
+        large.append((i % 3 == 0 || i % 7 == 0) ? '1' : '0');
+    }
+    QTest::newRow("large") << QStringToQBitArray(large);
 }
 
 void tst_TorrentContext::toBitArray()
@@ -104,6 +126,34 @@ void tst_TorrentContext::toBitArray()
     QCOMPARE(actual, expected);
 }
 
+void tst_TorrentContext::toBitArray_map_data()
+{
+    QTest::addColumn<QList<int>>("indexes");
+    QTest::addColumn<QBitArray>("expected");
+
+    QTest::newRow("empty") << QList<int>() << QBitArray();
+    QTest::newRow("first") << QList<int>({0}) << QStringToQBitArray(QString("1"));
+    QTest::newRow("last") << QList<int>({4}) << QStringToQBitArray(QString("00001"));
+    QTest::newRow("several") << QList<int>({1, 3, 8}) << QStringToQBitArray(QString("010100001"));
+}
+
+void tst_TorrentContext::toBitArray_map()
+{
+    // Given
+    QFETCH(QList<int>, indexes);
+    QFETCH(QBitArray, expected);
+    std::map<lt::piece_index_t, lt::bitfield> map;
+    for (auto index : indexes) {
+        map[static_cast<lt::piece_index_t>(index)] = lt::bitfield(16, true);
+    }
+
+    // When
+    QBitArray actual = TorrentUtils::toBitArray(map);
+
+    // Then
+    QCOMPARE(actual, expected);
+}
+
 /******************************************************************************
  ******************************************************************************/
 void tst_TorrentContext::dump_invalid()
@@ -122,6 +172,54 @@ void tst_TorrentContext::dump_invalid()
     QCOMPARE(actual, expected);
 }
 
+/******************************************************************************
+ ******************************************************************************/
+void tst_TorrentContext::fromMagnetUri()
+{
+    // Given
+    lt::error_code ec;
+
+    // When
+    auto actual = TorrentUtils::fromMagnetUri(s_magnetLink, ec);
+
+    // Then
+    QVERIFY(!ec);
+    QCOMPARE(TorrentUtils::toString(actual.info_hashes.v1),
+             QString("DD8255ECDC7CA55FB0BBF81323D87062DB1F6D1C"));
+    QVERIFY(actual.file_priorities.empty());
+    QVERIFY(actual.flags & lt::torrent_flags::upload_mode); // metadata only
+}
+
+void tst_TorrentContext::setQueueFlags_magnet()
+{
+    // Given
+    lt::error_code ec;
+    auto actual = TorrentUtils::fromMagnetUri(s_magnetLink, ec);
+    QVERIFY(!ec);
+
+    // When
+    TorrentUtils::setQueueFlags(actual);
+
+    // Then
+    QVERIFY(!(actual.flags & lt::torrent_flags::paused)); // fetches the metadata at once
+    QVERIFY(!(actual.flags & lt::torrent_flags::auto_managed));
+    QVERIFY(actual.flags & lt::torrent_flags::upload_mode);
+}
+
+void tst_TorrentContext::setQueueFlags_torrentFile()
+{
+    // Given
+    lt::add_torrent_params actual;
+    actual.flags = lt::torrent_flags::auto_managed;
+
+    // When
+    TorrentUtils::setQueueFlags(actual);
+
+    // Then
+    QVERIFY(actual.flags & lt::torrent_flags::paused); // resumed by the DownloadEngine
+    QVERIFY(!(actual.flags & lt::torrent_flags::auto_managed));
+}
+
 /******************************************************************************
  ******************************************************************************/
 QTEST_APPLESS_MAIN(tst_TorrentContext)
@@ -0,0 +1,275 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Core/TorrentCreator>
+
+#include <QtCore/QDebug>
+#include <QtCore/QFile>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QThread>
+#include <QtTest/QSignalSpy>
+#include <QtTest/QtTest>
+
+#include "libtorrent/torrent_info.hpp"
+
+Q_DECLARE_METATYPE(TorrentCreator::Mode)
+
+class tst_TorrentCreator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void create_data();
+    void create();
+    void create_singleFile();
+    void create_invalidSource();
+
+    void start();
+    void cancel();
+
+    void benchmark_hashing_data();
+    void benchmark_hashing();
+
+private:
+    static void writeFile(const QString &fileName, qint64 size);
+};
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_TorrentCreator::writeFile(const QString &fileName, qint64 size)
+{
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QByteArray block(64 * 1024, '\0');
+    for (int i = 0; i < block.size(); ++i) {
+        block[i] = char(i * 31 + 7);
+    }
+    while (size > 0) {
+        auto count = qMin(size, qint64(block.size()));
+        QCOMPARE(file.write(block.constData(), count), count);
+        size -= count;
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_TorrentCreator::create_data()
+{
+    QTest::addColumn<TorrentCreator::Mode>("mode");
+    QTest::addColumn<bool>("hasV1");
+    QTest::addColumn<bool>("hasV2");
+
+    QTest::newRow("hybrid") << TorrentCreator::Mode::Hybrid << true << true;
+    QTest::newRow("v1") << TorrentCreator::Mode::V1 << true << false;
+    QTest::newRow("v2") << TorrentCreator::Mode::V2 << false << true;
+}
+
+void tst_TorrentCreator::create()
+{
+    QFETCH(TorrentCreator::Mode, mode);
+    QFETCH(bool, hasV1);
+    QFETCH(bool, hasV2);
+
+    // Given
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    QDir(tempDir.path()).mkpath("share/sub");
+    writeFile(tempDir.filePath("share/a.bin"), 100000);
+    writeFile(tempDir.filePath("share/sub/b.bin"), 300000);
+
+    TorrentCreator::Parameters parameters;
+    parameters.sourcePath = tempDir.filePath("share");
+    parameters.torrentFileName = tempDir.filePath("share.torrent");
+    parameters.mode = mode;
+    parameters.pieceSize = 16 * 1024;
+    parameters.trackers = { "udp://tracker.example.com:6969/announce" };
+    parameters.webSeeds = { "https://www.example.com/files/" };
+    parameters.comment = "comment";
+    parameters.isPrivate = true;
+
+    // When
+    auto lastHashed = 0;
+    auto lastCount = 0;
+    QString errorString;
+    auto actual = TorrentCreator::create(parameters, [&](int piecesHashed, int pieceCount) {
+        lastHashed = piecesHashed;
+        lastCount = pieceCount;
+    }, nullptr, &errorString);
+
+    // Then
+    QVERIFY2(actual, qPrintable(errorString));
+    QVERIFY(lastCount > 0);
+    QCOMPARE(lastHashed, lastCount);
+
+    lt::error_code ec;
+    lt::torrent_info ti(tempDir.filePath("share.torrent").toStdString(), ec);
+    QVERIFY(!ec);
+    QCOMPARE(ti.name(), std::string("share"));
+    QCOMPARE(ti.total_size(), std::int64_t(400000));
+    QCOMPARE(ti.piece_length(), 16 * 1024);
+    QCOMPARE(ti.info_hashes().has_v1(), hasV1);
+    QCOMPARE(ti.info_hashes().has_v2(), hasV2);
+    QCOMPARE(ti.trackers().size(), std::size_t(1));
+    QCOMPARE(ti.web_seeds().size(), std::size_t(1));
+    QCOMPARE(ti.comment(), std::string("comment"));
+    QVERIFY(ti.priv());
+}
+
+void tst_TorrentCreator::create_singleFile()
+{
+    // Given
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    writeFile(tempDir.filePath("single.bin"), 50000);
+
+    TorrentCreator::Parameters parameters;
+    parameters.sourcePath = tempDir.filePath("single.bin");
+    parameters.torrentFileName = tempDir.filePath("single.torrent");
+
+    // When
+    auto actual = TorrentCreator::create(parameters);
+
+    // Then
+    QVERIFY(actual);
+    lt::error_code ec;
+    lt::torrent_info ti(tempDir.filePath("single.torrent").toStdString(), ec);
+    QVERIFY(!ec);
+    QCOMPARE(ti.num_files(), 1);
+    QCOMPARE(ti.total_size(), std::int64_t(50000));
+}
+
+void tst_TorrentCreator::create_invalidSource()
+{
+    // Given
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    QDir(tempDir.path()).mkpath("empty");
+
+    TorrentCreator::Parameters parameters;
+    parameters.torrentFileName = tempDir.filePath("out.torrent");
+
+    // When
+    parameters.sourcePath = tempDir.filePath("missing");
+    QString errorString1;
+    auto actual1 = TorrentCreator::create(parameters, {}, nullptr, &errorString1);
+
+    parameters.sourcePath = tempDir.filePath("empty");
+    QString errorString2;
+    auto actual2 = TorrentCreator::create(parameters, {}, nullptr, &errorString2);
+
+    // Then
+    QVERIFY(!actual1);
+    QVERIFY(!errorString1.isEmpty());
+    QVERIFY(!actual2);
+    QVERIFY(!errorString2.isEmpty());
+    QVERIFY(!QFile::exists(tempDir.filePath("out.torrent")));
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_TorrentCreator::start()
+{
+    // Given
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    writeFile(tempDir.filePath("file.bin"), 1024 * 1024);
+
+    TorrentCreator target(this);
+    QSignalSpy spyProgress(&target, SIGNAL(progress(int,int)));
+    QSignalSpy spyFinished(&target, SIGNAL(finished(bool)));
+
+    TorrentCreator::Parameters parameters;
+    parameters.sourcePath = tempDir.filePath("file.bin");
+    parameters.torrentFileName = tempDir.filePath("file.torrent");
+    parameters.pieceSize = 16 * 1024;
+
+    // When
+    target.start(parameters);
+
+    // Then
+    QVERIFY(target.isRunning());
+    QVERIFY(spyFinished.wait(10000));
+    QVERIFY(!target.isRunning());
+    QCOMPARE(spyFinished.at(0).at(0).toBool(), true);
+    QVERIFY(target.errorString().isEmpty());
+    QVERIFY(spyProgress.count() > 0);
+    QVERIFY(spyProgress.count() <= 64 + 1); // one notification per piece at most
+    QCOMPARE(spyProgress.last().at(0).toInt(), 64);
+    QCOMPARE(spyProgress.last().at(1).toInt(), 64);
+}
+
+void tst_TorrentCreator::cancel()
+{
+    // Given
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    writeFile(tempDir.filePath("file.bin"), 1024 * 1024);
+
+    TorrentCreator::Parameters parameters;
+    parameters.sourcePath = tempDir.filePath("file.bin");
+    parameters.torrentFileName = tempDir.filePath("file.torrent");
+    parameters.pieceSize = 16 * 1024;
+
+    std::atomic<bool> canceled = true;
+
+    // When
+    QString errorString;
+    auto actual = TorrentCreator::create(parameters, {}, &canceled, &errorString);
+
+    // Then
+    QVERIFY(!actual);
+    QVERIFY(!errorString.isEmpty());
+    QVERIFY(!QFile::exists(tempDir.filePath("file.torrent")));
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*
+ * Compare the hashing time with different numbers of hashing threads.
+ */
+void tst_TorrentCreator::benchmark_hashing_data()
+{
+    QTest::addColumn<int>("threadCount");
+
+    QTest::newRow("1 thread") << 1;
+    QTest::newRow("2 threads") << 2;
+    QTest::newRow("4 threads") << 4;
+    QTest::newRow("one per core") << QThread::idealThreadCount();
+}
+
+void tst_TorrentCreator::benchmark_hashing()
+{
+    QFETCH(int, threadCount);
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    writeFile(tempDir.filePath("large.bin"), 64 * 1024 * 1024);
+
+    TorrentCreator::Parameters parameters;
+    parameters.sourcePath = tempDir.filePath("large.bin");
+    parameters.torrentFileName = tempDir.filePath("large.torrent");
+    parameters.threadCount = threadCount;
+
+    QBENCHMARK {
+        QVERIFY(TorrentCreator::create(parameters));
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+QTEST_MAIN(tst_TorrentCreator)
+
+#include "tst_torrentcreator.moc"
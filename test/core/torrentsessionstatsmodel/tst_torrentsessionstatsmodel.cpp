@@ -0,0 +1,140 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Core/TorrentSessionStatsModel>
+
+#include <QtCore/QDebug>
+#include <QtTest/QSignalSpy>
+#include <QtTest/QtTest>
+
+class tst_TorrentSessionStatsModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void append();
+    void append_capacity();
+    void setCapacity();
+    void toCsv();
+
+private:
+    static TorrentSessionStats createStats(int seconds);
+};
+
+/******************************************************************************
+ ******************************************************************************/
+TorrentSessionStats tst_TorrentSessionStatsModel::createStats(int seconds)
+{
+    TorrentSessionStats stats;
+    stats.timestamp = QDateTime(QDate(2024, 1, 1), QTime(12, 0, seconds), QTimeZone::utc());
+    stats.diskQueuedJobs = seconds;
+    return stats;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_TorrentSessionStatsModel::append()
+{
+    // Given
+    TorrentSessionStatsModel target;
+    QSignalSpy spyInserted(&target, SIGNAL(rowsInserted(QModelIndex,int,int)));
+
+    // When
+    target.append(createStats(1));
+    target.append(createStats(2));
+
+    // Then
+    QCOMPARE(target.rowCount(), 2);
+    QCOMPARE(target.columnCount(), 12);
+    QCOMPARE(spyInserted.count(), 2);
+    QCOMPARE(target.at(0).diskQueuedJobs, qint64(1));
+    QCOMPARE(target.at(1).diskQueuedJobs, qint64(2));
+    QCOMPARE(target.data(target.index(1, 1)).toLongLong(), qint64(2));
+}
+
+void tst_TorrentSessionStatsModel::append_capacity()
+{
+    // Given
+    TorrentSessionStatsModel target;
+    target.setCapacity(3);
+    QSignalSpy spyRemoved(&target, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+
+    // When
+    for (int i = 0; i < 5; ++i) {
+        target.append(createStats(i));
+    }
+
+    // Then
+    QCOMPARE(target.rowCount(), 3);
+    QCOMPARE(spyRemoved.count(), 2);
+    QCOMPARE(target.at(0).diskQueuedJobs, qint64(2)); // the oldest are removed
+    QCOMPARE(target.at(2).diskQueuedJobs, qint64(4));
+}
+
+void tst_TorrentSessionStatsModel::setCapacity()
+{
+    // Given
+    TorrentSessionStatsModel target;
+    for (int i = 0; i < 5; ++i) {
+        target.append(createStats(i));
+    }
+
+    // When
+    target.setCapacity(2);
+
+    // Then
+    QCOMPARE(target.rowCount(), 2);
+    QCOMPARE(target.at(0).diskQueuedJobs, qint64(3));
+    QCOMPARE(target.at(1).diskQueuedJobs, qint64(4));
+}
+
+void tst_TorrentSessionStatsModel::toCsv()
+{
+    // Given
+    TorrentSessionStatsModel target;
+    auto stats = createStats(5);
+    stats.diskQueuedWriteBytes = 65536;
+    stats.diskReadTime = 120;
+    stats.diskWriteTime = 340;
+    stats.pickerBusyLoops = 7;
+    stats.performanceWarnings = 2;
+    stats.lastPerformanceWarning = "torrent: performance warning: max outstanding disk writes reached, \"slow\"";
+    stats.uploadQueue = 3;
+    stats.downloadQueue = 4;
+    stats.connectedPeers = 50;
+    stats.rejectedPeers = 1;
+    target.append(stats);
+
+    // When
+    auto actual = target.toCsv().split('\n');
+
+    // Then
+    QCOMPARE(actual.count(), 3); // header, sample, and empty last line
+    QCOMPARE(actual.at(0), QByteArray("timestamp,disk_queued_jobs,disk_queued_write_bytes,"
+                                      "disk_read_time_us,disk_write_time_us,picker_busy_loops,"
+                                      "performance_warnings,last_performance_warning,"
+                                      "upload_queue,download_queue,connected_peers,rejected_peers"));
+    QCOMPARE(actual.at(1), QByteArray("2024-01-01T12:00:05.000Z,5,65536,120,340,7,2,"
+                                      "\"torrent: performance warning: max outstanding disk writes reached, \"\"slow\"\"\","
+                                      "3,4,50,1"));
+    QVERIFY(actual.at(2).isEmpty());
+}
+
+/******************************************************************************
+ ******************************************************************************/
+QTEST_APPLESS_MAIN(tst_TorrentSessionStatsModel)
+
+#include "tst_torrentsessionstatsmodel.moc"
@@ -0,0 +1,276 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Core/Torrent>
+#include <Core/TorrentBaseContext>
+#include <Core/TorrentStreamServer>
+
+#include <QtCore/QDebug>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QTemporaryDir>
+#include <QtNetwork/QTcpSocket>
+#include <QtTest/QSignalSpy>
+#include <QtTest/QtTest>
+
+class FakeTorrentContext : public TorrentBaseContext
+{
+public:
+    void setStreamingPosition(Torrent *, int fileIndex, qint64 offset) override
+    {
+        positions << qMakePair(fileIndex, offset);
+    }
+
+    QList<QPair<int, qint64>> positions = {};
+};
+
+class tst_TorrentStreamServer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parseRange_data();
+    void parseRange();
+
+    void url();
+    void url_invalid();
+
+    void get_notFound();
+    void get_partial();
+
+private:
+    static QByteArray createContent(qint64 size);
+    static void setupTorrent(Torrent *torrent, const QString &path, qint64 size);
+    static void setDownloadedPieces(Torrent *torrent, int count);
+    static QByteArray get(const QUrl &url, const QByteArray &extraHeaders = {});
+};
+
+/******************************************************************************
+ ******************************************************************************/
+static const qint64 PIECE_BYTE_SIZE = 100;
+static const int PIECE_COUNT = 10;
+
+QByteArray tst_TorrentStreamServer::createContent(qint64 size)
+{
+    QByteArray content;
+    for (qint64 i = 0; i < size; ++i) {
+        content.append(char('a' + (i % 26)));
+    }
+    return content;
+}
+
+void tst_TorrentStreamServer::setupTorrent(Torrent *torrent, const QString &path, qint64 size)
+{
+    TorrentFileMetaInfo fileMetaInfo;
+    fileMetaInfo.fileName = "clip.mp4";
+    fileMetaInfo.filePath = "movie/clip.mp4";
+    fileMetaInfo.bytesTotal = size;
+    fileMetaInfo.bytesOffset = 0;
+
+    TorrentMetaInfo metaInfo;
+    metaInfo.initialMetaInfo.pieceByteSize = PIECE_BYTE_SIZE;
+    metaInfo.initialMetaInfo.files << fileMetaInfo;
+
+    torrent->setLocalFilePath(path);
+    torrent->setMetaInfo(metaInfo);
+}
+
+void tst_TorrentStreamServer::setDownloadedPieces(Torrent *torrent, int count)
+{
+    TorrentInfo info = torrent->info();
+    info.downloadedPieces = QBitArray(PIECE_COUNT);
+    info.downloadedPieces.fill(true, 0, count);
+    torrent->setInfo(info, false);
+    emit torrent->changed();
+}
+
+QByteArray tst_TorrentStreamServer::get(const QUrl &url, const QByteArray &extraHeaders)
+{
+    QTcpSocket socket;
+    socket.connectToHost(url.host(), quint16(url.port()));
+    if (!socket.waitForConnected(5000)) {
+        return {};
+    }
+    socket.write("GET " + url.toEncoded(QUrl::RemoveScheme | QUrl::RemoveAuthority)
+                 + " HTTP/1.1\r\nHost: 127.0.0.1\r\n" + extraHeaders + "\r\n");
+    QByteArray response;
+    QDeadlineTimer deadline(5000);
+    while (socket.state() == QAbstractSocket::ConnectedState && !deadline.hasExpired()) {
+        // Wait with the event loop running, for the server to answer
+        QTest::qWait(10);
+        response += socket.readAll();
+    }
+    response += socket.readAll();
+    return response;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_TorrentStreamServer::parseRange_data()
+{
+    QTest::addColumn<QByteArray>("value");
+    QTest::addColumn<bool>("expected");
+    QTest::addColumn<qint64>("expectedFirst");
+    QTest::addColumn<qint64>("expectedLast");
+
+    QTest::newRow("empty") << QByteArray() << false << qint64(0) << qint64(0);
+    QTest::newRow("unit") << QByteArray("items=0-10") << false << qint64(0) << qint64(0);
+    QTest::newRow("invalid") << QByteArray("bytes=abc") << false << qint64(0) << qint64(0);
+    QTest::newRow("full") << QByteArray("bytes=0-") << true << qint64(0) << qint64(999);
+    QTest::newRow("bounded") << QByteArray("bytes=100-199") << true << qint64(100) << qint64(199);
+    QTest::newRow("open") << QByteArray("bytes=500-") << true << qint64(500) << qint64(999);
+    QTest::newRow("capped") << QByteArray("bytes=900-5000") << true << qint64(900) << qint64(999);
+    QTest::newRow("suffix") << QByteArray("bytes=-100") << true << qint64(900) << qint64(999);
+    QTest::newRow("suffix large") << QByteArray("bytes=-5000") << true << qint64(0) << qint64(999);
+    QTest::newRow("suffix zero") << QByteArray("bytes=-0") << false << qint64(0) << qint64(0);
+    QTest::newRow("reversed") << QByteArray("bytes=200-100") << false << qint64(0) << qint64(0);
+    QTest::newRow("out of file") << QByteArray("bytes=1000-") << false << qint64(0) << qint64(0);
+    QTest::newRow("multiple") << QByteArray("bytes=0-10,20-30") << false << qint64(0) << qint64(0);
+}
+
+void tst_TorrentStreamServer::parseRange()
+{
+    QFETCH(QByteArray, value);
+    QFETCH(bool, expected);
+    QFETCH(qint64, expectedFirst);
+    QFETCH(qint64, expectedLast);
+
+    qint64 first = 0;
+    qint64 last = 0;
+    auto actual = TorrentStreamServer::parseRange(value, 1000, first, last);
+
+    QCOMPARE(actual, expected);
+    QCOMPARE(first, expectedFirst);
+    QCOMPARE(last, expectedLast);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_TorrentStreamServer::url()
+{
+    // Given
+    TorrentStreamServer target;
+    Torrent torrent;
+    setupTorrent(&torrent, QDir::tempPath(), 1000);
+
+    // When
+    auto actual = target.url(&torrent, 0);
+    auto again = target.url(&torrent, 0);
+
+    // Then
+    QVERIFY(target.isListening());
+    QCOMPARE(actual, again); // same token
+    QCOMPARE(actual.scheme(), QString("http"));
+    QCOMPARE(actual.host(), QString("127.0.0.1"));
+    QCOMPARE(actual.port(), int(target.port()));
+    QVERIFY(actual.path().endsWith("/0/clip.mp4"));
+}
+
+void tst_TorrentStreamServer::url_invalid()
+{
+    // Given
+    TorrentStreamServer target;
+    Torrent torrent;
+
+    // When, Then
+    QVERIFY(!target.url(nullptr, 0).isValid());
+    QVERIFY(!target.url(&torrent, 0).isValid()); // no metadata
+    QVERIFY(!target.isListening());
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_TorrentStreamServer::get_notFound()
+{
+    // Given
+    TorrentStreamServer target;
+    Torrent torrent;
+    setupTorrent(&torrent, QDir::tempPath(), 1000);
+    auto url = target.url(&torrent, 0);
+
+    // When
+    auto unknownToken = url;
+    unknownToken.setPath("/0123456789abcdef/0/clip.mp4");
+    auto unknownFile = url;
+    unknownFile.setPath(url.path().replace("/0/", "/7/"));
+
+    // Then
+    QVERIFY(get(unknownToken).startsWith("HTTP/1.1 404 "));
+    QVERIFY(get(unknownFile).startsWith("HTTP/1.1 404 "));
+
+    // When
+    target.remove(&torrent);
+
+    // Then
+    QVERIFY(get(url).startsWith("HTTP/1.1 404 "));
+}
+
+void tst_TorrentStreamServer::get_partial()
+{
+    // Given
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(QDir(dir.path()).mkpath("movie"));
+    const auto size = PIECE_COUNT * PIECE_BYTE_SIZE;
+    const auto content = createContent(size);
+    QFile file(QDir(dir.path()).filePath("movie/clip.mp4"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(content);
+    file.close();
+
+    FakeTorrentContext context;
+    TorrentStreamServer target;
+    target.setTorrentContext(&context);
+    Torrent torrent;
+    setupTorrent(&torrent, dir.path(), size);
+    setDownloadedPieces(&torrent, 5);
+    auto url = target.url(&torrent, 0);
+
+    // When
+    QTcpSocket socket;
+    socket.connectToHost(url.host(), quint16(url.port()));
+    QVERIFY(socket.waitForConnected(5000));
+    socket.write("GET " + url.toEncoded(QUrl::RemoveScheme | QUrl::RemoveAuthority)
+                 + " HTTP/1.1\r\nHost: 127.0.0.1\r\nRange: bytes=150-849\r\n\r\n");
+
+    QByteArray response;
+    QTRY_VERIFY_WITH_TIMEOUT((response += socket.readAll()).endsWith(content.mid(150, 350)), 5000);
+
+    // Then
+    auto headerSize = response.indexOf("\r\n\r\n") + 4;
+    auto header = response.left(headerSize);
+    QVERIFY(header.startsWith("HTTP/1.1 206 Partial Content\r\n"));
+    QVERIFY(header.contains("Content-Length: 700\r\n"));
+    QVERIFY(header.contains("Content-Range: bytes 150-849/1000\r\n"));
+    QVERIFY(header.contains("Accept-Ranges: bytes\r\n"));
+    QCOMPARE(response.mid(headerSize), content.mid(150, 350)); // only the downloaded pieces
+    QCOMPARE(context.positions.first(), qMakePair(0, qint64(150)));
+    QCOMPARE(context.positions.last(), qMakePair(0, qint64(500))); // waiting for the 6th piece
+
+    // When
+    setDownloadedPieces(&torrent, PIECE_COUNT);
+    QTRY_VERIFY_WITH_TIMEOUT((response += socket.readAll(), socket.state() != QAbstractSocket::ConnectedState), 5000);
+    response += socket.readAll();
+
+    // Then
+    QCOMPARE(response.mid(headerSize), content.mid(150, 700));
+}
+
+/******************************************************************************
+ ******************************************************************************/
+QTEST_MAIN(tst_TorrentStreamServer)
+
+#include "tst_torrentstreamserver.moc"
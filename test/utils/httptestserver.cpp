@@ -0,0 +1,454 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "httptestserver.h"
+
+#include <QtCore/QDebug>
+#include <QtCore/QTimer>
+#include <QtNetwork/QTcpSocket>
+
+#include <limits>
+
+static constexpr int TICK_MSEC = 10;
+static constexpr qint64 CHUNK_SIZE = 64 * 1024;
+static constexpr qint64 MAX_BUFFERED_BYTES = 4 * 1024 * 1024;
+static constexpr qint64 PATTERN_PERIOD = 251; // prime, to detect misplaced ranges
+
+static const QByteArray &pattern()
+{
+    static const QByteArray bytes = [] {
+        QByteArray ret(PATTERN_PERIOD + CHUNK_SIZE, Qt::Uninitialized);
+        for (qsizetype i = 0; i < ret.size(); ++i) {
+            ret[i] = static_cast<char>(i % PATTERN_PERIOD);
+        }
+        return ret;
+    }();
+    return bytes;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+HttpTestServer::HttpTestServer(QObject *parent) : QTcpServer(parent)
+  , m_tickTimer(new QTimer(this))
+{
+    m_tickTimer->setTimerType(Qt::PreciseTimer);
+    m_tickTimer->setInterval(TICK_MSEC);
+    connect(m_tickTimer, SIGNAL(timeout()), this, SLOT(onTick()));
+    connect(this, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+}
+
+HttpTestServer::~HttpTestServer()
+{
+    close();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+qint64 HttpTestServer::contentSize() const
+{
+    return m_contentSize;
+}
+
+void HttpTestServer::setContentSize(qint64 size)
+{
+    m_contentSize = qMax(qint64(0), size);
+}
+
+bool HttpTestServer::isRangeSupported() const
+{
+    return m_rangeSupported;
+}
+
+void HttpTestServer::setRangeSupported(bool supported)
+{
+    m_rangeSupported = supported;
+}
+
+bool HttpTestServer::isChunkedEncodingEnabled() const
+{
+    return m_chunkedEncodingEnabled;
+}
+
+void HttpTestServer::setChunkedEncodingEnabled(bool enabled)
+{
+    m_chunkedEncodingEnabled = enabled;
+}
+
+/*!
+ * \brief Delay, in milliseconds, before the response is sent.
+ */
+qint64 HttpTestServer::latency() const
+{
+    return m_latency;
+}
+
+void HttpTestServer::setLatency(qint64 msec)
+{
+    m_latency = qMax(qint64(0), msec);
+}
+
+/*!
+ * \brief Bandwidth limit per connection, in bytes per second. 0 is unlimited.
+ */
+qint64 HttpTestServer::bandwidth() const
+{
+    return m_bandwidth;
+}
+
+void HttpTestServer::setBandwidth(qint64 bytesPerSecond)
+{
+    m_bandwidth = qMax(qint64(0), bytesPerSecond);
+}
+
+/*!
+ * \brief Returns true if the connection is kept open after a complete
+ * response, for the next request of the client.
+ * Otherwise, each response is sent with 'Connection: close'.
+ */
+bool HttpTestServer::isKeepAliveEnabled() const
+{
+    return m_keepAliveEnabled;
+}
+
+void HttpTestServer::setKeepAliveEnabled(bool enabled)
+{
+    m_keepAliveEnabled = enabled;
+}
+
+/*!
+ * \brief The next \a count responses are closed after \a afterBytes bytes of content.
+ */
+void HttpTestServer::setFailures(int count, qint64 afterBytes)
+{
+    m_failureCount = count;
+    m_failAfterBytes = afterBytes;
+}
+
+/*!
+ * \brief The \a request-th request (starting at 1) is answered
+ * with an error page of status \a statusCode, e.g. 503, instead of the content.
+ */
+void HttpTestServer::setErrorResponse(int request, int statusCode)
+{
+    m_errorResponses.insert(request, statusCode);
+}
+
+/*!
+ * \brief Returns the number of connections accepted.
+ */
+int HttpTestServer::connectionCount() const
+{
+    return m_connectionCount;
+}
+
+int HttpTestServer::requestCount() const
+{
+    return m_requestCount;
+}
+
+int HttpTestServer::rangeRequestCount() const
+{
+    return m_rangeRequestCount;
+}
+
+QUrl HttpTestServer::url(const QString &path) const
+{
+    return QUrl(QString("http://127.0.0.1:%0%1").arg(QString::number(serverPort()), path));
+}
+
+/*!
+ * \brief Returns the expected content, from \a offset to \a offset + \a length.
+ */
+QByteArray HttpTestServer::content(qint64 offset, qint64 length)
+{
+    QByteArray ret;
+    ret.reserve(length);
+    while (length > 0) {
+        auto count = qMin(length, CHUNK_SIZE);
+        ret.append(pattern().constData() + offset % PATTERN_PERIOD, count);
+        offset += count;
+        length -= count;
+    }
+    return ret;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+QByteArray HttpTestServer::etag() const
+{
+    return QByteArray("\"arrowdl-") + QByteArray::number(m_contentSize) + QByteArray("\"");
+}
+
+void HttpTestServer::parseRequest(Connection &connection)
+{
+    m_requestCount++;
+
+    /* The next request, if any, stays in the buffer */
+    auto headEnd = connection.request.indexOf("\r\n\r\n");
+    auto request = connection.request.left(headEnd);
+    connection.request.remove(0, headEnd + 4);
+
+    auto lines = request.split('\n');
+    auto requestLine = lines.value(0).trimmed().split(' ');
+    auto method = requestLine.value(0);
+
+    QHash<QByteArray, QByteArray> headers;
+    for (qsizetype i = 1; i < lines.count(); ++i) {
+        auto line = lines.at(i).trimmed();
+        auto pos = line.indexOf(':');
+        if (pos > 0) {
+            headers.insert(line.left(pos).trimmed().toLower(), line.mid(pos + 1).trimmed());
+        }
+    }
+    connection.isKeepAlive = m_keepAliveEnabled
+            && headers.value("connection").toLower() != "close";
+    const QByteArray connectionHeader = connection.isKeepAlive
+            ? "Connection: keep-alive\r\n"
+            : "Connection: close\r\n";
+
+    if (m_errorResponses.contains(m_requestCount)) {
+        auto statusCode = QByteArray::number(m_errorResponses.value(m_requestCount));
+        connection.body = "<html><body><h1>" + statusCode + " Error</h1></body></html>";
+        QByteArray header;
+        header += "HTTP/1.1 " + statusCode + " Error\r\n";
+        header += "Content-Type: text/html\r\n";
+        header += "Content-Length: " + QByteArray::number(connection.body.size()) + "\r\n";
+        header += connectionHeader;
+        header += "\r\n";
+        connection.header = header;
+        connection.latency.setRemainingTime(m_latency);
+        connection.isParsed = true;
+        return;
+    }
+
+    QByteArray status = "200 OK";
+    qint64 begin = 0;
+    qint64 end = m_contentSize;
+    QByteArray contentRange;
+
+    if (method != "GET" && method != "HEAD") {
+        status = "405 Method Not Allowed";
+        end = 0;
+
+    } else if (m_rangeSupported
+               && headers.contains("range")
+               && (!headers.contains("if-range") || headers.value("if-range") == etag())) {
+        m_rangeRequestCount++;
+        auto range = headers.value("range");
+        auto dash = range.indexOf('-');
+        auto ok = range.startsWith("bytes=") && dash > 0;
+        auto first = range.mid(6, dash - 6);
+        auto last = range.mid(dash + 1);
+        if (ok && first.isEmpty()) {
+            /* Suffix: last N bytes */
+            begin = qMax(qint64(0), m_contentSize - last.toLongLong(&ok));
+        } else if (ok) {
+            begin = first.toLongLong(&ok);
+            if (ok && !last.isEmpty()) {
+                end = qMin(m_contentSize, last.toLongLong(&ok) + 1);
+            }
+        }
+        if (!ok || begin >= m_contentSize || begin >= end) {
+            status = "416 Range Not Satisfiable";
+            contentRange = "bytes */" + QByteArray::number(m_contentSize);
+            begin = 0;
+            end = 0;
+        } else {
+            status = "206 Partial Content";
+            contentRange = "bytes " + QByteArray::number(begin) + "-"
+                    + QByteArray::number(end - 1) + "/" + QByteArray::number(m_contentSize);
+        }
+    }
+    if (method == "HEAD") {
+        end = begin;
+    }
+
+    connection.isChunked = m_chunkedEncodingEnabled;
+    connection.position = begin;
+    connection.end = end;
+
+    QByteArray header;
+    header += "HTTP/1.1 " + status + "\r\n";
+    header += "Content-Type: application/octet-stream\r\n";
+    header += "ETag: " + etag() + "\r\n";
+    header += m_rangeSupported ? "Accept-Ranges: bytes\r\n" : "Accept-Ranges: none\r\n";
+    if (!contentRange.isEmpty()) {
+        header += "Content-Range: " + contentRange + "\r\n";
+    }
+    if (connection.isChunked) {
+        header += "Transfer-Encoding: chunked\r\n";
+    } else {
+        header += "Content-Length: " + QByteArray::number(end - begin) + "\r\n";
+    }
+    header += connectionHeader;
+    header += "\r\n";
+    connection.header = header;
+
+    if (m_failureCount > 0) {
+        m_failureCount--;
+        connection.failAfter = m_failAfterBytes;
+    }
+    connection.latency.setRemainingTime(m_latency);
+    connection.isParsed = true;
+}
+
+/*!
+ * \brief Sends up to \a budget bytes of content.
+ * Returns false when the response is complete.
+ */
+bool HttpTestServer::send(QTcpSocket *socket, Connection &connection, qint64 budget)
+{
+    if (!connection.isParsed || connection.isDone) {
+        return !connection.isDone;
+    }
+    if (!connection.latency.hasExpired()) {
+        return true;
+    }
+    if (!connection.isHeaderSent) {
+        socket->write(connection.header);
+        socket->write(connection.body);
+        connection.isHeaderSent = true;
+    }
+    while (budget > 0 && connection.position < connection.end) {
+        if (socket->bytesToWrite() >= MAX_BUFFERED_BYTES) {
+            return true;
+        }
+        auto count = qMin(qMin(budget, connection.end - connection.position), CHUNK_SIZE);
+        auto failing = connection.failAfter >= 0
+                && connection.sent + count >= connection.failAfter;
+        if (failing) {
+            count = connection.failAfter - connection.sent;
+        }
+        if (count > 0) {
+            auto data = pattern().constData() + connection.position % PATTERN_PERIOD;
+            if (connection.isChunked) {
+                socket->write(QByteArray::number(count, 16) + "\r\n");
+                socket->write(data, count);
+                socket->write("\r\n");
+            } else {
+                socket->write(data, count);
+            }
+        }
+        connection.position += count;
+        connection.sent += count;
+        budget -= count;
+        if (failing) {
+            /* Close before the end of the content */
+            connection.isDone = true;
+            socket->disconnectFromHost();
+            return false;
+        }
+    }
+    if (connection.position >= connection.end) {
+        if (connection.isChunked) {
+            socket->write("0\r\n\r\n");
+        }
+        connection.isDone = true;
+        endResponse(socket, connection);
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * \brief Closes the connection after a complete response,
+ * or keeps it open and waits for the next request.
+ */
+void HttpTestServer::endResponse(QTcpSocket *socket, Connection &connection)
+{
+    if (!connection.isKeepAlive) {
+        socket->disconnectFromHost();
+        return;
+    }
+    auto pending = connection.request;
+    connection = {};
+    connection.request = pending;
+    if (connection.request.contains("\r\n\r\n")) {
+        parseRequest(connection); // sent by onBytesWritten() or onTick()
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void HttpTestServer::onNewConnection()
+{
+    while (hasPendingConnections()) {
+        auto socket = nextPendingConnection();
+        m_connectionCount++;
+        connect(socket, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+        connect(socket, SIGNAL(bytesWritten(qint64)), this, SLOT(onBytesWritten()));
+        connect(socket, SIGNAL(disconnected()), this, SLOT(onDisconnected()), Qt::QueuedConnection);
+        m_connections.insert(socket, {});
+    }
+    if (!m_tickTimer->isActive()) {
+        m_tickTimer->start();
+    }
+}
+
+void HttpTestServer::onReadyRead()
+{
+    auto socket = qobject_cast<QTcpSocket*>(sender());
+    auto it = m_connections.find(socket);
+    if (it == m_connections.end()) {
+        return;
+    }
+    auto &connection = it.value();
+    connection.request += socket->readAll(); // the next request waits for the end of the response
+    if (!connection.isParsed && connection.request.contains("\r\n\r\n")) {
+        parseRequest(connection);
+        if (m_latency == 0 && m_bandwidth == 0) {
+            send(socket, connection, std::numeric_limits<qint64>::max());
+        }
+    }
+}
+
+void HttpTestServer::onBytesWritten()
+{
+    if (m_bandwidth > 0) {
+        return; // throttled by onTick()
+    }
+    auto socket = qobject_cast<QTcpSocket*>(sender());
+    auto it = m_connections.find(socket);
+    if (it != m_connections.end()) {
+        send(socket, it.value(), std::numeric_limits<qint64>::max());
+    }
+}
+
+void HttpTestServer::onDisconnected()
+{
+    auto socket = qobject_cast<QTcpSocket*>(sender());
+    m_connections.remove(socket);
+    if (socket) {
+        socket->deleteLater();
+    }
+    if (m_connections.isEmpty()) {
+        m_tickTimer->stop();
+    }
+}
+
+void HttpTestServer::onTick()
+{
+    const auto budget = m_bandwidth > 0
+            ? qMax(qint64(1), m_bandwidth * TICK_MSEC / 1000)
+            : std::numeric_limits<qint64>::max();
+    const auto sockets = m_connections.keys();
+    for (auto socket : sockets) {
+        auto it = m_connections.find(socket);
+        if (it != m_connections.end()) {
+            send(socket, it.value(), budget);
+        }
+    }
+}
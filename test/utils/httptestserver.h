@@ -0,0 +1,123 @@
+/* - ArrowDL - Copyright (C) 2019-present Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTTP_TEST_SERVER_H
+#define HTTP_TEST_SERVER_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QDeadlineTimer>
+#include <QtCore/QHash>
+#include <QtCore/QUrl>
+#include <QtNetwork/QTcpServer>
+
+class QTcpSocket;
+class QTimer;
+
+/*!
+ * \brief Minimal HTTP/1.1 server, to test and benchmark the downloads locally.
+ *
+ * Any GET request is answered with a generated content of contentSize() bytes.
+ * The server supports Range requests (with If-Range), chunked encoding,
+ * latency before the first byte, bandwidth throttling,
+ * connections closed before the end of the content,
+ * error pages (503, 429...) in place of the content,
+ * and persistent connections (keep-alive).
+ */
+class HttpTestServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    explicit HttpTestServer(QObject *parent = nullptr);
+    ~HttpTestServer() override;
+
+    qint64 contentSize() const;
+    void setContentSize(qint64 size);
+
+    bool isRangeSupported() const;
+    void setRangeSupported(bool supported);
+
+    bool isChunkedEncodingEnabled() const;
+    void setChunkedEncodingEnabled(bool enabled);
+
+    qint64 latency() const;
+    void setLatency(qint64 msec);
+
+    qint64 bandwidth() const;
+    void setBandwidth(qint64 bytesPerSecond);
+
+    bool isKeepAliveEnabled() const;
+    void setKeepAliveEnabled(bool enabled);
+
+    void setFailures(int count, qint64 afterBytes);
+    void setErrorResponse(int request, int statusCode);
+
+    int connectionCount() const;
+    int requestCount() const;
+    int rangeRequestCount() const;
+
+    QUrl url(const QString &path = QLatin1String("/file.bin")) const;
+
+    static QByteArray content(qint64 offset, qint64 length);
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+    void onBytesWritten();
+    void onDisconnected();
+    void onTick();
+
+private:
+    struct Connection
+    {
+        QByteArray request = {};
+        bool isParsed = false;
+        bool isHeaderSent = false;
+        bool isChunked = false;
+        bool isDone = false;
+        bool isKeepAlive = false;
+        QByteArray header = {};
+        QByteArray body = {};
+        qint64 position = 0;
+        qint64 end = 0;
+        qint64 sent = 0;
+        qint64 failAfter = -1;
+        QDeadlineTimer latency = {};
+    };
+
+    QHash<QTcpSocket*, Connection> m_connections = {};
+    QTimer *m_tickTimer = nullptr;
+
+    qint64 m_contentSize = 0;
+    bool m_rangeSupported = true;
+    bool m_chunkedEncodingEnabled = false;
+    qint64 m_latency = 0;
+    qint64 m_bandwidth = 0;
+    bool m_keepAliveEnabled = false;
+    int m_failureCount = 0;
+    qint64 m_failAfterBytes = 0;
+    QHash<int, int> m_errorResponses = {};
+    int m_connectionCount = 0;
+    int m_requestCount = 0;
+    int m_rangeRequestCount = 0;
+
+    QByteArray etag() const;
+    void parseRequest(Connection &connection);
+    bool send(QTcpSocket *socket, Connection &connection, qint64 budget);
+    void endResponse(QTcpSocket *socket, Connection &connection);
+};
+
+#endif // HTTP_TEST_SERVER_H